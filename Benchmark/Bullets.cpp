@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2006-2007 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Scenes.h"
+
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace box2d;
+
+// Compares continuous collision (SolveTOI) with speculative contacts on scenes
+// full of fast bodies. Usage: Bullets [bodyCount] [stepCount]
+
+enum class Mode
+{
+    DISCRETE,
+    CONTINUOUS,
+    SPECULATIVE
+};
+
+static const char* GetModeName(Mode mode)
+{
+    switch (mode)
+    {
+        case Mode::DISCRETE:
+            return "discrete";
+        case Mode::CONTINUOUS:
+            return "toi";
+        case Mode::SPECULATIVE:
+            return "speculative";
+    }
+    return "";
+}
+
+struct Result
+{
+    float stepTime;
+    float toiTime;
+    int32_t escaped;
+};
+
+// Steps the arena scene in one collision mode.
+static Result RunArena(Mode mode, int32_t bodyCount, int32_t stepCount, bool boxes)
+{
+    b2World world(b2Vec<float, 2>{{0.0f, 0.0f}});
+    world.SetContinuousPhysics(mode != Mode::DISCRETE);
+    world.SetSpeculativeContacts(mode == Mode::SPECULATIVE);
+    scenes::BuildArena(&world, bodyCount, boxes, mode == Mode::CONTINUOUS);
+
+    Result result = {0.0f, 0.0f, 0};
+    for (int32_t i = 0; i < stepCount; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+        const b2Profile& profile = world.GetProfile();
+        result.stepTime += profile.step;
+        result.toiTime += profile.solveTOI;
+    }
+
+    for (b2Body* b = world.GetBodyList(); b; b = b->GetNext())
+    {
+        b2Vec<float, 2> p = b->GetPosition();
+        if (std::abs(p[b2VecX]) > scenes::ARENA_EXTENT ||
+            std::abs(p[b2VecY]) > scenes::ARENA_EXTENT)
+        {
+            ++result.escaped;
+        }
+    }
+
+    result.stepTime /= stepCount;
+    result.toiTime /= stepCount;
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int32_t bodyCount = argc > 1 ? atoi(argv[1]) : 500;
+    int32_t stepCount = argc > 2 ? atoi(argv[2]) : 300;
+
+    printf("%-8s %-12s %8s %12s %12s %8s\n", "scene", "mode", "bodies", "step [ms]", "toi [ms]",
+           "escaped");
+
+    Mode modes[3] = {Mode::DISCRETE, Mode::CONTINUOUS, Mode::SPECULATIVE};
+    for (int32_t scene = 0; scene < 2; ++scene)
+    {
+        bool boxes = scene == 1;
+        for (Mode mode : modes)
+        {
+            Result r = RunArena(mode, bodyCount, stepCount, boxes);
+            printf("%-8s %-12s %8d %12.3f %12.3f %8d\n", boxes ? "boxes" : "circles",
+                   GetModeName(mode), bodyCount, r.stepTime, r.toiTime, r.escaped);
+        }
+    }
+
+    return 0;
+}
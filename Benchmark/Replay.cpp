@@ -0,0 +1,244 @@
+/*
+* Copyright (c) 2006-2007 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace box2d;
+
+// Replays a capture made by b2Recorder without graphics and prints the profile of each
+// step as tab separated values.
+// Usage: Replay capture [--from step] [--to step] [--counters] [--perf-control ctl[,ack]]
+// The steps before --from are still simulated, but not printed. Replay stops after --to.
+// --counters adds the hardware counts of each step, see b2PerfCounters.
+//
+// perf record samples the whole process, including the steps before --from. To profile
+// only the printed steps, start perf with its events disabled and let Replay enable them
+// around each of those steps through perf's control fifos:
+//   mkfifo ctl ack
+//   perf record --control fifo:ctl,ack --delay=-1 -- \
+//       Replay capture --from N --to N --perf-control ctl,ack
+// With the ack fifo Replay waits for perf to confirm each command.
+
+// Sends enable and disable commands to perf record --control.
+class PerfControl
+{
+public:
+    ~PerfControl()
+    {
+#if defined(__linux__)
+        if (m_ctl >= 0)
+        {
+            close(m_ctl);
+        }
+        if (m_ack >= 0)
+        {
+            close(m_ack);
+        }
+#endif
+    }
+
+    // Opens "ctl" or "ctl,ack". Returns false if a fifo cannot be opened.
+    bool Open(const char* fifos)
+    {
+#if defined(__linux__)
+        char ctl[256];
+        snprintf(ctl, sizeof(ctl), "%s", fifos);
+        char* ack = strchr(ctl, ',');
+        if (ack)
+        {
+            *ack++ = 0;
+        }
+
+        m_ctl = open(ctl, O_WRONLY);
+        if (ack)
+        {
+            m_ack = open(ack, O_RDONLY);
+        }
+        return m_ctl >= 0 && (ack == nullptr || m_ack >= 0);
+#else
+        B2_NOT_USED(fifos);
+        return false;
+#endif
+    }
+
+    void Send(const char* command)
+    {
+#if defined(__linux__)
+        if (m_ctl < 0)
+        {
+            return;
+        }
+
+        if (write(m_ctl, command, strlen(command)) < 0)
+        {
+            return;
+        }
+
+        // perf answers each command with "ack\n".
+        char c = 0;
+        while (m_ack >= 0 && c != '\n' && read(m_ack, &c, 1) == 1)
+        {
+        }
+#else
+        B2_NOT_USED(command);
+#endif
+    }
+
+private:
+    int m_ctl = -1;
+    int m_ack = -1;
+};
+
+static void PrintHeader(bool counters)
+{
+    printf("step\tstep_ms\tcollide_ms\tsolve_ms\tinit_ms\tvelocity_ms\tposition_ms"
+           "\tbroadphase_ms\ttoi_ms\tbodies\tawake\tislands\tmax_island\tcontacts"
+           "\ttouching\tcreated\tdestroyed\tmoved\tpairs\tgjk_calls\ttoi_calls"
+           "\tposition_iters\tunsolved_islands");
+    if (counters)
+    {
+        printf("\tcycles\tinstructions\tcache_misses\tbranch_misses");
+    }
+    printf("\n");
+}
+
+static void PrintStep(int32_t index, const b2World* world, bool counters)
+{
+    const b2Profile& p = world->GetProfile();
+    printf("%d\t%.4f\t%.4f\t%.4f\t%.4f\t%.4f\t%.4f\t%.4f\t%.4f", index, p.step, p.collide,
+           p.solve, p.solveInit, p.solveVelocity, p.solvePosition, p.broadphase, p.solveTOI);
+    printf("\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d",
+           world->GetBodyCount(), p.awakeBodies, p.islands, p.maxIslandBodies,
+           world->GetContactCount(), p.touchingContacts, p.contactsCreated, p.contactsDestroyed,
+           p.broadPhase.movedProxies, p.broadPhase.pairs, p.gjk.calls, p.toi.calls,
+           p.positionIterations, p.unsolvedIslands);
+    if (counters)
+    {
+        const b2PerfSample& s = p.hardware.step;
+        printf("\t%llu\t%llu\t%llu\t%llu", (unsigned long long)s.cycles,
+               (unsigned long long)s.instructions, (unsigned long long)s.cacheMisses,
+               (unsigned long long)s.branchMisses);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = nullptr;
+    int32_t from = 0;
+    int32_t to = -1;
+    bool counters = false;
+    const char* perfFifos = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc)
+        {
+            from = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc)
+        {
+            to = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--counters") == 0)
+        {
+            counters = true;
+        }
+        else if (strcmp(argv[i], "--perf-control") == 0 && i + 1 < argc)
+        {
+            perfFifos = argv[++i];
+        }
+        else if (path == nullptr && argv[i][0] != '-')
+        {
+            path = argv[i];
+        }
+        else
+        {
+            path = nullptr;
+            break;
+        }
+    }
+
+    if (path == nullptr)
+    {
+        fprintf(stderr,
+                "usage: %s capture [--from step] [--to step] [--counters]"
+                " [--perf-control ctl[,ack]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    b2Replay replay;
+    if (replay.Load(path) == false)
+    {
+        fprintf(stderr, "%s is not a capture\n", path);
+        return 1;
+    }
+
+    b2PerfCounters perfCounters;
+    if (counters && perfCounters.IsAvailable() == false)
+    {
+        fprintf(stderr, "hardware counters are not available, they read zero\n");
+    }
+
+    PerfControl perfControl;
+    if (perfFifos && perfControl.Open(perfFifos) == false)
+    {
+        fprintf(stderr, "cannot open the perf control fifos %s\n", perfFifos);
+        return 1;
+    }
+
+    PrintHeader(counters);
+    while (to < 0 || replay.GetStepIndex() <= to)
+    {
+        int32_t index = replay.GetStepIndex();
+        bool print = index >= from;
+        replay.GetWorld()->SetPerfCounters(print && counters ? &perfCounters : nullptr);
+
+        // Only the printed steps are sampled, not the replay around them.
+        if (print)
+        {
+            perfControl.Send("enable\n");
+        }
+        bool stepped = replay.Step();
+        if (print)
+        {
+            perfControl.Send("disable\n");
+        }
+
+        if (stepped == false)
+        {
+            break;
+        }
+
+        if (print)
+        {
+            PrintStep(index, replay.GetWorld(), counters);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,541 @@
+/*
+* Copyright (c) 2006-2007 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace box2d;
+
+// Sweeps the size of a world to find where the step stops scaling. Each configuration
+// builds a field of box walls, steps it and prints a line of CSV with the step time, the
+// phases of b2Profile, the touching contacts and the peak memory the worlds took from
+// their b2MemoryResource.
+//
+// Usage: Scaling [--bodies list] [--contacts list] [--sleeping list] [--shards list]
+//                [--warmup steps] [--steps steps] [--body-steps count] [--repeat count]
+//                [--out file] [--baseline file] [--tolerance fraction]
+// The lists are comma separated. The defaults sweep 1k to 1M bodies, 1 to 3 contacts per
+// body, 0 to 90% sleeping bodies and 1 to 4 shards. The contacts per body select the
+// layout of the walls, the touching column has the actual count.
+//
+// The solver runs on one thread, so a shard count of n splits the bodies into n
+// independent worlds, each stepped on its own thread, the way a server shards its
+// worlds. It does not make one world use n threads. The step time is the wall time of
+// all the worlds, the phase times are the average of the worlds.
+//
+// The warm up steps are not timed, at least one is needed to create the contacts. At
+// least --steps steps are timed, 30 by default, and the small worlds are timed until the
+// bodies times the steps reach --body-steps, 3M by default. The count only depends on
+// the configuration, because the walls settle and the step time drops as they are
+// stepped. Each configuration is built and run --repeat times, 5 by default, and the run
+// with the median step time is printed. The spread column is the range of the step times
+// of the runs over the median.
+//
+// With --baseline the step times are compared to an earlier run, such as
+// scaling_baseline.csv. The configurations more than --tolerance slower are reported and
+// the exit code is 2. The default tolerance of 15% is above the largest difference
+// between two runs of the whole matrix measured for the checked in baseline, see its
+// header. Configurations missing from the baseline are not compared; the checked in
+// baseline only has single shard rows. Build with CMAKE_BUILD_TYPE=Release.
+
+// The bodies are built in blocks of walls on their own ground.
+static const int32_t e_blockRows = 10;
+static const int32_t e_blockBodies = 100;
+
+struct Config
+{
+    int32_t bodies;
+    int32_t contactsPerBody;
+    float sleeping;
+    int32_t shards;
+};
+
+struct Result
+{
+    double step;
+    double collide;
+    double solve;
+    double solveInit;
+    double solveVelocity;
+    double solvePosition;
+    double broadphase;
+    double solveTOI;
+    int32_t touchingContacts;
+    int32_t awakeBodies;
+    int32_t islands;
+    int64_t peakBytes;
+    double spread;
+};
+
+// Counts the memory taken by one world.
+class CountingResource : public b2MemoryResource
+{
+public:
+    void* Allocate(int32_t size) override
+    {
+        m_bytes += size;
+        m_peakBytes = b2Max(m_peakBytes, m_bytes);
+        return b2Alloc(size);
+    }
+
+    void Free(void* p, int32_t size) override
+    {
+        m_bytes -= size;
+        b2Free(p);
+    }
+
+    int64_t GetPeakBytes() const
+    {
+        return m_peakBytes;
+    }
+
+private:
+    int64_t m_bytes = 0;
+    int64_t m_peakBytes = 0;
+};
+
+// Builds a wall of boxes on its own ground. The layout sets the touching contacts per
+// body: 1 for separate columns, 2 for a brick wall with gaps, where each box rests on two
+// boxes, and 3 for a brick wall without gaps. The bodies of a sleeping block are added
+// to sleepers, the others are kept awake so the sleeping fraction holds during the run.
+static void BuildBlock(b2World* world, b2Body* ground, const b2Vec<float, 2>& origin,
+                       int32_t count, int32_t contactsPerBody, bool sleeping,
+                       std::vector<b2Body*>* sleepers)
+{
+    int32_t columns = (count + e_blockRows - 1) / e_blockRows;
+    float spacing = contactsPerBody == 1 ? 1.5f : contactsPerBody == 2 ? 1.2f : 1.0f;
+    bool bricks = contactsPerBody >= 2;
+
+    b2EdgeShape edge;
+    edge.Set(origin, origin + b2Vec<float, 2>{{spacing * columns + 1.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    int32_t placed = 0;
+    for (int32_t row = 0; placed < count; ++row)
+    {
+        // The odd rows of a brick wall are shifted by half a box and one box shorter.
+        bool shifted = bricks && (row & 1);
+        int32_t rowCount = shifted ? columns - 1 : columns;
+        float offset = shifted ? 0.5f * spacing : 0.0f;
+        for (int32_t column = 0; column < rowCount && placed < count; ++column, ++placed)
+        {
+            b2BodyDef bd;
+            bd.type = b2BodyType::DYNAMIC_BODY;
+            bd.position = origin + b2Vec<float, 2>{{0.5f + offset + spacing * column,
+                                                    0.5f + 1.0f * row}};
+            bd.allowSleep = sleeping;
+            b2Body* body = world->CreateBody(&bd);
+            body->CreateFixture(&box, 1.0f);
+            if (sleeping)
+            {
+                sleepers->push_back(body);
+            }
+        }
+    }
+}
+
+// Builds the blocks of a shard, every n-th block of n shards from the shard index. The
+// blocks are laid out on a square grid shared by the shards, so the coordinates stay
+// small for a million bodies.
+static void BuildShard(b2World* world, const Config& config, int32_t shard,
+                       std::vector<b2Body*>* sleepers)
+{
+    int32_t blockCount = (config.bodies + e_blockBodies - 1) / e_blockBodies;
+    int32_t side = 1;
+    while (side * side < blockCount)
+    {
+        ++side;
+    }
+    int32_t sleepingBlocks = (int32_t)(config.sleeping * blockCount + 0.5f);
+
+    float blockWidth = 1.5f * e_blockBodies / e_blockRows + 10.0f;
+    float blockHeight = 2.0f * e_blockRows;
+
+    b2BodyDef groundDef;
+    b2Body* ground = world->CreateBody(&groundDef);
+    for (int32_t block = shard; block < blockCount; block += config.shards)
+    {
+        int32_t count = b2Min(e_blockBodies, config.bodies - block * e_blockBodies);
+        b2Vec<float, 2> origin = {{blockWidth * (block % side - 0.5f * side),
+                                   blockHeight * (block / side)}};
+        BuildBlock(world, ground, origin, count, config.contactsPerBody,
+                   block < sleepingBlocks, sleepers);
+    }
+}
+
+// Calls function with each shard index, on a thread per shard.
+template <typename Function>
+static void ForEachShard(int32_t shardCount, Function function)
+{
+    std::vector<std::thread> threads;
+    for (int32_t i = 1; i < shardCount; ++i)
+    {
+        threads.emplace_back(function, i);
+    }
+    function(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+static Result Run(const Config& config, int32_t warmup, int32_t steps)
+{
+    int32_t shardCount = config.shards;
+    std::vector<std::unique_ptr<CountingResource>> resources;
+    std::vector<std::unique_ptr<b2World>> worlds;
+    std::vector<std::vector<b2Body*>> sleepers(shardCount);
+    for (int32_t i = 0; i < shardCount; ++i)
+    {
+        resources.emplace_back(new CountingResource);
+        b2WorldDef def;
+        def.memoryResource = resources.back().get();
+        worlds.emplace_back(new b2World(&def));
+        BuildShard(worlds.back().get(), config, i, &sleepers[i]);
+    }
+
+    // The warm up is not timed. The first step creates the contacts, which wakes the
+    // bodies, so the sleeping blocks are put to sleep after it. It runs on this thread
+    // because the contact registers are initialized by the first contact created.
+    for (int32_t i = 0; i < shardCount; ++i)
+    {
+        worlds[i]->Step(1.0f / 60.0f, 8, 3);
+        for (b2Body* body : sleepers[i])
+        {
+            body->SetAwake(false);
+        }
+    }
+
+    ForEachShard(shardCount, [&](int32_t shard) {
+        for (int32_t i = 1; i < warmup; ++i)
+        {
+            worlds[shard]->Step(1.0f / 60.0f, 8, 3);
+        }
+    });
+
+    std::vector<Result> shards(shardCount, Result());
+    auto start = std::chrono::steady_clock::now();
+    ForEachShard(shardCount, [&](int32_t shard) {
+        b2World* world = worlds[shard].get();
+        Result& r = shards[shard];
+        for (int32_t i = 0; i < steps; ++i)
+        {
+            world->Step(1.0f / 60.0f, 8, 3);
+            const b2Profile& p = world->GetProfile();
+            r.collide += p.collide;
+            r.solve += p.solve;
+            r.solveInit += p.solveInit;
+            r.solveVelocity += p.solveVelocity;
+            r.solvePosition += p.solvePosition;
+            r.broadphase += p.broadphase;
+            r.solveTOI += p.solveTOI;
+        }
+        const b2Profile& p = world->GetProfile();
+        r.touchingContacts = p.touchingContacts;
+        r.awakeBodies = p.awakeBodies;
+        r.islands = p.islands;
+    });
+    auto end = std::chrono::steady_clock::now();
+
+    Result result = Result();
+    result.step = std::chrono::duration<double, std::milli>(end - start).count() / steps;
+    double scale = 1.0 / ((double)steps * shardCount);
+    for (int32_t i = 0; i < shardCount; ++i)
+    {
+        const Result& r = shards[i];
+        result.collide += r.collide * scale;
+        result.solve += r.solve * scale;
+        result.solveInit += r.solveInit * scale;
+        result.solveVelocity += r.solveVelocity * scale;
+        result.solvePosition += r.solvePosition * scale;
+        result.broadphase += r.broadphase * scale;
+        result.solveTOI += r.solveTOI * scale;
+        result.touchingContacts += r.touchingContacts;
+        result.awakeBodies += r.awakeBodies;
+        result.islands += r.islands;
+        result.peakBytes += resources[i]->GetPeakBytes();
+    }
+
+    // The worlds must go before their resources.
+    worlds.clear();
+    return result;
+}
+
+static const char* s_header = "bodies,contacts_per_body,sleeping,shards,step_ms,collide_ms,"
+                              "solve_ms,init_ms,velocity_ms,position_ms,broadphase_ms,toi_ms,"
+                              "touching,awake,islands,peak_kb,spread";
+
+// The configuration columns of a line, used to match a baseline.
+static std::string GetKey(const Config& config)
+{
+    char key[64];
+    snprintf(key, sizeof(key), "%d,%d,%.2f,%d", config.bodies, config.contactsPerBody,
+             config.sleeping, config.shards);
+    return key;
+}
+
+static void PrintResult(FILE* file, const Config& config, const Result& r)
+{
+    fprintf(file, "%s,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d,%lld,%.3f\n",
+            GetKey(config).c_str(), r.step, r.collide, r.solve, r.solveInit, r.solveVelocity,
+            r.solvePosition, r.broadphase, r.solveTOI, r.touchingContacts, r.awakeBodies,
+            r.islands, (long long)(r.peakBytes / 1024), r.spread);
+    fflush(file);
+}
+
+// Reads the step times of a CSV written by this program. Lines starting with # are
+// comments.
+static bool LoadBaseline(const char* path, std::map<std::string, double>* baseline)
+{
+    FILE* file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#' || strncmp(line, "bodies,", 7) == 0)
+        {
+            continue;
+        }
+
+        // The step time follows the four configuration columns.
+        char* p = line;
+        for (int32_t i = 0; i < 4 && p; ++i)
+        {
+            p = strchr(p + 1, ',');
+        }
+        if (p)
+        {
+            (*baseline)[std::string(line, p)] = atof(p + 1);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+template <typename T>
+static bool ParseList(const char* text, std::vector<T>* list)
+{
+    list->clear();
+    while (*text)
+    {
+        char* end;
+        double value = strtod(text, &end);
+        if (end == text)
+        {
+            return false;
+        }
+        list->push_back((T)value);
+        text = *end == ',' ? end + 1 : end;
+    }
+    return list->empty() == false;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int32_t> bodies = {1000, 10000, 100000, 1000000};
+    std::vector<int32_t> contacts = {1, 2, 3};
+    std::vector<float> sleeping = {0.0f, 0.5f, 0.9f};
+    std::vector<int32_t> shards = {1, 2, 4};
+    int32_t warmup = 10;
+    int32_t steps = 30;
+    int64_t bodySteps = 3000000;
+    int32_t repeat = 5;
+    const char* outPath = nullptr;
+    const char* baselinePath = nullptr;
+    float tolerance = 0.15f;
+
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr)
+        {
+            valid = false;
+        }
+        else if (strcmp(arg, "--bodies") == 0)
+        {
+            valid = ParseList(value, &bodies);
+        }
+        else if (strcmp(arg, "--contacts") == 0)
+        {
+            valid = ParseList(value, &contacts);
+        }
+        else if (strcmp(arg, "--sleeping") == 0)
+        {
+            valid = ParseList(value, &sleeping);
+        }
+        else if (strcmp(arg, "--shards") == 0)
+        {
+            valid = ParseList(value, &shards);
+        }
+        else if (strcmp(arg, "--warmup") == 0)
+        {
+            warmup = atoi(value);
+        }
+        else if (strcmp(arg, "--steps") == 0)
+        {
+            steps = atoi(value);
+        }
+        else if (strcmp(arg, "--body-steps") == 0)
+        {
+            bodySteps = atoll(value);
+        }
+        else if (strcmp(arg, "--repeat") == 0)
+        {
+            repeat = atoi(value);
+        }
+        else if (strcmp(arg, "--out") == 0)
+        {
+            outPath = value;
+        }
+        else if (strcmp(arg, "--baseline") == 0)
+        {
+            baselinePath = value;
+        }
+        else if (strcmp(arg, "--tolerance") == 0)
+        {
+            tolerance = (float)atof(value);
+        }
+        else
+        {
+            valid = false;
+        }
+        ++i;
+    }
+
+    for (int32_t count : bodies)
+    {
+        valid = valid && count > 0;
+    }
+    for (int32_t count : contacts)
+    {
+        valid = valid && 1 <= count && count <= 3;
+    }
+    for (float fraction : sleeping)
+    {
+        valid = valid && 0.0f <= fraction && fraction <= 1.0f;
+    }
+    for (int32_t count : shards)
+    {
+        valid = valid && count > 0;
+    }
+    if (valid == false || warmup <= 0 || steps <= 0 || bodySteps < 0 || repeat <= 0)
+    {
+        fprintf(stderr,
+                "usage: %s [--bodies list] [--contacts list] [--sleeping list] [--shards list]\n"
+                "       [--warmup steps] [--steps steps] [--body-steps count] [--repeat count]\n"
+                "       [--out file] [--baseline file] [--tolerance fraction]\n"
+                "Contacts per body are 1 to 3, sleeping fractions are 0 to 1. A shard count\n"
+                "of n splits the bodies into n independent worlds, each on its own thread.\n",
+                argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, double> baseline;
+    if (baselinePath && LoadBaseline(baselinePath, &baseline) == false)
+    {
+        fprintf(stderr, "cannot read %s\n", baselinePath);
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (outPath)
+    {
+        out = fopen(outPath, "w");
+        if (out == nullptr)
+        {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            return 1;
+        }
+    }
+
+    fprintf(out, "%s\n", s_header);
+    int32_t regressions = 0;
+    for (int32_t count : bodies)
+    {
+        for (int32_t contactsPerBody : contacts)
+        {
+            for (float fraction : sleeping)
+            {
+                for (int32_t shardCount : shards)
+                {
+                    Config config = {count, contactsPerBody, fraction, shardCount};
+                    int64_t timedSteps = b2Max<int64_t>(steps, (bodySteps + count - 1) / count);
+                    std::vector<Result> runs;
+                    for (int32_t i = 0; i < repeat; ++i)
+                    {
+                        runs.push_back(Run(config, warmup, (int32_t)timedSteps));
+                    }
+                    std::sort(runs.begin(), runs.end(), [](const Result& a, const Result& b) {
+                        return a.step < b.step;
+                    });
+
+                    // The upper median for an even count.
+                    Result result = runs[runs.size() / 2];
+                    result.spread = (runs.back().step - runs.front().step) / result.step;
+                    PrintResult(out, config, result);
+
+                    auto it = baseline.find(GetKey(config));
+                    if (it == baseline.end() || it->second <= 0.0)
+                    {
+                        continue;
+                    }
+
+                    double ratio = result.step / it->second;
+                    bool slower = ratio > 1.0 + tolerance;
+                    regressions += slower ? 1 : 0;
+                    fprintf(stderr, "%s: %.4f ms, baseline %.4f ms, x%.2f%s\n",
+                            GetKey(config).c_str(), result.step, it->second, ratio,
+                            slower ? " SLOWER" : "");
+                }
+            }
+        }
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    if (regressions > 0)
+    {
+        fprintf(stderr, "%d configurations are more than %.0f%% slower than the baseline\n",
+                regressions, 100.0f * tolerance);
+        return 2;
+    }
+
+    return 0;
+}
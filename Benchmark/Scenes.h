@@ -0,0 +1,382 @@
+/*
+* Copyright (c) 2006-2007 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BENCHMARK_SCENES_H
+#define B2_BENCHMARK_SCENES_H
+
+#include <Box2D/Box2D.h>
+
+#include <cmath>
+#include <vector>
+
+// Deterministic scenes shared by the benchmarks and the regression harness. Each Build
+// function fills an empty world with a gravity of (0, -10), scaled by the size parameter,
+// unless noted otherwise.
+
+namespace scenes
+{
+using namespace box2d;
+
+// Small deterministic generator so every run sees the same scene.
+inline float RandomFloat(uint32_t* seed, float lo, float hi)
+{
+    *seed = 1664525u * *seed + 1013904223u;
+    float r = float(*seed >> 8) / float(1 << 24);
+    return lo + (hi - lo) * r;
+}
+
+inline b2Body* CreateGround(b2World* world, float halfWidth)
+{
+    b2BodyDef bd;
+    b2Body* ground = world->CreateBody(&bd);
+    b2EdgeShape edge;
+    edge.Set({{-halfWidth, 0.0f}}, {{halfWidth, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+    return ground;
+}
+
+// A pyramid of boxes with the given number of boxes in its base.
+inline void BuildPyramid(b2World* world, int32_t base)
+{
+    CreateGround(world, 2.0f * base);
+
+    b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t row = 0; row < base; ++row)
+    {
+        for (int32_t i = 0; i < base - row; ++i)
+        {
+            b2BodyDef bd;
+            bd.type = b2BodyType::DYNAMIC_BODY;
+            bd.position = {{-0.5f * (base - row) + 1.0f * i + 0.5f, 0.5f + 1.0f * row}};
+            world->CreateBody(&bd)->CreateFixture(&box, 5.0f);
+        }
+    }
+}
+
+// A rotating hollow box, driven by a motor, filled with small boxes.
+inline void BuildTumbler(b2World* world, int32_t count)
+{
+    b2BodyDef groundDef;
+    b2Body* ground = world->CreateBody(&groundDef);
+
+    b2BodyDef bd;
+    bd.type = b2BodyType::DYNAMIC_BODY;
+    bd.allowSleep = false;
+    bd.position = {{0.0f, 10.0f}};
+    b2Body* tumbler = world->CreateBody(&bd);
+
+    b2PolygonShape wall;
+    wall.SetAsBox(0.5f, 10.0f, {{10.0f, 0.0f}}, 0.0f);
+    tumbler->CreateFixture(&wall, 5.0f);
+    wall.SetAsBox(0.5f, 10.0f, {{-10.0f, 0.0f}}, 0.0f);
+    tumbler->CreateFixture(&wall, 5.0f);
+    wall.SetAsBox(10.0f, 0.5f, {{0.0f, 10.0f}}, 0.0f);
+    tumbler->CreateFixture(&wall, 5.0f);
+    wall.SetAsBox(10.0f, 0.5f, {{0.0f, -10.0f}}, 0.0f);
+    tumbler->CreateFixture(&wall, 5.0f);
+
+    b2RevoluteJointDef jd;
+    jd.bodyA = ground;
+    jd.bodyB = tumbler;
+    jd.localAnchorA = {{0.0f, 10.0f}};
+    jd.localAnchorB = {{0.0f, 0.0f}};
+    jd.referenceAngle = 0.0f;
+    jd.motorSpeed = 0.05f * B2_PI;
+    jd.maxMotorTorque = 1.0e8f;
+    jd.enableMotor = true;
+    world->CreateJoint(&jd);
+
+    b2PolygonShape box;
+    box.SetAsBox(0.125f, 0.125f);
+    int32_t side = (int32_t)std::ceil(std::sqrt((float)count));
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2BodyDef bd2;
+        bd2.type = b2BodyType::DYNAMIC_BODY;
+        float x = -9.0f + 18.0f * (i % side) / side;
+        float y = 1.0f + 18.0f * (i / side) / side;
+        bd2.position = {{x, y}};
+        world->CreateBody(&bd2)->CreateFixture(&box, 1.0f);
+    }
+}
+
+// Circles dropped on the ground from a grid, with some jitter.
+inline void BuildCircles(b2World* world, int32_t count)
+{
+    int32_t side = (int32_t)std::ceil(std::sqrt((float)count));
+    CreateGround(world, 1.5f * side);
+
+    uint32_t seed = 1234u;
+    b2CircleShape circle;
+    circle.SetRadius(0.5f);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2BodyDef bd;
+        bd.type = b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-0.6f * side + 1.2f * (i % side) + RandomFloat(&seed, -0.1f, 0.1f),
+                        1.0f + 1.2f * (i / side)}};
+        world->CreateBody(&bd)->CreateFixture(&circle, 1.0f);
+    }
+}
+
+// Bumpy chain terrain with cars made of a body and two motorized wheels.
+inline void BuildTerrainVehicles(b2World* world, int32_t count)
+{
+    float halfWidth = 20.0f * count + 40.0f;
+    std::vector<b2Vec<float, 2>> vertices;
+    for (float x = -halfWidth; x <= halfWidth; x += 1.0f)
+    {
+        vertices.push_back({{x, 0.5f * std::sin(0.4f * x) + 0.25f * std::sin(1.3f * x)}});
+    }
+
+    b2BodyDef groundDef;
+    b2Body* ground = world->CreateBody(&groundDef);
+    b2ChainShape chain;
+    chain.CreateChain(vertices.data(), (int32_t)vertices.size());
+    ground->CreateFixture(&chain, 0.0f);
+
+    b2PolygonShape chassis;
+    b2Vec<float, 2> points[6] = {{{-1.5f, -0.5f}}, {{1.5f, -0.5f}}, {{1.5f, 0.0f}},
+                                 {{0.0f, 0.9f}},   {{-1.15f, 0.9f}}, {{-1.5f, 0.2f}}};
+    chassis.Set(points, 6);
+
+    b2CircleShape wheel;
+    wheel.SetRadius(0.4f);
+
+    b2FixtureDef wheelDef;
+    wheelDef.shape = &wheel;
+    wheelDef.density = 1.0f;
+    wheelDef.friction = 0.9f;
+
+    for (int32_t i = 0; i < count; ++i)
+    {
+        float x = -halfWidth + 40.0f + 40.0f * i;
+
+        b2BodyDef bd;
+        bd.type = b2BodyType::DYNAMIC_BODY;
+        bd.position = {{x, 3.0f}};
+        b2Body* car = world->CreateBody(&bd);
+        car->CreateFixture(&chassis, 1.0f);
+
+        for (float offset : {-1.0f, 1.0f})
+        {
+            bd.position = {{x + offset, 2.35f}};
+            b2Body* body = world->CreateBody(&bd);
+            body->CreateFixture(&wheelDef);
+
+            b2WheelJointDef jd;
+            jd.Initialize(car, body, body->GetPosition(), {{0.0f, 1.0f}});
+            jd.motorSpeed = -20.0f;
+            jd.maxMotorTorque = 20.0f;
+            jd.enableMotor = true;
+            jd.frequencyHz = 4.0f;
+            jd.dampingRatio = 0.7f;
+            world->CreateJoint(&jd);
+        }
+    }
+}
+
+// Ragdolls of boxes and revolute joints with limits, dropped in a pile.
+inline void BuildRagdolls(b2World* world, int32_t count)
+{
+    CreateGround(world, 40.0f);
+
+    b2PolygonShape torso;
+    torso.SetAsBox(0.25f, 0.5f);
+    b2CircleShape head;
+    head.SetRadius(0.2f);
+    b2PolygonShape limb;
+    limb.SetAsBox(0.08f, 0.3f);
+
+    uint32_t seed = 42u;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2Vec<float, 2> origin{{RandomFloat(&seed, -2.0f, 2.0f), 2.0f + 2.5f * i}};
+
+        b2BodyDef bd;
+        bd.type = b2BodyType::DYNAMIC_BODY;
+        bd.position = origin;
+        b2Body* body = world->CreateBody(&bd);
+        body->CreateFixture(&torso, 1.0f);
+
+        bd.position = origin + b2Vec<float, 2>{{0.0f, 0.75f}};
+        b2Body* headBody = world->CreateBody(&bd);
+        headBody->CreateFixture(&head, 1.0f);
+
+        b2RevoluteJointDef jd;
+        jd.enableLimit = true;
+        jd.lowerAngle = -0.25f * B2_PI;
+        jd.upperAngle = 0.25f * B2_PI;
+        jd.Initialize(body, headBody, origin + b2Vec<float, 2>{{0.0f, 0.5f}});
+        world->CreateJoint(&jd);
+
+        // Arms hang from the shoulders and legs from the hips, two segments each.
+        b2Vec<float, 2> anchors[4] = {{{-0.3f, 0.4f}}, {{0.3f, 0.4f}}, {{-0.15f, -0.5f}},
+                                      {{0.15f, -0.5f}}};
+        for (const b2Vec<float, 2>& anchor : anchors)
+        {
+            b2Body* parent = body;
+            for (int32_t segment = 0; segment < 2; ++segment)
+            {
+                b2Vec<float, 2> top = origin + anchor - b2Vec<float, 2>{{0.0f, 0.6f * segment}};
+                bd.position = top - b2Vec<float, 2>{{0.0f, 0.3f}};
+                b2Body* part = world->CreateBody(&bd);
+                part->CreateFixture(&limb, 1.0f);
+
+                jd.Initialize(parent, part, top);
+                world->CreateJoint(&jd);
+                parent = part;
+            }
+        }
+    }
+}
+
+// Loose circles and boxes dropped into a bin.
+inline void BuildPile(b2World* world, int32_t count)
+{
+    b2BodyDef groundDef;
+    b2Body* ground = world->CreateBody(&groundDef);
+
+    b2PolygonShape wall;
+    wall.SetAsBox(10.0f, 0.5f);
+    ground->CreateFixture(&wall, 0.0f);
+    wall.SetAsBox(0.5f, 10.0f, {{-10.0f, 10.0f}}, 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+    wall.SetAsBox(0.5f, 10.0f, {{10.0f, 10.0f}}, 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+
+    b2CircleShape circle;
+    circle.SetRadius(0.3f);
+    b2PolygonShape box;
+    box.SetAsBox(0.3f, 0.3f);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2BodyDef bd;
+        bd.type = b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-8.0f + 0.8f * (i % 20) + 0.05f * (i / 20 % 2), 1.5f + 0.8f * (i / 20)}};
+        bd.angle = 0.1f * i;
+        b2Shape* shape = i % 3 ? (b2Shape*)&circle : (b2Shape*)&box;
+        world->CreateBody(&bd)->CreateFixture(shape, 1.0f);
+    }
+}
+
+// Four chains of boxes, each hanging from the ground by revolute joints.
+inline void BuildChains(b2World* world, int32_t links)
+{
+    b2Body* ground = CreateGround(world, 40.0f);
+
+    b2PolygonShape link;
+    link.SetAsBox(0.5f, 0.125f);
+    for (int32_t c = 0; c < 4; ++c)
+    {
+        float x0 = -15.0f + 10.0f * c;
+        b2Body* prev = ground;
+        for (int32_t i = 0; i < links; ++i)
+        {
+            b2BodyDef bd;
+            bd.type = b2BodyType::DYNAMIC_BODY;
+            bd.position = {{x0 + 0.5f + i, 25.0f}};
+            b2Body* body = world->CreateBody(&bd);
+            body->CreateFixture(&link, 1.0f);
+
+            b2RevoluteJointDef jd;
+            jd.Initialize(prev, body, {{x0 + i, 25.0f}});
+            world->CreateJoint(&jd);
+            prev = body;
+        }
+    }
+}
+
+// A wall of boxes shot at by fast circles, with continuous collision.
+inline void BuildBullets(b2World* world, int32_t count)
+{
+    CreateGround(world, 40.0f);
+
+    b2PolygonShape box;
+    box.SetAsBox(0.25f, 0.25f);
+    for (int32_t row = 0; row < 20; ++row)
+    {
+        for (int32_t column = 0; column < 4; ++column)
+        {
+            b2BodyDef bd;
+            bd.type = b2BodyType::DYNAMIC_BODY;
+            bd.position = {{10.0f + 0.5f * column, 0.25f + 0.5f * row}};
+            world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+        }
+    }
+
+    b2CircleShape circle;
+    circle.SetRadius(0.05f);
+    uint32_t seed = 7u;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2BodyDef bd;
+        bd.type = b2BodyType::DYNAMIC_BODY;
+        bd.bullet = true;
+        bd.position = {{-20.0f - 0.5f * i, RandomFloat(&seed, 0.5f, 9.5f)}};
+        bd.linearVelocity = {{300.0f, 0.0f}};
+        world->CreateBody(&bd)->CreateFixture(&circle, 10.0f);
+    }
+}
+
+// Half width of the closed arena built by BuildArena.
+constexpr float ARENA_EXTENT = 20.0f;
+
+// A closed arena filled with fast, bouncing circles or boxes. Meant for a world without
+// gravity. Bodies that end up outside of the arena have tunneled through a wall.
+inline void BuildArena(b2World* world, int32_t count, bool boxes, bool bullets)
+{
+    const float extent = ARENA_EXTENT;
+
+    b2BodyDef groundDef;
+    b2Body* ground = world->CreateBody(&groundDef);
+    b2Vec<float, 2> vs[4] = {
+        {{-extent, -extent}}, {{extent, -extent}}, {{extent, extent}}, {{-extent, extent}}};
+    b2ChainShape loop;
+    loop.CreateLoop(vs, 4);
+    ground->CreateFixture(&loop, 0.0f);
+
+    b2CircleShape circle;
+    circle.SetRadius(0.1f);
+    b2PolygonShape box;
+    box.SetAsBox(0.1f, 0.1f);
+
+    b2FixtureDef fd;
+    fd.shape = boxes ? (b2Shape*)&box : (b2Shape*)&circle;
+    fd.density = 1.0f;
+    fd.restitution = 0.8f;
+    fd.friction = 0.0f;
+
+    uint32_t seed = 12345u;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2BodyDef bd;
+        bd.type = b2BodyType::DYNAMIC_BODY;
+        bd.bullet = bullets;
+        bd.allowSleep = false;
+        bd.position = {{RandomFloat(&seed, -0.9f * extent, 0.9f * extent),
+                        RandomFloat(&seed, -0.9f * extent, 0.9f * extent)}};
+        bd.linearVelocity = {{RandomFloat(&seed, -100.0f, 100.0f),
+                              RandomFloat(&seed, -100.0f, 100.0f)}};
+        world->CreateBody(&bd)->CreateFixture(&fd);
+    }
+}
+}
+
+#endif
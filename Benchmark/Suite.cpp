@@ -0,0 +1,389 @@
+/*
+* Copyright (c) 2006-2007 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Scenes.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string.h>
+#include <vector>
+
+using namespace box2d;
+
+// Google Benchmark suite over the world scenes of Scenes.h and the hot collision and
+// memory routines. The results are printed as JSON unless another --benchmark_format is
+// given. Use --benchmark_out=<file> to also keep them in a file.
+
+typedef void (*BuildFunction)(b2World* world, int32_t size);
+
+static const int32_t e_stepCount = 60;
+
+// Steps a fresh world e_stepCount times per iteration. Building and destroying the world
+// are not timed.
+static void RunScene(benchmark::State& state, BuildFunction build)
+{
+    int32_t size = (int32_t)state.range(0);
+    float stepTime = 0.0f;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::unique_ptr<b2World> world(new b2World(b2Vec<float, 2>{{0.0f, -10.0f}}));
+        build(world.get(), size);
+        state.ResumeTiming();
+
+        for (int32_t i = 0; i < e_stepCount; ++i)
+        {
+            world->Step(1.0f / 60.0f, 8, 3);
+            stepTime += world->GetProfile().step;
+        }
+
+        state.PauseTiming();
+        world.reset();
+        state.ResumeTiming();
+    }
+
+    int64_t steps = state.iterations() * e_stepCount;
+    state.SetItemsProcessed(steps);
+    state.counters["step_ms"] = stepTime / steps;
+}
+
+static void Pyramid(benchmark::State& state)
+{
+    RunScene(state, scenes::BuildPyramid);
+}
+BENCHMARK(Pyramid)->Arg(10)->Arg(20)->Arg(40)->Unit(benchmark::kMillisecond);
+
+static void Tumbler(benchmark::State& state)
+{
+    RunScene(state, scenes::BuildTumbler);
+}
+BENCHMARK(Tumbler)->Arg(200)->Arg(800)->Unit(benchmark::kMillisecond);
+
+static void Circles(benchmark::State& state)
+{
+    RunScene(state, scenes::BuildCircles);
+}
+BENCHMARK(Circles)->Arg(500)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void TerrainVehicles(benchmark::State& state)
+{
+    RunScene(state, scenes::BuildTerrainVehicles);
+}
+BENCHMARK(TerrainVehicles)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond);
+
+static void Ragdolls(benchmark::State& state)
+{
+    RunScene(state, scenes::BuildRagdolls);
+}
+BENCHMARK(Ragdolls)->Arg(10)->Arg(40)->Unit(benchmark::kMillisecond);
+
+static void Bullets(benchmark::State& state)
+{
+    RunScene(state, scenes::BuildBullets);
+}
+BENCHMARK(Bullets)->Arg(50)->Arg(200)->Unit(benchmark::kMillisecond);
+
+// Random boxes in a square whose area grows with the proxy count.
+static std::vector<b2AABB> MakeBoxes(int32_t count, uint32_t seed)
+{
+    float extent = std::sqrt((float)count);
+    std::vector<b2AABB> boxes(count);
+    for (b2AABB& aabb : boxes)
+    {
+        b2Vec<float, 2> p{{scenes::RandomFloat(&seed, -extent, extent),
+                           scenes::RandomFloat(&seed, -extent, extent)}};
+        b2Vec<float, 2> h{{scenes::RandomFloat(&seed, 0.1f, 0.5f),
+                           scenes::RandomFloat(&seed, 0.1f, 0.5f)}};
+        aabb.lowerBound = p - h;
+        aabb.upperBound = p + h;
+    }
+    return boxes;
+}
+
+class TreeCallback
+{
+public:
+    bool QueryCallback(int32_t proxyId)
+    {
+        B2_NOT_USED(proxyId);
+        ++count;
+        return true;
+    }
+
+    float RayCastCallback(const b2RayCastInput& input, int32_t proxyId)
+    {
+        B2_NOT_USED(proxyId);
+        ++count;
+        return input.maxFraction;
+    }
+
+    int32_t count = 0;
+};
+
+static void TreeQuery(benchmark::State& state)
+{
+    int32_t count = (int32_t)state.range(0);
+    b2DynamicTree tree;
+    for (const b2AABB& aabb : MakeBoxes(count, 1u))
+    {
+        tree.CreateProxy(aabb, nullptr);
+    }
+
+    std::vector<b2AABB> queries = MakeBoxes(1024, 2u);
+    TreeCallback callback;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        tree.Query(&callback, queries[i++ & 1023]);
+    }
+    benchmark::DoNotOptimize(callback.count);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TreeQuery)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void TreeRayCast(benchmark::State& state)
+{
+    int32_t count = (int32_t)state.range(0);
+    b2DynamicTree tree;
+    for (const b2AABB& aabb : MakeBoxes(count, 1u))
+    {
+        tree.CreateProxy(aabb, nullptr);
+    }
+
+    float extent = std::sqrt((float)count);
+    uint32_t seed = 3u;
+    std::vector<b2RayCastInput> rays(1024);
+    for (b2RayCastInput& ray : rays)
+    {
+        ray.p1 = {{-extent, scenes::RandomFloat(&seed, -extent, extent)}};
+        ray.p2 = {{extent, scenes::RandomFloat(&seed, -extent, extent)}};
+        ray.maxFraction = 1.0f;
+    }
+
+    TreeCallback callback;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        tree.RayCast(&callback, rays[i++ & 1023]);
+    }
+    benchmark::DoNotOptimize(callback.count);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TreeRayCast)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Moves proxies back and forth far enough to leave their fat AABB.
+static void TreeMove(benchmark::State& state)
+{
+    int32_t count = (int32_t)state.range(0);
+    b2DynamicTree tree;
+    std::vector<b2AABB> boxes = MakeBoxes(count, 1u);
+    std::vector<int32_t> proxies;
+    for (const b2AABB& aabb : boxes)
+    {
+        proxies.push_back(tree.CreateProxy(aabb, nullptr));
+    }
+
+    b2Vec<float, 2> offset{{1.0f, 0.0f}};
+    int32_t i = 0;
+    int32_t pass = 0;
+    for (auto _ : state)
+    {
+        b2AABB aabb = boxes[i];
+        if (pass & 1)
+        {
+            aabb.lowerBound += offset;
+            aabb.upperBound += offset;
+        }
+        tree.MoveProxy(proxies[i], aabb, (pass & 1) ? offset : -offset);
+
+        if (++i == count)
+        {
+            i = 0;
+            ++pass;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TreeMove)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void CollidePolygons(benchmark::State& state)
+{
+    b2PolygonShape boxA;
+    boxA.SetAsBox(0.5f, 0.5f);
+    b2PolygonShape boxB;
+    boxB.SetAsBox(1.0f, 0.25f);
+
+    b2Transform xfA;
+    xfA.Set({{0.0f, 0.0f}}, 0.0f);
+    b2Transform xfB;
+    xfB.Set({{0.3f, 0.6f}}, 0.3f);
+
+    b2Manifold manifold;
+    for (auto _ : state)
+    {
+        b2CollidePolygons(&manifold, &boxA, xfA, &boxB, xfB);
+        benchmark::DoNotOptimize(manifold.pointCount);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CollidePolygons);
+
+static void Distance(benchmark::State& state)
+{
+    b2PolygonShape boxA;
+    boxA.SetAsBox(0.5f, 0.5f);
+    b2Vec<float, 2> points[5] = {
+        {{0.0f, -0.5f}}, {{0.5f, -0.2f}}, {{0.3f, 0.4f}}, {{-0.3f, 0.4f}}, {{-0.5f, -0.2f}}};
+    b2PolygonShape pentagon;
+    pentagon.Set(points, 5);
+
+    b2DistanceInput input;
+    input.proxyA.Set(&boxA, 0);
+    input.proxyB.Set(&pentagon, 0);
+    input.transformA.Set({{0.0f, 0.0f}}, 0.0f);
+    input.transformB.Set({{1.5f, 0.7f}}, 0.4f);
+    input.useRadii = true;
+
+    b2DistanceOutput output;
+    for (auto _ : state)
+    {
+        b2SimplexCache cache;
+        cache.count = 0;
+        b2Distance(&output, &cache, &input);
+        benchmark::DoNotOptimize(output.distance);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(Distance);
+
+static void TimeOfImpact(benchmark::State& state)
+{
+    b2PolygonShape boxA;
+    boxA.SetAsBox(2.0f, 0.1f);
+    b2PolygonShape boxB;
+    boxB.SetAsBox(0.25f, 0.25f);
+
+    b2TOIInput input;
+    input.proxyA.Set(&boxA, 0);
+    input.proxyB.Set(&boxB, 0);
+
+    input.sweepA.localCenter = {{0.0f, 0.0f}};
+    input.sweepA.c0 = {{0.0f, 0.0f}};
+    input.sweepA.c = input.sweepA.c0;
+    input.sweepA.a0 = 0.0f;
+    input.sweepA.a = 0.0f;
+    input.sweepA.alpha0 = 0.0f;
+
+    input.sweepB.localCenter = {{0.0f, 0.0f}};
+    input.sweepB.c0 = {{-0.5f, 3.0f}};
+    input.sweepB.c = {{0.5f, -3.0f}};
+    input.sweepB.a0 = 0.0f;
+    input.sweepB.a = 2.0f;
+    input.sweepB.alpha0 = 0.0f;
+    input.tMax = 1.0f;
+
+    b2TOIOutput output;
+    for (auto _ : state)
+    {
+        b2TimeOfImpact(&output, &input);
+        benchmark::DoNotOptimize(output.t);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TimeOfImpact);
+
+// Allocates a batch of mixed size blocks and frees them in a shuffled order.
+static void BlockAllocator(benchmark::State& state)
+{
+    int32_t count = (int32_t)state.range(0);
+    const int32_t sizes[4] = {64, 152, 216, 96};
+    std::vector<int32_t> order(count);
+    uint32_t seed = 5u;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        order[i] = i;
+    }
+    for (int32_t i = count - 1; i > 0; --i)
+    {
+        int32_t j = (int32_t)scenes::RandomFloat(&seed, 0.0f, (float)i);
+        std::swap(order[i], order[j]);
+    }
+
+    b2BlockAllocator allocator;
+    std::vector<void*> blocks(count);
+    for (auto _ : state)
+    {
+        for (int32_t i = 0; i < count; ++i)
+        {
+            blocks[i] = allocator.Allocate(sizes[i & 3]);
+        }
+        for (int32_t i : order)
+        {
+            allocator.Free(blocks[i], sizes[i & 3]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BlockAllocator)->Arg(1000)->Arg(100000);
+
+static void StackAllocator(benchmark::State& state)
+{
+    int32_t count = (int32_t)state.range(0);
+    b2StackAllocator allocator;
+    std::vector<void*> blocks(count);
+    for (auto _ : state)
+    {
+        for (int32_t i = 0; i < count; ++i)
+        {
+            blocks[i] = allocator.Allocate(16 + 16 * (i & 7));
+        }
+        for (int32_t i = count - 1; i >= 0; --i)
+        {
+            allocator.Free(blocks[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(StackAllocator)->Arg(8)->Arg(30);
+
+int main(int argc, char** argv)
+{
+    // Default to JSON so the results can be compared across releases.
+    std::vector<char*> args(argv, argv + argc);
+    char format[] = "--benchmark_format=json";
+    bool hasFormat = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        hasFormat = hasFormat || strncmp(argv[i], "--benchmark_format", 18) == 0;
+    }
+    if (hasFormat == false)
+    {
+        args.push_back(format);
+    }
+
+    int count = (int)args.size();
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -34,7 +34,12 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Common/b2Settings.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Profiler.h>
+#include <Box2D/Common/b2PerfCounters.h>
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Common/b2MemoryResource.h>
+#include <Box2D/Common/b2HugePageResource.h>
+#include <Box2D/Common/b2BlockCache.h>
 
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
@@ -42,6 +47,7 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Collision/b2BroadPhaseStats.h>
 #include <Box2D/Collision/b2Distance.h>
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
@@ -51,6 +57,7 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 
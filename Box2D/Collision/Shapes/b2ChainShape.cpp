@@ -30,9 +30,13 @@ b2ChainShape::~b2ChainShape()
 
 void b2ChainShape::Clear()
 {
-    b2Free(m_vertices);
+    if (m_vertices)
+    {
+        m_resource->Free(m_vertices, m_count * sizeof(b2Vec<float, 2>));
+    }
     m_vertices = nullptr;
     m_count = 0;
+    m_tree.reset();
 }
 
 void b2ChainShape::CreateLoop(const b2Vec<float, 2>* vertices, int32_t count)
@@ -48,13 +52,18 @@ void b2ChainShape::CreateLoop(const b2Vec<float, 2>* vertices, int32_t count)
     }
 
     m_count = count + 1;
-    m_vertices = (b2Vec<float, 2>*)b2Alloc(m_count * sizeof(b2Vec<float, 2>));
+    m_vertices = (b2Vec<float, 2>*)m_resource->Allocate(m_count * sizeof(b2Vec<float, 2>));
     memcpy(m_vertices, vertices, count * sizeof(b2Vec<float, 2>));
     m_vertices[count] = m_vertices[0];
     m_prevVertex = m_vertices[m_count - 2];
     m_nextVertex = m_vertices[1];
     m_hasPrevVertex = true;
     m_hasNextVertex = true;
+
+    if (m_useLocalTree)
+    {
+        CreateLocalTree();
+    }
 }
 
 void b2ChainShape::CreateChain(const b2Vec<float, 2>* vertices, int32_t count)
@@ -68,7 +77,7 @@ void b2ChainShape::CreateChain(const b2Vec<float, 2>* vertices, int32_t count)
     }
 
     m_count = count;
-    m_vertices = (b2Vec<float, 2>*)b2Alloc(count * sizeof(b2Vec<float, 2>));
+    m_vertices = (b2Vec<float, 2>*)m_resource->Allocate(count * sizeof(b2Vec<float, 2>));
     memcpy(m_vertices, vertices, m_count * sizeof(b2Vec<float, 2>));
 
     m_hasPrevVertex = false;
@@ -76,6 +85,11 @@ void b2ChainShape::CreateChain(const b2Vec<float, 2>* vertices, int32_t count)
 
     m_prevVertex = {{0.0f, 0.0f}};
     m_nextVertex = {{0.0f, 0.0f}};
+
+    if (m_useLocalTree)
+    {
+        CreateLocalTree();
+    }
 }
 
 void b2ChainShape::SetPrevVertex(const b2Vec<float, 2>& prevVertex)
@@ -90,10 +104,68 @@ void b2ChainShape::SetNextVertex(const b2Vec<float, 2>& nextVertex)
     m_hasNextVertex = true;
 }
 
+void b2ChainShape::SetLocalTree(bool flag)
+{
+    m_useLocalTree = flag;
+    if (flag == false)
+    {
+        m_tree.reset();
+    }
+    else if (m_tree == nullptr && m_count > 1)
+    {
+        CreateLocalTree();
+    }
+}
+
+void b2ChainShape::CreateLocalTree()
+{
+    m_tree.reset(new b2DynamicTree(m_resource));
+
+    // The leaves include the skin radius, like b2EdgeShape::ComputeAABB.
+    b2Vec<float, 2> r{{GetRadius(), GetRadius()}};
+    int32_t edgeCount = m_count - 1;
+    for (int32_t i = 0; i < edgeCount; ++i)
+    {
+        b2AABB aabb;
+        aabb.lowerBound = b2Min(m_vertices[i], m_vertices[i + 1]) - r;
+        aabb.upperBound = b2Max(m_vertices[i], m_vertices[i + 1]) + r;
+        m_tree->CreateProxy(aabb, reinterpret_cast<void*>(static_cast<intptr_t>(i)));
+
+        if (i == 0)
+        {
+            m_treeBounds = aabb;
+        }
+        else
+        {
+            m_treeBounds.Combine(aabb);
+        }
+    }
+}
+
+void b2ChainShape::ComputeTreeAABB(b2AABB* aabb, const b2Transform& xf) const
+{
+    b2Assert(m_tree != nullptr);
+    *aabb = b2Mul(xf, m_treeBounds);
+}
+
+void b2ChainShape::GetTreeAABB(b2AABB* aabb, int32_t childIndex) const
+{
+    b2Assert(0 <= childIndex && childIndex < m_count - 1);
+
+    // This matches the skin radius added by CreateLocalTree and the fattening done by
+    // b2DynamicTree::CreateProxy.
+    float extension = GetRadius() + AABB_EXTENSION;
+    b2Vec<float, 2> r = {{extension, extension}};
+    aabb->lowerBound = b2Min(m_vertices[childIndex], m_vertices[childIndex + 1]) - r;
+    aabb->upperBound = b2Max(m_vertices[childIndex], m_vertices[childIndex + 1]) + r;
+}
+
 b2Shape* b2ChainShape::Clone(b2BlockAllocator* allocator) const
 {
-    void* mem = allocator->Allocate(sizeof(b2ChainShape));
+    void* mem = allocator->Allocate(sizeof(b2ChainShape), b2MemoryCategory::SHAPES);
     auto clone = new (mem) b2ChainShape;
+    clone->m_resource = allocator->GetMemoryResource();
+    clone->m_useLocalTree = m_useLocalTree;
     clone->CreateChain(m_vertices, m_count);
     clone->m_prevVertex = m_prevVertex;
     clone->m_nextVertex = m_nextVertex;
@@ -20,6 +20,9 @@
 #define B2_CHAIN_SHAPE_H
 
 #include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Collision/b2DynamicTree.h>
+
+#include <memory>
 
 namespace box2d
 {
@@ -28,15 +31,18 @@ class b2EdgeShape;
 /// A chain shape is a free form sequence of line segments.
 /// The chain has two-sided collision, so you can use inside and outside collision.
 /// Therefore, you may use any winding order.
-/// Since there may be many vertices, they are allocated using b2Alloc.
+/// Since there may be many vertices, they are allocated from a memory resource. Chains
+/// created by the user use the default resource and chains cloned into a world use the
+/// resource of the world.
 /// Connectivity information is used to create smooth collisions.
+/// Long chains can keep a local dynamic tree over their edges, see SetLocalTree.
 /// WARNING: The chain will not collide properly if there are self-intersections.
 class b2ChainShape : public b2Shape
 {
 public:
     b2ChainShape();
 
-    /// The destructor frees the vertices using b2Free.
+    /// The destructor frees the vertices.
     ~b2ChainShape();
 
     /// Clear all data.
@@ -60,7 +66,24 @@ public:
     /// Don't call this for loops.
     void SetNextVertex(const b2Vec<float, 2>& nextVertex);
 
-    /// Implement b2Shape. Vertices are cloned using b2Alloc.
+    /// Keep a local dynamic tree over the edges of this chain. A fixture created from such
+    /// a chain registers a single broad-phase proxy instead of one proxy per edge, and the
+    /// contact manager, queries and ray casts find the edges through the local tree. This
+    /// is meant for long static terrain chains. Set this before creating the fixture.
+    void SetLocalTree(bool flag);
+
+    /// Get the local edge tree. This is nullptr unless SetLocalTree(true) was called.
+    /// The tree is in the local frame of the chain and the leaf user data is the edge index.
+    const b2DynamicTree* GetLocalTree() const;
+
+    /// Compute the AABB of all the edges, including the skin radius. This uses the bounds
+    /// of the local tree.
+    void ComputeTreeAABB(b2AABB* aabb, const b2Transform& transform) const;
+
+    /// Get the fattened local AABB of an edge as it is stored in the local tree.
+    void GetTreeAABB(b2AABB* aabb, int32_t childIndex) const;
+
+    /// Implement b2Shape. Vertices are cloned using the memory resource of the allocator.
     b2Shape* Clone(b2BlockAllocator* allocator) const override;
 
     /// @see b2Shape::GetChildCount
@@ -92,14 +115,29 @@ public:
 
     b2Vec<float, 2> m_prevVertex, m_nextVertex;
     bool m_hasPrevVertex, m_hasNextVertex;
+
+private:
+    void CreateLocalTree();
+
+    b2MemoryResource* m_resource;
+    std::unique_ptr<b2DynamicTree> m_tree;
+    b2AABB m_treeBounds;
+    bool m_useLocalTree;
 };
 
 inline b2ChainShape::b2ChainShape() : b2Shape(b2Shape::e_chain, POLYGON_RADIUS)
 {
+    m_resource = b2GetDefaultMemoryResource();
     m_vertices = nullptr;
     m_count = 0;
     m_hasPrevVertex = false;
     m_hasNextVertex = false;
+    m_useLocalTree = false;
+}
+
+inline const b2DynamicTree* b2ChainShape::GetLocalTree() const
+{
+    return m_tree.get();
 }
 }
 
@@ -23,7 +23,7 @@ using namespace box2d;
 
 b2Shape* b2CircleShape::Clone(b2BlockAllocator* allocator) const
 {
-    void* mem = allocator->Allocate(sizeof(b2CircleShape));
+    void* mem = allocator->Allocate(sizeof(b2CircleShape), b2MemoryCategory::SHAPES);
     auto clone = new (mem) b2CircleShape;
     *clone = *this;
     return clone;
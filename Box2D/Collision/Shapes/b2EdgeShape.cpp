@@ -31,7 +31,7 @@ void b2EdgeShape::Set(b2Vec<float, 2> v1, b2Vec<float, 2> v2)
 
 b2Shape* b2EdgeShape::Clone(b2BlockAllocator* allocator) const
 {
-    void* mem = allocator->Allocate(sizeof(b2EdgeShape));
+    void* mem = allocator->Allocate(sizeof(b2EdgeShape), b2MemoryCategory::SHAPES);
     auto clone = new (mem) b2EdgeShape;
     *clone = *this;
     return clone;
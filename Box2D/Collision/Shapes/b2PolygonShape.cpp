@@ -23,7 +23,7 @@ using namespace box2d;
 
 b2Shape* b2PolygonShape::Clone(b2BlockAllocator* allocator) const
 {
-    void* mem = allocator->Allocate(sizeof(b2PolygonShape));
+    void* mem = allocator->Allocate(sizeof(b2PolygonShape), b2MemoryCategory::SHAPES);
     auto clone = new (mem) b2PolygonShape;
     *clone = *this;
     return clone;
@@ -91,6 +91,8 @@ public:
     
 
 private:
+    friend class b2Replay;
+
     b2Vec<float, 2> m_centroid;
     std::vector<b2Vec<float, 2>> m_vertices;
     std::vector<b2Vec<float, 2>> m_normals;
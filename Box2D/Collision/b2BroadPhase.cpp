@@ -20,23 +20,26 @@
 
 using namespace box2d;
 
-b2BroadPhase::b2BroadPhase()
+b2BroadPhase::b2BroadPhase(b2MemoryResource* resource) : m_resource(resource), m_tree(resource)
 {
     m_proxyCount = 0;
 
     m_pairCapacity = 16;
     m_pairCount = 0;
-    m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+    m_pairBuffer = (b2Pair*)m_resource->Allocate(m_pairCapacity * sizeof(b2Pair));
 
     m_moveCapacity = 16;
     m_moveCount = 0;
-    m_moveBuffer = (int32_t*)b2Alloc(m_moveCapacity * sizeof(int32_t));
+    m_moveBuffer = (int32_t*)m_resource->Allocate(m_moveCapacity * sizeof(int32_t));
+
+    m_movedProxies = 0;
+    m_reportedPairs = 0;
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
-    b2Free(m_moveBuffer);
-    b2Free(m_pairBuffer);
+    m_resource->Free(m_moveBuffer, m_moveCapacity * sizeof(int32_t));
+    m_resource->Free(m_pairBuffer, m_pairCapacity * sizeof(b2Pair));
 }
 
 int32_t b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
@@ -54,6 +57,46 @@ void b2BroadPhase::DestroyProxy(int32_t proxyId)
     m_tree.DestroyProxy(proxyId);
 }
 
+void b2BroadPhase::Reset()
+{
+    m_tree.Reset();
+    m_proxyCount = 0;
+    m_moveCount = 0;
+    m_pairCount = 0;
+}
+
+void b2BroadPhase::Compact(std::vector<int32_t>* remap)
+{
+    m_tree.Compact(remap);
+
+    for (int32_t i = 0; i < m_moveCount; ++i)
+    {
+        if (m_moveBuffer[i] != e_nullProxy)
+        {
+            m_moveBuffer[i] = (*remap)[m_moveBuffer[i]];
+        }
+    }
+
+    // The pairs are consumed by UpdatePairs, none are live between steps.
+    m_pairCount = 0;
+}
+
+b2BroadPhaseStats b2BroadPhase::GetStats() const
+{
+    b2BroadPhaseStats stats;
+    stats.movedProxies = m_movedProxies;
+    stats.pairs = m_reportedPairs;
+    stats.tree = m_tree.GetStats();
+    return stats;
+}
+
+void b2BroadPhase::ResetStats()
+{
+    m_movedProxies = 0;
+    m_reportedPairs = 0;
+    m_tree.ResetStats();
+}
+
 void b2BroadPhase::MoveProxy(int32_t proxyId, const b2AABB& aabb, const b2Vec<float, 2>& displacement)
 {
     bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
@@ -74,9 +117,9 @@ void b2BroadPhase::BufferMove(int32_t proxyId)
     {
         int32_t* oldBuffer = m_moveBuffer;
         m_moveCapacity *= 2;
-        m_moveBuffer = (int32_t*)b2Alloc(m_moveCapacity * sizeof(int32_t));
+        m_moveBuffer = (int32_t*)m_resource->Allocate(m_moveCapacity * sizeof(int32_t));
         memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32_t));
-        b2Free(oldBuffer);
+        m_resource->Free(oldBuffer, m_moveCount * sizeof(int32_t));
     }
 
     m_moveBuffer[m_moveCount] = proxyId;
@@ -108,9 +151,9 @@ bool b2BroadPhase::QueryCallback(int32_t proxyId)
     {
         b2Pair* oldBuffer = m_pairBuffer;
         m_pairCapacity *= 2;
-        m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+        m_pairBuffer = (b2Pair*)m_resource->Allocate(m_pairCapacity * sizeof(b2Pair));
         memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
-        b2Free(oldBuffer);
+        m_resource->Free(oldBuffer, m_pairCount * sizeof(b2Pair));
     }
 
     m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
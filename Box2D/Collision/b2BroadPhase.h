@@ -46,7 +46,8 @@ public:
         e_nullProxy = -1
     };
 
-    b2BroadPhase();
+    /// The tree nodes and the pair and move buffers are taken from the memory resource.
+    b2BroadPhase(b2MemoryResource* resource = b2GetDefaultMemoryResource());
     ~b2BroadPhase();
 
     /// Create a proxy with an initial AABB. Pairs are not reported until
@@ -56,6 +57,13 @@ public:
     /// Destroy a proxy. It is up to the client to remove any pairs.
     void DestroyProxy(int32_t proxyId);
 
+    /// Destroy all proxies, keeping the tree nodes and the buffers for reuse.
+    void Reset();
+
+    /// Compact the embedded tree, see b2DynamicTree::Compact. This changes the proxy ids,
+    /// remap receives the new id of each old id. The buffered moves are remapped.
+    void Compact(std::vector<int32_t>* remap);
+
     /// Call MoveProxy as many times as you like, then when you are done
     /// call UpdatePairs to finalized the proxy pairs (for your time step).
     void MoveProxy(int32_t proxyId, const b2AABB& aabb, const b2Vec<float, 2>& displacement);
@@ -100,6 +108,12 @@ public:
     template <typename T>
     void RayCast(T* callback, const b2RayCastInput& input) const;
 
+    /// Get the counters since the last ResetStats.
+    b2BroadPhaseStats GetStats() const;
+
+    /// Zero the counters, including those of the tree.
+    void ResetStats();
+
     /// Get the height of the embedded tree.
     int32_t GetTreeHeight() const;
 
@@ -109,6 +123,12 @@ public:
     /// Get the quality metric of the embedded tree.
     float GetTreeQuality() const;
 
+    /// Get the bytes held by the node pool of the embedded tree.
+    int32_t GetTreeMemory() const;
+
+    /// Get the bytes held by the move and pair buffers.
+    int32_t GetBufferMemory() const;
+
     /// Shift the world origin. Useful for large worlds.
     /// The shift formula is: position -= newOrigin
     /// @param newOrigin the new origin with respect to the old origin
@@ -122,6 +142,8 @@ private:
 
     bool QueryCallback(int32_t proxyId);
 
+    b2MemoryResource* m_resource;
+
     b2DynamicTree m_tree;
 
     int32_t m_proxyCount;
@@ -135,6 +157,9 @@ private:
     int32_t m_pairCount;
 
     int32_t m_queryProxyId;
+
+    int32_t m_movedProxies;
+    int32_t m_reportedPairs;
 };
 
 /// This is used to sort pairs.
@@ -190,6 +215,16 @@ inline float b2BroadPhase::GetTreeQuality() const
     return m_tree.GetAreaRatio();
 }
 
+inline int32_t b2BroadPhase::GetTreeMemory() const
+{
+    return m_tree.GetNodeCapacity() * sizeof(b2TreeNode);
+}
+
+inline int32_t b2BroadPhase::GetBufferMemory() const
+{
+    return m_moveCapacity * sizeof(int32_t) + m_pairCapacity * sizeof(b2Pair);
+}
+
 template <typename T>
 void b2BroadPhase::UpdatePairs(T* callback)
 {
@@ -211,6 +246,7 @@ void b2BroadPhase::UpdatePairs(T* callback)
 
         // Query tree, create pairs and add them pair buffer.
         m_tree.Query(this, fatAABB);
+        ++m_movedProxies;
     }
 
     // Reset move buffer
@@ -228,6 +264,7 @@ void b2BroadPhase::UpdatePairs(T* callback)
         void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
 
         callback->AddPair(userDataA, userDataB);
+        ++m_reportedPairs;
         ++i;
 
         // Skip any duplicate pairs.
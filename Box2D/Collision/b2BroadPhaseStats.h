@@ -0,0 +1,43 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BROAD_PHASE_STATS_H
+#define B2_BROAD_PHASE_STATS_H
+
+#include <Box2D/Common/b2Settings.h>
+
+namespace box2d
+{
+/// Counters of the tree operations, see b2DynamicTree::GetStats.
+struct b2TreeStats
+{
+    int32_t inserts;
+    int32_t removes;
+    int32_t rotations;
+};
+
+/// Counters of the broad-phase, see b2BroadPhase::GetStats.
+struct b2BroadPhaseStats
+{
+    int32_t movedProxies;  ///< proxies queried by UpdatePairs
+    int32_t pairs;         ///< unique pairs reported by UpdatePairs
+    b2TreeStats tree;
+};
+}
+
+#endif
@@ -24,7 +24,7 @@ using namespace box2d;
 
 void box2d::b2CollideCircles(b2Manifold* manifold, const b2CircleShape* circleA,
                              const b2Transform& xfA, const b2CircleShape* circleB,
-                             const b2Transform& xfB)
+                             const b2Transform& xfB, float speculativeDistance)
 {
     manifold->pointCount = 0;
 
@@ -34,7 +34,7 @@ void box2d::b2CollideCircles(b2Manifold* manifold, const b2CircleShape* circleA,
     b2Vec<float, 2> d = pB - pA;
     float distSqr = b2Dot(d, d);
     float rA = circleA->GetRadius(), rB = circleB->GetRadius();
-    float radius = rA + rB;
+    float radius = rA + rB + speculativeDistance;
     if (distSqr > radius * radius)
     {
         return;
@@ -51,7 +51,7 @@ void box2d::b2CollideCircles(b2Manifold* manifold, const b2CircleShape* circleA,
 
 void box2d::b2CollidePolygonAndCircle(b2Manifold* manifold, const b2PolygonShape* polygonA,
                                       const b2Transform& xfA, const b2CircleShape* circleB,
-                                      const b2Transform& xfB)
+                                      const b2Transform& xfB, float speculativeDistance)
 {
     manifold->pointCount = 0;
 
@@ -62,7 +62,7 @@ void box2d::b2CollidePolygonAndCircle(b2Manifold* manifold, const b2PolygonShape
     // Find the min separating edge.
     std::size_t normalIndex = 0;
     float separation = -MAX_FLOAT;
-    float radius = polygonA->GetRadius() + circleB->GetRadius();
+    float radius = polygonA->GetRadius() + circleB->GetRadius() + speculativeDistance;
     auto vertices = polygonA->GetVertices();
     auto normals = polygonA->GetNormals();
 
@@ -29,7 +29,7 @@ using namespace box2d;
 // This accounts for edge connectivity.
 void box2d::b2CollideEdgeAndCircle(b2Manifold* manifold, const b2EdgeShape* edgeA,
                                    const b2Transform& xfA, const b2CircleShape* circleB,
-                                   const b2Transform& xfB)
+                                   const b2Transform& xfB, float speculativeDistance)
 {
     manifold->pointCount = 0;
 
@@ -43,7 +43,7 @@ void box2d::b2CollideEdgeAndCircle(b2Manifold* manifold, const b2EdgeShape* edge
     float u = b2Dot(e, B - Q);
     float v = b2Dot(e, Q - A);
 
-    float radius = edgeA->GetRadius() + circleB->GetRadius();
+    float radius = edgeA->GetRadius() + circleB->GetRadius() + speculativeDistance;
 
     b2ContactFeature cf;
     cf.indexB = 0;
@@ -202,7 +202,8 @@ namespace
     struct b2EPCollider
     {
         void Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-                    const b2PolygonShape* polygonB, const b2Transform& xfB);
+                    const b2PolygonShape* polygonB, const b2Transform& xfB,
+                    float speculativeDistance);
         b2EPAxis ComputeEdgeSeparation();
         b2EPAxis ComputePolygonSeparation();
 
@@ -238,7 +239,8 @@ namespace
 // 7. Return if _any_ axis indicates separation
 // 8. Clip
 void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-                           const b2PolygonShape* polygonB, const b2Transform& xfB)
+                           const b2PolygonShape* polygonB, const b2Transform& xfB,
+                           float speculativeDistance)
 {
     m_xf = b2MulT(xfA, xfB);
 
@@ -435,15 +437,16 @@ void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const
     }
 
     // Get polygonB in frameA
-    auto vBs = polygonB->GetVertices();
+    const auto& vBs = polygonB->GetVertices();
+    const auto& nBs = polygonB->GetNormals();
     m_polygonB.count = vBs.size();
     for (std::size_t i = 0; i < vBs.size(); ++i)
     {
         m_polygonB.vertices[i] = b2Mul(m_xf, vBs[i]);
-        m_polygonB.normals[i] = b2Mul(m_xf.q, vBs[i]);
+        m_polygonB.normals[i] = b2Mul(m_xf.q, nBs[i]);
     }
 
-    m_radius = 2.0f * POLYGON_RADIUS;
+    m_radius = 2.0f * POLYGON_RADIUS + speculativeDistance;
 
     manifold->pointCount = 0;
 
@@ -594,7 +597,7 @@ void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const
     else
     {
         manifold->localNormal = polygonB->GetNormals()[rf.i1];
-        manifold->localPoint = polygonB->GetNormals()[rf.i1];
+        manifold->localPoint = polygonB->GetVertices()[rf.i1];
     }
 
     int32_t pointCount = 0;
@@ -703,8 +706,8 @@ b2EPAxis b2EPCollider::ComputePolygonSeparation()
 
 void box2d::b2CollideEdgeAndPolygon(b2Manifold* manifold, const b2EdgeShape* edgeA,
                                     const b2Transform& xfA, const b2PolygonShape* polygonB,
-                                    const b2Transform& xfB)
+                                    const b2Transform& xfB, float speculativeDistance)
 {
     b2EPCollider collider;
-    collider.Collide(manifold, edgeA, xfA, polygonB, xfB);
+    collider.Collide(manifold, edgeA, xfA, polygonB, xfB, speculativeDistance);
 }
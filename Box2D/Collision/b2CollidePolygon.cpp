@@ -118,19 +118,20 @@ void box2d::b2FindIncidentEdge(std::array<b2ClipVertex, 2>& c, const b2PolygonSh
 // The normal points from 1 to 2
 void box2d::b2CollidePolygons(b2Manifold* manifold, const b2PolygonShape* polyA,
                               const b2Transform& xfA, const b2PolygonShape* polyB,
-                              const b2Transform& xfB)
+                              const b2Transform& xfB, float speculativeDistance)
 {
     manifold->pointCount = 0;
     float totalRadius = polyA->GetRadius() + polyB->GetRadius();
+    float cullRadius = totalRadius + speculativeDistance;
 
     int32_t edgeA = 0;
     float separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-    if (separationA > totalRadius)
+    if (separationA > cullRadius)
         return;
 
     int32_t edgeB = 0;
     float separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-    if (separationB > totalRadius)
+    if (separationB > cullRadius)
         return;
 
     const b2PolygonShape* poly1;  // reference polygon
@@ -220,7 +221,7 @@ void box2d::b2CollidePolygons(b2Manifold* manifold, const b2PolygonShape* polyA,
     {
         float separation = b2Dot(normal, elem.v) - frontOffset;
 
-        if (separation <= totalRadius)
+        if (separation <= cullRadius)
         {
             b2ManifoldPoint* cp = manifold->points + pointCount;
             cp->localPoint = b2MulT(xf2, elem.v);
@@ -235,7 +235,8 @@ int32_t box2d::b2ClipSegmentToLine(std::array<b2ClipVertex, 2>& vOut, const std:
 }
 
 bool box2d::b2TestOverlap(const b2Shape* shapeA, int32_t indexA, const b2Shape* shapeB,
-                          int32_t indexB, const b2Transform& xfA, const b2Transform& xfB)
+                          int32_t indexB, const b2Transform& xfA, const b2Transform& xfB,
+                          b2GJKStats* stats)
 {
     b2DistanceInput input;
     input.proxyA.Set(shapeA, indexA);
@@ -249,7 +250,7 @@ bool box2d::b2TestOverlap(const b2Shape* shapeA, int32_t indexA, const b2Shape*
 
     b2DistanceOutput output;
 
-    b2Distance(&output, &cache, &input);
+    b2Distance(&output, &cache, &input, stats);
 
     return output.distance < 10.0f * EPSILON;
 }
@@ -35,6 +35,7 @@ class b2Shape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
+struct b2GJKStats;
 
 const uint8_t b2_nullFeature = UCHAR_MAX;
 
@@ -234,26 +235,31 @@ struct b2AABB
 };
 
 /// Compute the collision manifold between two circles.
+/// Points are also generated for shapes closer than the speculative distance. This holds
+/// for all of the manifold functions below.
 void b2CollideCircles(b2Manifold* manifold, const b2CircleShape* circleA, const b2Transform& xfA,
-                      const b2CircleShape* circleB, const b2Transform& xfB);
+                      const b2CircleShape* circleB, const b2Transform& xfB,
+                      float speculativeDistance = 0.0f);
 
 /// Compute the collision manifold between a polygon and a circle.
 void b2CollidePolygonAndCircle(b2Manifold* manifold, const b2PolygonShape* polygonA,
                                const b2Transform& xfA, const b2CircleShape* circleB,
-                               const b2Transform& xfB);
+                               const b2Transform& xfB, float speculativeDistance = 0.0f);
 
 /// Compute the collision manifold between two polygons.
 void b2CollidePolygons(b2Manifold* manifold, const b2PolygonShape* polygonA, const b2Transform& xfA,
-                       const b2PolygonShape* polygonB, const b2Transform& xfB);
+                       const b2PolygonShape* polygonB, const b2Transform& xfB,
+                       float speculativeDistance = 0.0f);
 
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold, const b2EdgeShape* polygonA,
                             const b2Transform& xfA, const b2CircleShape* circleB,
-                            const b2Transform& xfB);
+                            const b2Transform& xfB, float speculativeDistance = 0.0f);
 
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndPolygon(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-                             const b2PolygonShape* circleB, const b2Transform& xfB);
+                             const b2PolygonShape* circleB, const b2Transform& xfB,
+                             float speculativeDistance = 0.0f);
 
 /// Clipping for contact manifolds.
 int32_t b2ClipSegmentToLine(std::array<b2ClipVertex, 2>& vOut, const std::array<b2ClipVertex, 2>& vIn, const b2Vec<float, 2>& normal,
@@ -261,7 +267,7 @@ int32_t b2ClipSegmentToLine(std::array<b2ClipVertex, 2>& vOut, const std::array<
 
 /// Determine if two generic shapes overlap.
 bool b2TestOverlap(const b2Shape* shapeA, int32_t indexA, const b2Shape* shapeB, int32_t indexB,
-                   const b2Transform& xfA, const b2Transform& xfB);
+                   const b2Transform& xfA, const b2Transform& xfB, b2GJKStats* stats = nullptr);
 
 // ---------------- Inline Functions ------------------------------------------
 
@@ -290,6 +296,37 @@ inline bool b2TestOverlap(const b2AABB& a, const b2AABB& b)
     return true;
 }
 
+/// Compute the AABB of a box after moving it from a local frame into the frame of the
+/// transform. The result bounds the rotated box.
+inline b2AABB b2Mul(const b2Transform& xf, const b2AABB& aabb)
+{
+    b2Vec<float, 2> center = b2Mul(xf, aabb.GetCenter());
+    b2Vec<float, 2> h = aabb.GetExtents();
+    float c = std::abs(xf.q.c);
+    float s = std::abs(xf.q.s);
+    b2Vec<float, 2> e = {{c * h[b2VecX] + s * h[b2VecY], s * h[b2VecX] + c * h[b2VecY]}};
+
+    b2AABB result;
+    result.lowerBound = center - e;
+    result.upperBound = center + e;
+    return result;
+}
+
+/// Compute the AABB of a box after moving it into the local frame of the transform.
+inline b2AABB b2MulT(const b2Transform& xf, const b2AABB& aabb)
+{
+    b2Vec<float, 2> center = b2MulT(xf, aabb.GetCenter());
+    b2Vec<float, 2> h = aabb.GetExtents();
+    float c = std::abs(xf.q.c);
+    float s = std::abs(xf.q.s);
+    b2Vec<float, 2> e = {{c * h[b2VecX] + s * h[b2VecY], s * h[b2VecX] + c * h[b2VecY]}};
+
+    b2AABB result;
+    result.lowerBound = center - e;
+    result.upperBound = center + e;
+    return result;
+}
+
 // ----------- Previously static ------------------
 float b2FindMaxSeparation(int32_t* edgeIndex, const b2PolygonShape* poly1,
                             const b2Transform& xf1, const b2PolygonShape* poly2,
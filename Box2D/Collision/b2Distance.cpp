@@ -24,10 +24,6 @@
 
 using namespace box2d;
 
-int32_t b2GJKState::b2_gjkCalls = 0;
-int32_t b2GJKState::b2_gjkIters = 0;
-int32_t b2GJKState::b2_gjkMaxIters = 0;
-
 void b2DistanceProxy::Set(const b2Shape* shape, int32_t index)
 {
     m_vertices.clear();
@@ -444,10 +440,8 @@ void b2Simplex::Solve3()
 }
 
 void box2d::b2Distance(b2DistanceOutput* output, b2SimplexCache* cache,
-                       const b2DistanceInput* input)
+                       const b2DistanceInput* input, b2GJKStats* stats)
 {
-    ++b2GJKState::b2_gjkCalls;
-
     const b2DistanceProxy* proxyA = &input->proxyA;
     const b2DistanceProxy* proxyB = &input->proxyB;
 
@@ -541,7 +535,6 @@ void box2d::b2Distance(b2DistanceOutput* output, b2SimplexCache* cache,
 
         // Iteration count is equated to the number of support point calls.
         ++iter;
-        ++b2GJKState::b2_gjkIters;
 
         // Check for duplicate support points. This is the main termination
         // criteria.
@@ -565,7 +558,16 @@ void box2d::b2Distance(b2DistanceOutput* output, b2SimplexCache* cache,
         ++simplex.m_count;
     }
 
-    b2GJKState::b2_gjkMaxIters = b2Max(b2GJKState::b2_gjkMaxIters, iter);
+#ifndef B2_NO_STATS
+    if (stats)
+    {
+        ++stats->calls;
+        stats->iters += iter;
+        stats->maxIters = b2Max(stats->maxIters, iter);
+    }
+#else
+    B2_NOT_USED(stats);
+#endif
 
     // Prepare output.
     simplex.GetWitnessPoints(&output->pointA, &output->pointB);
@@ -27,12 +27,22 @@ namespace box2d
 {
 class b2Shape;
 
-struct b2GJKState
+/// Statistics of the GJK algorithm, updated by b2Distance when given one. Keep one per
+/// thread and combine them with Add.
+struct b2GJKStats
 {
-    static int32_t b2_gjkCalls;
-    static int32_t b2_gjkIters;
-    static int32_t b2_gjkMaxIters;
+    int32_t calls;
+    int32_t iters;
+    int32_t maxIters;
+
+    void Add(const b2GJKStats& other)
+    {
+        calls += other.calls;
+        iters += other.iters;
+        maxIters = b2Max(maxIters, other.maxIters);
+    }
 };
+
 /// A distance proxy is used by the GJK algorithm.
 /// It encapsulates any shape.
 struct b2DistanceProxy
@@ -96,7 +106,8 @@ struct b2DistanceOutput
 /// b2CircleShape, b2PolygonShape, b2EdgeShape. The simplex cache is
 /// input/output.
 /// On the first call set b2SimplexCache.count to zero.
-void b2Distance(b2DistanceOutput* output, b2SimplexCache* cache, const b2DistanceInput* input);
+void b2Distance(b2DistanceOutput* output, b2SimplexCache* cache, const b2DistanceInput* input,
+                b2GJKStats* stats = nullptr);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -22,7 +22,7 @@
 
 using namespace box2d;
 
-b2DynamicTree::b2DynamicTree()
+b2DynamicTree::b2DynamicTree(b2MemoryResource* resource) : m_nodes(resource)
 {
     m_root = NULL_NODE;
 
@@ -47,6 +47,8 @@ b2DynamicTree::b2DynamicTree()
     m_path = 0;
 
     m_insertionCount = 0;
+
+    m_stats = b2TreeStats();
 }
 
 b2DynamicTree::~b2DynamicTree()
@@ -55,6 +57,26 @@ b2DynamicTree::~b2DynamicTree()
 //     b2Free(m_nodes);
 }
 
+void b2DynamicTree::Reset()
+{
+    m_root = NULL_NODE;
+    m_nodeCount = 0;
+
+    // Rebuild the free list in index order, like a new tree.
+    for (int32_t i = 0; i < m_nodeCapacity - 1; ++i)
+    {
+        m_nodes[i].next = i + 1;
+        m_nodes[i].height = -1;
+    }
+    m_nodes[m_nodeCapacity - 1].next = NULL_NODE;
+    m_nodes[m_nodeCapacity - 1].height = -1;
+    m_freeList = 0;
+
+    m_path = 0;
+
+    m_insertionCount = 0;
+}
+
 // Allocate a node from the pool. Grow the pool if necessary.
 int32_t b2DynamicTree::AllocateNode()
 {
@@ -183,6 +205,7 @@ bool b2DynamicTree::MoveProxy(int32_t proxyId, const b2AABB& aabb, const b2Vec<f
 void b2DynamicTree::InsertLeaf(int32_t leaf)
 {
     ++m_insertionCount;
+    ++m_stats.inserts;
     
     if (m_root == NULL_NODE)
     {
@@ -323,6 +346,8 @@ void b2DynamicTree::InsertLeaf(int32_t leaf)
 
 void b2DynamicTree::RemoveLeaf(int32_t leaf)
 {
+    ++m_stats.removes;
+
     if (leaf == m_root)
     {
         m_root = NULL_NODE;
@@ -405,6 +430,7 @@ int32_t b2DynamicTree::Balance(int32_t iA)
     // Rotate C up
     if (balance > 1)
     {
+        ++m_stats.rotations;
         int32_t iF = C->child1;
         int32_t iG = C->child2;
         b2TreeNode* F = &m_nodes[iF];
@@ -465,6 +491,7 @@ int32_t b2DynamicTree::Balance(int32_t iA)
     // Rotate B up
     if (balance < -1)
     {
+        ++m_stats.rotations;
         int32_t iD = B->child1;
         int32_t iE = B->child2;
         b2TreeNode* D = &m_nodes[iD];
@@ -775,6 +802,78 @@ void b2DynamicTree::RebuildBottomUp()
     Validate();
 }
 
+void b2DynamicTree::Compact(std::vector<int32_t>* remap)
+{
+    remap->assign(m_nodeCapacity, NULL_NODE);
+
+    int32_t capacity = b2Max(m_nodeCount, 16);
+    std::vector<b2TreeNode, b2ResourceAllocator<b2TreeNode>> nodes(m_nodes.get_allocator());
+    nodes.reserve(capacity);
+
+    // Pre-order, so each subtree occupies a contiguous range that starts at its root.
+    std::vector<int32_t> stack;
+    if (m_root != NULL_NODE)
+    {
+        stack.push_back(m_root);
+    }
+
+    while (stack.size() > 0)
+    {
+        int32_t nodeId = stack.back();
+        stack.pop_back();
+
+        (*remap)[nodeId] = (int32_t)nodes.size();
+        nodes.push_back(m_nodes[nodeId]);
+
+        const b2TreeNode* node = &m_nodes[nodeId];
+        if (node->IsLeaf() == false)
+        {
+            stack.push_back(node->child2);
+            stack.push_back(node->child1);
+        }
+    }
+
+    b2Assert((int32_t)nodes.size() == m_nodeCount);
+
+    for (b2TreeNode& node : nodes)
+    {
+        if (node.parent != NULL_NODE)
+        {
+            node.parent = (*remap)[node.parent];
+        }
+
+        if (node.IsLeaf() == false)
+        {
+            node.child1 = (*remap)[node.child1];
+            node.child2 = (*remap)[node.child2];
+        }
+    }
+
+    // The rest of the pool is the free list, in index order.
+    while ((int32_t)nodes.size() < capacity)
+    {
+        nodes.emplace_back();
+        nodes.back().next = (int32_t)nodes.size();
+        nodes.back().height = -1;
+    }
+
+    if (m_nodeCount < capacity)
+    {
+        nodes.back().next = NULL_NODE;
+        m_freeList = m_nodeCount;
+    }
+    else
+    {
+        m_freeList = NULL_NODE;
+    }
+
+    m_root = m_root == NULL_NODE ? NULL_NODE : 0;
+    m_nodes.swap(nodes);
+    m_nodeCapacity = capacity;
+
+    Validate();
+}
+
 void b2DynamicTree::ShiftOrigin(const b2Vec<float, 2>& newOrigin)
 {
     // Build array of leaves. Free the rest.
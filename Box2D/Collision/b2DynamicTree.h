@@ -20,6 +20,8 @@
 #define B2_DYNAMIC_TREE_H
 
 #include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/b2BroadPhaseStats.h>
+#include <Box2D/Common/b2MemoryResource.h>
 
 #include <vector>
 
@@ -69,8 +71,9 @@ struct b2TreeNode
 class b2DynamicTree
 {
 public:
-    /// Constructing the tree initializes the node pool.
-    b2DynamicTree();
+    /// Constructing the tree initializes the node pool. The nodes are taken from the
+    /// memory resource.
+    b2DynamicTree(b2MemoryResource* resource = b2GetDefaultMemoryResource());
 
     /// Destroy the tree, freeing the node pool.
     ~b2DynamicTree();
@@ -81,6 +84,9 @@ public:
     /// Destroy a proxy. This asserts if the id is invalid.
     void DestroyProxy(int32_t proxyId);
 
+    /// Destroy all proxies, keeping the node pool for reuse.
+    void Reset();
+
     /// Move a proxy with a swepted AABB. If the proxy has moved outside of its
     /// fattened AABB,
     /// then the proxy is removed from the tree and re-inserted. Otherwise
@@ -130,6 +136,20 @@ public:
     /// Get the ratio of the sum of the node areas to the root area.
     float GetAreaRatio() const;
 
+    /// Get the leaf insertions, removals and rotations since the last ResetStats.
+    const b2TreeStats& GetStats() const;
+
+    /// Zero the operation counters.
+    void ResetStats();
+
+    /// Get the number of nodes in the pool, including free nodes.
+    int32_t GetNodeCapacity() const;
+
+    /// Renumber the nodes in depth first order and shrink the node pool to fit, so a
+    /// subtree is contiguous in memory and the free list is gone. This changes the proxy
+    /// ids. Fills remap with the new id of each old node id, or NULL_NODE for free nodes.
+    void Compact(std::vector<int32_t>* remap);
+
     /// Build an optimal tree. Very expensive. For testing.
     void RebuildBottomUp();
 
@@ -155,7 +175,7 @@ private:
 
     int32_t m_root;
 
-    std::vector<b2TreeNode> m_nodes;
+    std::vector<b2TreeNode, b2ResourceAllocator<b2TreeNode>> m_nodes;
     int32_t m_nodeCount;
     int32_t m_nodeCapacity;
 
@@ -165,8 +185,25 @@ private:
     uint32_t m_path;
 
     int32_t m_insertionCount;
+
+    b2TreeStats m_stats;
 };
 
+inline const b2TreeStats& b2DynamicTree::GetStats() const
+{
+    return m_stats;
+}
+
+inline void b2DynamicTree::ResetStats()
+{
+    m_stats = b2TreeStats();
+}
+
+inline int32_t b2DynamicTree::GetNodeCapacity() const
+{
+    return m_nodeCapacity;
+}
+
 inline void* b2DynamicTree::GetUserData(int32_t proxyId) const
 {
     b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -182,7 +219,8 @@ inline const b2AABB& b2DynamicTree::GetFatAABB(int32_t proxyId) const
 template <typename T>
 inline void b2DynamicTree::Query(T* callback, const b2AABB& aabb) const
 {
-    std::vector<int32_t> stack(256);
+    std::vector<int32_t> stack;
+    stack.reserve(256);
     stack.push_back(m_root);
 
     while (stack.size() > 0)
@@ -241,7 +279,8 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
         segmentAABB.upperBound = b2Max(p1, t);
     }
 
-    std::vector<int32_t> stack(256);
+    std::vector<int32_t> stack;
+    stack.reserve(256);
     stack.push_back(m_root);
 
     while (stack.size() > 0)
@@ -26,15 +26,6 @@
 #include <stdio.h>
 
 using namespace box2d;
-    
-
-float b2TOIState::b2_toiTime = 0;
-float b2TOIState::b2_toiMaxTime = 0;
-int32_t b2TOIState::b2_toiCalls = 0;
-int32_t b2TOIState::b2_toiIters = 0;
-int32_t b2TOIState::b2_toiMaxIters = 0;
-int32_t b2TOIState::b2_toiRootIters = 0;
-int32_t b2TOIState::b2_toiMaxRootIters = 0;
 
 namespace
 {
@@ -261,11 +252,14 @@ namespace
 
 // CCD via the local separating axis method. This seeks progression
 // by computing the largest time at which separation is maintained.
-void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
+void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input, b2TOIStats* stats,
+                           b2GJKStats* gjkStats)
 {
+#ifndef B2_NO_STATS
     b2Timer timer;
-
-    ++b2TOIState::b2_toiCalls;
+    int32_t rootIters = 0;
+    int32_t maxRootIters = 0;
+#endif
 
     output->state = b2TOIOutput::e_unknown;
     output->t = input->tMax;
@@ -313,7 +307,7 @@ void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
         distanceInput.transformA = xfA;
         distanceInput.transformB = xfB;
         b2DistanceOutput distanceOutput;
-        b2Distance(&distanceOutput, &cache, &distanceInput);
+        b2Distance(&distanceOutput, &cache, &distanceInput, gjkStats);
 
         // If the shapes are overlapped, we give up on continuous collision.
         if (distanceOutput.distance <= 0.0f)
@@ -433,7 +427,6 @@ void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
                 }
 
                 ++rootIterCount;
-                ++b2TOIState::b2_toiRootIters;
 
                 float s = fcn.Evaluate(indexA, indexB, t);
 
@@ -462,7 +455,10 @@ void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
                 }
             }
 
-            b2TOIState::b2_toiMaxRootIters = b2Max(b2TOIState::b2_toiMaxRootIters, rootIterCount);
+#ifndef B2_NO_STATS
+            rootIters += rootIterCount;
+            maxRootIters = b2Max(maxRootIters, rootIterCount);
+#endif
 
             ++pushBackIter;
 
@@ -473,7 +469,6 @@ void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
         }
 
         ++iter;
-        ++b2TOIState::b2_toiIters;
 
         if (done)
         {
@@ -489,9 +484,211 @@ void box2d::b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
         }
     }
 
-    b2TOIState::b2_toiMaxIters = b2Max(b2TOIState::b2_toiMaxIters, iter);
+#ifndef B2_NO_STATS
+    if (stats)
+    {
+        ++stats->calls;
+        stats->iters += iter;
+        stats->maxIters = b2Max(stats->maxIters, iter);
+        stats->rootIters += rootIters;
+        stats->maxRootIters = b2Max(stats->maxRootIters, maxRootIters);
+
+        float time = timer.GetMilliseconds();
+        stats->maxTime = b2Max(stats->maxTime, time);
+        stats->time += time;
+    }
+#else
+    B2_NOT_USED(stats);
+#endif
+}
+
+// Earliest time at which the point p + t * d comes within radius of the vertex v, or
+// MAX_FLOAT if it never does. The point must start outside of the radius.
+static float b2RayCastVertex(const b2Vec<float, 2>& p, const b2Vec<float, 2>& d,
+                             const b2Vec<float, 2>& v, float radius)
+{
+    b2Vec<float, 2> s = p - v;
+    float a = b2Dot(d, d);
+    float b = b2Dot(s, d);
+    float c = b2Dot(s, s) - radius * radius;
+    float disc = b * b - a * c;
+    if (b >= 0.0f || disc < 0.0f)
+    {
+        return MAX_FLOAT;
+    }
+
+    return (-b - std::sqrt(disc)) / a;
+}
+
+// Earliest time at which the point p + t * d comes within radius of the segment v1-v2
+// in the segment's normal direction, or MAX_FLOAT if it never does. The ends of the
+// segment are covered by b2RayCastVertex, including a point that starts within radius of
+// the segment's line but beside one of its ends.
+static float b2RayCastSegment(const b2Vec<float, 2>& p, const b2Vec<float, 2>& d,
+                              const b2Vec<float, 2>& v1, const b2Vec<float, 2>& v2,
+                              float radius)
+{
+    b2Vec<float, 2> e = v2 - v1;
+    float length = e.Normalize();
+    if (length == 0.0f)
+    {
+        return MAX_FLOAT;
+    }
+
+    // Use the side of the segment that the point starts on.
+    b2Vec<float, 2> n{{e[b2VecY], -e[b2VecX]}};
+    float offset = b2Dot(n, p - v1);
+    if (offset < 0.0f)
+    {
+        n = -n;
+        offset = -offset;
+    }
+
+    float speed = b2Dot(n, d);
+    if (offset < radius || speed >= 0.0f)
+    {
+        return MAX_FLOAT;
+    }
+
+    float t = (radius - offset) / speed;
+    float u = b2Dot(e, p + t * d - v1);
+    if (u < 0.0f || length < u)
+    {
+        return MAX_FLOAT;
+    }
+
+    return t;
+}
+
+// Distance from p to the convex hull of the vertices, zero if p is inside.
+static float b2HullDistance(const b2Vec<float, 2>* vertices, int32_t count,
+                            const b2Vec<float, 2>& p)
+{
+    if (count == 1)
+    {
+        return b2Distance(p, vertices[0]);
+    }
+
+    bool inside = count > 2;
+    float distanceSqr = MAX_FLOAT;
+    int32_t edgeCount = count == 2 ? 1 : count;
+    for (int32_t i = 0; i < edgeCount; ++i)
+    {
+        const b2Vec<float, 2>& v1 = vertices[i];
+        const b2Vec<float, 2>& v2 = vertices[i + 1 < count ? i + 1 : 0];
+        b2Vec<float, 2> e = v2 - v1;
+
+        // Polygons wind counter clockwise.
+        if (b2Cross(e, p - v1) < 0.0f)
+        {
+            inside = false;
+        }
+
+        float u = b2Clamp(b2Dot(p - v1, e) / b2Dot(e, e), 0.0f, 1.0f);
+        b2Vec<float, 2> r = v1 + u * e - p;
+        distanceSqr = b2Min(distanceSqr, b2Dot(r, r));
+    }
+
+    return inside ? 0.0f : std::sqrt(distanceSqr);
+}
+
+void box2d::b2TimeOfImpactCircle(b2TOIOutput* output, const b2TOIInput* input,
+                                 b2TOIStats* stats, b2GJKStats* gjkStats)
+{
+    const b2DistanceProxy* proxyA = &input->proxyA;
+    const b2DistanceProxy* proxyB = &input->proxyB;
+    b2Assert(proxyB->GetVertexCount() == 1);
+
+    const b2Sweep& sweepA = input->sweepA;
+    const b2Sweep& sweepB = input->sweepB;
+
+    int32_t count = int32_t(proxyA->GetVertexCount());
+    b2Vec<float, 2> vA = proxyA->GetVertex(0);
+    b2Vec<float, 2> vB = proxyB->GetVertex(0);
+
+    // A rotating shape doesn't move along a line, unless it is a circle at the center of mass.
+    bool linearA = sweepA.a0 == sweepA.a || (count == 1 && vA == sweepA.localCenter);
+    bool linearB = sweepB.a0 == sweepB.a || vB == sweepB.localCenter;
+    if (linearA == false || linearB == false)
+    {
+#ifndef B2_NO_STATS
+        if (stats)
+        {
+            ++stats->analyticFallbacks;
+        }
+#endif
+        b2TimeOfImpact(output, input, stats, gjkStats);
+        return;
+    }
+
+#ifndef B2_NO_STATS
+    if (stats)
+    {
+        ++stats->analyticCalls;
+    }
+#else
+    B2_NOT_USED(stats);
+#endif
+
+    b2Transform xfA0, xfA1, xfB0, xfB1;
+    sweepA.GetTransform(&xfA0, 0.0f);
+    sweepA.GetTransform(&xfA1, 1.0f);
+    sweepB.GetTransform(&xfB0, 0.0f);
+    sweepB.GetTransform(&xfB1, 1.0f);
+
+    // Keep shape A at its start position and move the circle center relative to it.
+    b2Vec<float, 2> p = b2Mul(xfB0, vB);
+    b2Vec<float, 2> d = b2Mul(xfB1, vB) - p - (b2Mul(xfA1, vA) - b2Mul(xfA0, vA));
+
+    b2Vec<float, 2> vertices[MAX_POLYGON_VERTICES];
+    for (int32_t i = 0; i < count; ++i)
+    {
+        vertices[i] = b2Mul(xfA0, proxyA->GetVertex(i));
+    }
+
+    float tMax = input->tMax;
+    float totalRadius = proxyA->m_radius + proxyB->m_radius;
+    float target = b2Max(LINEAR_SLOP, totalRadius - 3.0f * LINEAR_SLOP);
+    float tolerance = 0.25f * LINEAR_SLOP;
+
+    // Same outcomes as the general algorithm, with the separation hitting the target
+    // exactly instead of within the tolerance.
+    float distance = b2HullDistance(vertices, count, p);
+    if (distance <= 0.0f)
+    {
+        output->state = b2TOIOutput::e_overlapped;
+        output->t = 0.0f;
+        return;
+    }
+
+    if (distance < target + tolerance)
+    {
+        output->state = b2TOIOutput::e_touching;
+        output->t = 0.0f;
+        return;
+    }
 
-    float time = timer.GetMilliseconds();
-    b2TOIState::b2_toiMaxTime = b2Max(b2TOIState::b2_toiMaxTime, time);
-    b2TOIState::b2_toiTime += time;
+    float t = MAX_FLOAT;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        t = b2Min(t, b2RayCastVertex(p, d, vertices[i], target));
+    }
+
+    int32_t edgeCount = count == 2 ? 1 : (count == 1 ? 0 : count);
+    for (int32_t i = 0; i < edgeCount; ++i)
+    {
+        const b2Vec<float, 2>& v2 = vertices[i + 1 < count ? i + 1 : 0];
+        t = b2Min(t, b2RayCastSegment(p, d, vertices[i], v2, target));
+    }
+
+    if (t <= tMax)
+    {
+        output->state = b2TOIOutput::e_touching;
+        output->t = t;
+    }
+    else
+    {
+        output->state = b2TOIOutput::e_separated;
+        output->t = tMax;
+    }
 }
@@ -25,11 +25,32 @@
 namespace box2d
 {
 
-struct b2TOIState
+/// Statistics of the time of impact algorithm, updated by b2TimeOfImpact when given
+/// one. Times are in milliseconds. Keep one per thread and combine them with Add.
+struct b2TOIStats
 {
-    static float b2_toiTime, b2_toiMaxTime;
-    static int32_t b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-    static int32_t b2_toiRootIters, b2_toiMaxRootIters;
+    float time;
+    float maxTime;
+    int32_t calls;  ///< calls to the general algorithm
+    int32_t iters;
+    int32_t maxIters;
+    int32_t rootIters;
+    int32_t maxRootIters;
+    int32_t analyticCalls;      ///< queries solved by b2TimeOfImpactCircle
+    int32_t analyticFallbacks;  ///< b2TimeOfImpactCircle queries passed to the general algorithm
+
+    void Add(const b2TOIStats& other)
+    {
+        time += other.time;
+        maxTime = b2Max(maxTime, other.maxTime);
+        calls += other.calls;
+        iters += other.iters;
+        maxIters = b2Max(maxIters, other.maxIters);
+        rootIters += other.rootIters;
+        maxRootIters = b2Max(maxRootIters, other.maxRootIters);
+        analyticCalls += other.analyticCalls;
+        analyticFallbacks += other.analyticFallbacks;
+    }
 };
 
 /// Input parameters for b2TimeOfImpact
@@ -67,7 +88,16 @@ struct b2TOIOutput
 /// again.
 /// Note: use b2Distance to compute the contact point and normal at the time of
 /// impact.
-void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input);
+/// The distance queries made on the way are counted in gjkStats.
+void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input, b2TOIStats* stats = nullptr,
+                    b2GJKStats* gjkStats = nullptr);
+
+/// Same as b2TimeOfImpact for a circle in proxyB against a circle, polygon or edge in
+/// proxyA. If neither shape rotates over the sweep, the time of impact is found in closed
+/// form as a ray cast against shape A grown by the target separation. Otherwise this
+/// falls back to b2TimeOfImpact.
+void b2TimeOfImpactCircle(b2TOIOutput* output, const b2TOIInput* input,
+                          b2TOIStats* stats = nullptr, b2GJKStats* gjkStats = nullptr);
 }
 
 #endif
@@ -17,9 +17,12 @@
 */
 
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Common/b2BlockCache.h>
 #include <limits.h>
 #include <string.h>
 #include <stddef.h>
+#include <algorithm>
+#include <vector>
 
 using namespace box2d;
 
@@ -34,6 +37,14 @@ struct box2d::b2Chunk
     b2Block* blocks;
 };
 
+// Header in front of the allocations larger than b2_maxBlockSize.
+struct box2d::b2LargeBlock
+{
+    b2LargeBlock* prev;
+    b2LargeBlock* next;
+    int32_t size;
+};
+
 int32_t b2BlockAllocator::s_blockSizes[b2_blockSizes] = {
     16,   // 0
     32,   // 1
@@ -53,16 +64,23 @@ int32_t b2BlockAllocator::s_blockSizes[b2_blockSizes] = {
 uint8_t b2BlockAllocator::s_blockSizeLookup[b2_maxBlockSize + 1];
 bool b2BlockAllocator::s_blockSizeLookupInitialized;
 
-b2BlockAllocator::b2BlockAllocator()
+b2BlockAllocator::b2BlockAllocator(b2MemoryResource* resource)
 {
     b2Assert(b2_blockSizes < UCHAR_MAX);
 
+    m_resource = resource;
+    m_listener = nullptr;
+    m_largeBlocks = nullptr;
+    m_caches = nullptr;
+    m_cacheCount = 0;
     m_chunkSpace = b2_chunkArrayIncrement;
     m_chunkCount = 0;
-    m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+    m_chunks = (b2Chunk*)m_resource->Allocate(m_chunkSpace * sizeof(b2Chunk));
 
     memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
     memset(m_freeLists, 0, sizeof(m_freeLists));
+    memset(m_categoryBytes, 0, sizeof(m_categoryBytes));
+    memset(m_blockCounts, 0, sizeof(m_blockCounts));
 
     if (s_blockSizeLookupInitialized == false)
     {
@@ -87,29 +105,51 @@ b2BlockAllocator::b2BlockAllocator()
 
 b2BlockAllocator::~b2BlockAllocator()
 {
+    b2Assert(m_caches == nullptr);
+
+    FreeLargeBlocks();
+
     for (int32_t i = 0; i < m_chunkCount; ++i)
     {
-        b2Free(m_chunks[i].blocks);
+        m_resource->Free(m_chunks[i].blocks, b2_chunkSize);
     }
 
-    b2Free(m_chunks);
+    m_resource->Free(m_chunks, m_chunkSpace * sizeof(b2Chunk));
 }
 
-void* b2BlockAllocator::Allocate(int32_t size)
+void* b2BlockAllocator::Allocate(int32_t size, b2MemoryCategory category)
 {
     if (size == 0)
         return nullptr;
 
     b2Assert(0 < size);
+    b2Assert(m_cacheCount.load(std::memory_order_relaxed) == 0);
 
+    void* p;
     if (size > b2_maxBlockSize)
     {
-        return b2Alloc(size);
+        p = AllocateLarge(size);
+    }
+    else
+    {
+        int32_t index = s_blockSizeLookup[size];
+        b2Assert(0 <= index && index < b2_blockSizes);
+        p = AllocateBlock(index);
+        ++m_blockCounts[index];
     }
 
-    int32_t index = s_blockSizeLookup[size];
-    b2Assert(0 <= index && index < b2_blockSizes);
+    m_categoryBytes[(int32_t)category] += size;
+
+    if (m_listener)
+    {
+        m_listener->Allocated(p, size, category, B2_RETURN_ADDRESS());
+    }
+
+    return p;
+}
 
+void* b2BlockAllocator::AllocateBlock(int32_t index)
+{
     if (m_freeLists[index])
     {
         b2Block* block = m_freeLists[index];
@@ -122,14 +162,14 @@ void* b2BlockAllocator::Allocate(int32_t size)
         {
             b2Chunk* oldChunks = m_chunks;
             m_chunkSpace += b2_chunkArrayIncrement;
-            m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+            m_chunks = (b2Chunk*)m_resource->Allocate(m_chunkSpace * sizeof(b2Chunk));
             memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
             memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
-            b2Free(oldChunks);
+            m_resource->Free(oldChunks, m_chunkCount * sizeof(b2Chunk));
         }
 
         b2Chunk* chunk = m_chunks + m_chunkCount;
-        chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+        chunk->blocks = (b2Block*)m_resource->Allocate(b2_chunkSize);
 #if defined(_DEBUG)
         memset(chunk->blocks, 0xcd, b2_chunkSize);
 #endif
@@ -153,7 +193,7 @@ void* b2BlockAllocator::Allocate(int32_t size)
     }
 }
 
-void b2BlockAllocator::Free(void* p, int32_t size)
+void b2BlockAllocator::Free(void* p, int32_t size, b2MemoryCategory category)
 {
     if (size == 0)
     {
@@ -161,16 +201,30 @@ void b2BlockAllocator::Free(void* p, int32_t size)
     }
 
     b2Assert(0 < size);
+    b2Assert(m_cacheCount.load(std::memory_order_relaxed) == 0);
+
+    if (m_listener)
+    {
+        m_listener->Freed(p, size, category);
+    }
+
+    m_categoryBytes[(int32_t)category] -= size;
+    b2Assert(m_categoryBytes[(int32_t)category] >= 0);
 
     if (size > b2_maxBlockSize)
     {
-        b2Free(p);
+        FreeLarge(p, size);
         return;
     }
 
     int32_t index = s_blockSizeLookup[size];
     b2Assert(0 <= index && index < b2_blockSizes);
+    --m_blockCounts[index];
+    FreeBlock(p, index);
+}
 
+void b2BlockAllocator::FreeBlock(void* p, int32_t index)
+{
 #ifdef _DEBUG
     // Verify the memory address and size is valid.
     int32_t blockSize = s_blockSizes[index];
@@ -203,15 +257,231 @@ void b2BlockAllocator::Free(void* p, int32_t size)
     m_freeLists[index] = block;
 }
 
+void* b2BlockAllocator::AllocateLarge(int32_t size)
+{
+    b2LargeBlock* block = (b2LargeBlock*)m_resource->Allocate(sizeof(b2LargeBlock) + size);
+    block->prev = nullptr;
+    block->next = m_largeBlocks;
+    block->size = size;
+    if (m_largeBlocks)
+    {
+        m_largeBlocks->prev = block;
+    }
+    m_largeBlocks = block;
+    return block + 1;
+}
+
+void b2BlockAllocator::FreeLarge(void* p, int32_t size)
+{
+    b2LargeBlock* block = (b2LargeBlock*)p - 1;
+    b2Assert(block->size == size);
+    B2_NOT_USED(size);
+    if (block->prev)
+    {
+        block->prev->next = block->next;
+    }
+    else
+    {
+        m_largeBlocks = block->next;
+    }
+
+    if (block->next)
+    {
+        block->next->prev = block->prev;
+    }
+
+    m_resource->Free(block, sizeof(b2LargeBlock) + block->size);
+}
+
+void b2BlockAllocator::FreeLargeBlocks()
+{
+    b2LargeBlock* block = m_largeBlocks;
+    while (block)
+    {
+        b2LargeBlock* next = block->next;
+        m_resource->Free(block, sizeof(b2LargeBlock) + block->size);
+        block = next;
+    }
+    m_largeBlocks = nullptr;
+}
+
 void b2BlockAllocator::Clear()
 {
+    if (m_listener)
+    {
+        m_listener->Cleared();
+    }
+
+    FreeLargeBlocks();
+
     for (int32_t i = 0; i < m_chunkCount; ++i)
     {
-        b2Free(m_chunks[i].blocks);
+        m_resource->Free(m_chunks[i].blocks, b2_chunkSize);
     }
 
     m_chunkCount = 0;
     memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
     memset(m_freeLists, 0, sizeof(m_freeLists));
+    memset(m_categoryBytes, 0, sizeof(m_categoryBytes));
+    memset(m_blockCounts, 0, sizeof(m_blockCounts));
+}
+
+void b2BlockAllocator::Reset()
+{
+    if (m_listener)
+    {
+        m_listener->Cleared();
+    }
+
+    FreeLargeBlocks();
+
+    // Thread every chunk back onto the free list of its size class.
+    memset(m_freeLists, 0, sizeof(m_freeLists));
+    for (int32_t i = 0; i < m_chunkCount; ++i)
+    {
+        b2Chunk* chunk = m_chunks + i;
+        int32_t index = s_blockSizeLookup[chunk->blockSize];
+        int32_t blockCount = b2_chunkSize / chunk->blockSize;
+        for (int32_t j = 0; j < blockCount - 1; ++j)
+        {
+            b2Block* block = (b2Block*)((int8_t*)chunk->blocks + chunk->blockSize * j);
+            block->next = (b2Block*)((int8_t*)chunk->blocks + chunk->blockSize * (j + 1));
+        }
+        b2Block* last = (b2Block*)((int8_t*)chunk->blocks + chunk->blockSize * (blockCount - 1));
+        last->next = m_freeLists[index];
+        m_freeLists[index] = chunk->blocks;
+    }
+
+    memset(m_categoryBytes, 0, sizeof(m_categoryBytes));
+    memset(m_blockCounts, 0, sizeof(m_blockCounts));
+}
+
+int32_t b2BlockAllocator::Compact()
+{
+    b2Assert(m_cacheCount.load(std::memory_order_relaxed) == 0);
+
+    // Sort the chunks by address so a block can be matched to its chunk.
+    std::sort(m_chunks, m_chunks + m_chunkCount, [](const b2Chunk& a, const b2Chunk& b)
+    {
+        return a.blocks < b.blocks;
+    });
+
+    std::vector<int32_t> freeCounts(m_chunkCount);
+    std::vector<b2Block*> blocks;
+    int32_t released = 0;
+    for (int32_t index = 0; index < b2_blockSizes; ++index)
+    {
+        blocks.clear();
+        for (b2Block* block = m_freeLists[index]; block; block = block->next)
+        {
+            blocks.push_back(block);
+        }
+
+        if (blocks.empty())
+        {
+            continue;
+        }
+
+        std::sort(blocks.begin(), blocks.end());
+
+        // Count the free blocks of each chunk. The chunks and blocks are both sorted.
+        int32_t chunkIndex = 0;
+        for (b2Block* block : blocks)
+        {
+            while ((int8_t*)m_chunks[chunkIndex].blocks + b2_chunkSize <= (int8_t*)block)
+            {
+                ++chunkIndex;
+            }
+            b2Assert(m_chunks[chunkIndex].blockSize == s_blockSizes[index]);
+            ++freeCounts[chunkIndex];
+        }
+
+        // Relink the blocks of the chunks that stay, in address order.
+        int32_t blockCount = b2_chunkSize / s_blockSizes[index];
+        b2Block** tail = &m_freeLists[index];
+        chunkIndex = 0;
+        for (b2Block* block : blocks)
+        {
+            while ((int8_t*)m_chunks[chunkIndex].blocks + b2_chunkSize <= (int8_t*)block)
+            {
+                ++chunkIndex;
+            }
+
+            if (freeCounts[chunkIndex] < blockCount)
+            {
+                *tail = block;
+                tail = &block->next;
+            }
+        }
+        *tail = nullptr;
+    }
+
+    // Release the empty chunks.
+    int32_t chunkCount = 0;
+    for (int32_t i = 0; i < m_chunkCount; ++i)
+    {
+        b2Chunk* chunk = m_chunks + i;
+        if (freeCounts[i] == b2_chunkSize / chunk->blockSize)
+        {
+            m_resource->Free(chunk->blocks, b2_chunkSize);
+            ++released;
+        }
+        else
+        {
+            m_chunks[chunkCount++] = *chunk;
+        }
+    }
+
+    memset(m_chunks + chunkCount, 0, (m_chunkCount - chunkCount) * sizeof(b2Chunk));
+    m_chunkCount = chunkCount;
+    return released;
+}
+
+b2BlockAllocator* b2BlockAllocator::GetBlockAllocator()
+{
+    return this;
+}
+
+b2MemoryResource* b2BlockAllocator::GetMemoryResource() const
+{
+    return m_resource;
+}
+
+int32_t b2BlockAllocator::GetAllocatedBytes(b2MemoryCategory category) const
+{
+    if (m_cacheCount.load(std::memory_order_relaxed) == 0)
+    {
+        return m_categoryBytes[(int32_t)category];
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int32_t bytes = m_categoryBytes[(int32_t)category];
+    for (const b2BlockCache* cache = m_caches; cache; cache = cache->m_next)
+    {
+        bytes += cache->m_categoryBytes[(int32_t)category].load(std::memory_order_relaxed);
+    }
+    return bytes;
+}
+
+int32_t b2BlockAllocator::GetBlockCount(int32_t sizeClass) const
+{
+    b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+    return m_blockCounts[sizeClass];
+}
+
+int32_t b2BlockAllocator::GetBlockSize(int32_t sizeClass)
+{
+    b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+    return s_blockSizes[sizeClass];
+}
+
+int32_t b2BlockAllocator::GetChunkCount() const
+{
+    return m_chunkCount;
+}
+
+void b2BlockAllocator::SetAllocationListener(b2AllocationListener* listener)
+{
+    m_listener = listener;
 }
@@ -19,7 +19,19 @@
 #ifndef B2_BLOCK_ALLOCATOR_H
 #define B2_BLOCK_ALLOCATOR_H
 
-#include <Box2D/Common/b2Settings.h>
+#include <Box2D/Common/b2MemoryResource.h>
+
+#include <atomic>
+#include <mutex>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define B2_RETURN_ADDRESS() _ReturnAddress()
+#elif defined(__GNUC__)
+#define B2_RETURN_ADDRESS() __builtin_return_address(0)
+#else
+#define B2_RETURN_ADDRESS() nullptr
+#endif
 
 namespace box2d
 {
@@ -30,31 +42,123 @@ const int32_t b2_chunkArrayIncrement = 128;
 
 struct b2Block;
 struct b2Chunk;
+struct b2LargeBlock;
+class b2BlockAllocator;
+class b2BlockCache;
+
+/// The interface for allocating small objects, such as contacts, either from a
+/// b2BlockAllocator or from one of its b2BlockCache.
+class b2SmallObjectAllocator
+{
+public:
+    virtual ~b2SmallObjectAllocator() {}
+
+    /// Allocate memory. The category is used for accounting.
+    virtual void* Allocate(int32_t size,
+                           b2MemoryCategory category = b2MemoryCategory::OTHER) = 0;
+
+    /// Free memory. The size and category must match the allocation.
+    virtual void Free(void* p, int32_t size,
+                      b2MemoryCategory category = b2MemoryCategory::OTHER) = 0;
+
+    /// Get the block allocator the memory comes from. Memory may be freed through any
+    /// b2SmallObjectAllocator that has the same block allocator.
+    virtual b2BlockAllocator* GetBlockAllocator() = 0;
+};
 
 /// This is a small object allocator used for allocating small
 /// objects that persist for more than one time step.
 /// See: http://www.codeproject.com/useritems/Small_Block_Allocator.asp
-class b2BlockAllocator
+class b2BlockAllocator final : public b2SmallObjectAllocator
 {
 public:
-    b2BlockAllocator();
-    ~b2BlockAllocator();
+    /// The chunks and large allocations are taken from the memory resource.
+    b2BlockAllocator(b2MemoryResource* resource = b2GetDefaultMemoryResource());
+    ~b2BlockAllocator() override;
+
+    b2BlockAllocator(const b2BlockAllocator&) = delete;
+    b2BlockAllocator& operator=(const b2BlockAllocator&) = delete;
 
-    /// Allocate memory. This will use b2Alloc if the size is larger than b2_maxBlockSize.
-    void* Allocate(int32_t size);
+    /// Allocate memory. This will use the memory resource directly if the size is larger
+    /// than b2_maxBlockSize. The category is used for accounting.
+    /// Not to be used while a b2BlockCache of this allocator exists.
+    void* Allocate(int32_t size, b2MemoryCategory category = b2MemoryCategory::OTHER) override;
 
-    /// Free memory. This will use b2Free if the size is larger than b2_maxBlockSize.
-    void Free(void* p, int32_t size);
+    /// Free memory. This will use the memory resource directly if the size is larger than
+    /// b2_maxBlockSize. The size and category must match the allocation.
+    /// Not to be used while a b2BlockCache of this allocator exists.
+    void Free(void* p, int32_t size, b2MemoryCategory category = b2MemoryCategory::OTHER) override;
 
+    /// Returns this allocator.
+    b2BlockAllocator* GetBlockAllocator() override;
+
+    /// Free all blocks and return the chunks to the memory resource.
     void Clear();
 
+    /// Free all blocks but keep the chunks for reuse. This is much faster than freeing
+    /// the blocks one by one. Allocations larger than b2_maxBlockSize are returned to the
+    /// memory resource.
+    void Reset();
+
+    /// Return the chunks whose blocks are all free to the memory resource and relink
+    /// the free lists in address order, so new blocks are handed out front to back.
+    /// Not to be used while a b2BlockCache holds blocks.
+    /// @return the number of chunks released.
+    int32_t Compact();
+
+    /// Get the memory resource backing this allocator.
+    b2MemoryResource* GetMemoryResource() const;
+
+    /// Get the bytes currently allocated in a category, as requested by the callers. This
+    /// includes the bytes allocated through the b2BlockCache of this allocator.
+    int32_t GetAllocatedBytes(b2MemoryCategory category) const;
+
+    /// Get the number of blocks in use of a size class, see GetBlockSize.
+    int32_t GetBlockCount(int32_t sizeClass) const;
+
+    /// Get the block size of a size class.
+    static int32_t GetBlockSize(int32_t sizeClass);
+
+    /// Get the number of chunks taken from the memory resource. Each is b2_chunkSize bytes.
+    int32_t GetChunkCount() const;
+
+    /// Set a listener that is told about every allocation and free. Pass nullptr to stop
+    /// tracing. The allocations through a b2BlockCache are reported from the thread that
+    /// owns the cache, so the listener must be thread safe if caches are used on several
+    /// threads.
+    void SetAllocationListener(b2AllocationListener* listener);
+
 private:
+    friend class b2BlockCache;
+
+    void* AllocateBlock(int32_t index);
+    void FreeBlock(void* p, int32_t index);
+    void* AllocateLarge(int32_t size);
+    void FreeLarge(void* p, int32_t size);
+    void FreeLargeBlocks();
+
+    b2MemoryResource* m_resource;
+    b2AllocationListener* m_listener;
+
+    int32_t m_categoryBytes[(int32_t)b2MemoryCategory::COUNT];
+    int32_t m_blockCounts[b2_blockSizes];
+
     b2Chunk* m_chunks;
     int32_t m_chunkCount;
     int32_t m_chunkSpace;
 
     b2Block* m_freeLists[b2_blockSizes];
 
+    // Allocations larger than b2_maxBlockSize, so Clear and Reset can free them.
+    b2LargeBlock* m_largeBlocks;
+
+    // Taken by the b2BlockCache batch transfers and to walk the caches.
+    mutable std::mutex m_mutex;
+
+    // The caches of this allocator, linked through b2BlockCache::m_next.
+    b2BlockCache* m_caches;
+    std::atomic<int32_t> m_cacheCount;
+
     static int32_t s_blockSizes[b2_blockSizes];
     static uint8_t s_blockSizeLookup[b2_maxBlockSize + 1];
     static bool s_blockSizeLookupInitialized;
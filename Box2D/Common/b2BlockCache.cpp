@@ -0,0 +1,206 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2BlockCache.h>
+
+using namespace box2d;
+
+struct box2d::b2Block
+{
+    b2Block* next;
+};
+
+b2BlockCache::b2BlockCache(b2BlockAllocator* allocator) :
+    m_allocator{allocator},
+    m_next{},
+    m_freeLists{},
+    m_counts{},
+    m_lockCount{}
+{
+    for (std::atomic<int32_t>& bytes : m_categoryBytes)
+    {
+        bytes.store(0, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+    m_next = m_allocator->m_caches;
+    m_allocator->m_caches = this;
+    m_allocator->m_cacheCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+b2BlockCache::~b2BlockCache()
+{
+    Flush();
+
+    std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+    b2BlockCache** link = &m_allocator->m_caches;
+    while (*link != this)
+    {
+        link = &(*link)->m_next;
+    }
+    *link = m_next;
+    m_allocator->m_cacheCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void* b2BlockCache::Allocate(int32_t size, b2MemoryCategory category)
+{
+    if (size == 0)
+    {
+        return nullptr;
+    }
+
+    b2Assert(0 < size);
+
+    void* p;
+    if (size > b2_maxBlockSize)
+    {
+        std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+        ++m_lockCount;
+        p = m_allocator->AllocateLarge(size);
+    }
+    else
+    {
+        int32_t index = b2BlockAllocator::s_blockSizeLookup[size];
+        b2Assert(0 <= index && index < b2_blockSizes);
+        if (m_freeLists[index] == nullptr)
+        {
+            Refill(index);
+        }
+
+        b2Block* block = m_freeLists[index];
+        m_freeLists[index] = block->next;
+        --m_counts[index];
+        p = block;
+    }
+
+    AddBytes(category, size);
+
+    if (m_allocator->m_listener)
+    {
+        m_allocator->m_listener->Allocated(p, size, category, B2_RETURN_ADDRESS());
+    }
+
+    return p;
+}
+
+void b2BlockCache::Free(void* p, int32_t size, b2MemoryCategory category)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    b2Assert(0 < size);
+
+    if (m_allocator->m_listener)
+    {
+        m_allocator->m_listener->Freed(p, size, category);
+    }
+
+    AddBytes(category, -size);
+
+    if (size > b2_maxBlockSize)
+    {
+        std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+        ++m_lockCount;
+        m_allocator->FreeLarge(p, size);
+        return;
+    }
+
+    int32_t index = b2BlockAllocator::s_blockSizeLookup[size];
+    b2Assert(0 <= index && index < b2_blockSizes);
+    b2Block* block = (b2Block*)p;
+    block->next = m_freeLists[index];
+    m_freeLists[index] = block;
+    ++m_counts[index];
+
+    if (m_counts[index] > 2 * b2_blockCacheBatch)
+    {
+        Return(index, b2_blockCacheBatch);
+    }
+}
+
+void b2BlockCache::Refill(int32_t index)
+{
+    std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+    ++m_lockCount;
+    for (int32_t i = 0; i < b2_blockCacheBatch; ++i)
+    {
+        b2Block* block = (b2Block*)m_allocator->AllocateBlock(index);
+        block->next = m_freeLists[index];
+        m_freeLists[index] = block;
+    }
+    m_allocator->m_blockCounts[index] += b2_blockCacheBatch;
+    m_counts[index] += b2_blockCacheBatch;
+}
+
+void b2BlockCache::Return(int32_t index, int32_t count)
+{
+    std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+    ++m_lockCount;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        b2Block* block = m_freeLists[index];
+        m_freeLists[index] = block->next;
+        m_allocator->FreeBlock(block, index);
+    }
+    m_allocator->m_blockCounts[index] -= count;
+    m_counts[index] -= count;
+}
+
+void b2BlockCache::AddBytes(b2MemoryCategory category, int32_t size)
+{
+    // Only this thread writes the counter, so a plain load and store is enough.
+    std::atomic<int32_t>& bytes = m_categoryBytes[(int32_t)category];
+    bytes.store(bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+}
+
+void b2BlockCache::Flush()
+{
+    for (int32_t i = 0; i < b2_blockSizes; ++i)
+    {
+        if (m_counts[i] > 0)
+        {
+            Return(i, m_counts[i]);
+        }
+    }
+
+    // Move the bytes under the lock, so GetAllocatedBytes never counts them twice.
+    std::lock_guard<std::mutex> lock(m_allocator->m_mutex);
+    for (int32_t i = 0; i < (int32_t)b2MemoryCategory::COUNT; ++i)
+    {
+        m_allocator->m_categoryBytes[i] += m_categoryBytes[i].load(std::memory_order_relaxed);
+        m_categoryBytes[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+b2BlockAllocator* b2BlockCache::GetBlockAllocator()
+{
+    return m_allocator;
+}
+
+int32_t b2BlockCache::GetCachedCount(int32_t sizeClass) const
+{
+    b2Assert(0 <= sizeClass && sizeClass < b2_blockSizes);
+    return m_counts[sizeClass];
+}
+
+int32_t b2BlockCache::GetLockCount() const
+{
+    return m_lockCount;
+}
@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BLOCK_CACHE_H
+#define B2_BLOCK_CACHE_H
+
+#include <Box2D/Common/b2BlockAllocator.h>
+
+namespace box2d
+{
+/// The number of blocks moved between a cache and its allocator at a time.
+const int32_t b2_blockCacheBatch = 32;
+
+/// A cache of free blocks in front of a shared b2BlockAllocator, for worker threads that
+/// create contacts or island scratch data concurrently. Each thread owns its own cache.
+/// Allocate and Free only touch the cache's free lists. The allocator's lock is taken
+/// when a free list runs empty, to refill it with b2_blockCacheBatch blocks, and when a
+/// free list holds more than two batches, to return one batch. Allocations larger than
+/// b2_maxBlockSize always take the lock.
+/// A cache may free blocks that came from another cache of the same allocator. While any
+/// cache exists, only the caches may allocate from the allocator, which asserts this.
+/// b2BlockAllocator::GetAllocatedBytes counts the bytes of every cache, and the
+/// allocation listener is called for every cached allocation and free.
+class b2BlockCache final : public b2SmallObjectAllocator
+{
+public:
+    explicit b2BlockCache(b2BlockAllocator* allocator);
+
+    /// Flushes the cache. Destroy the cache before the allocator is used directly again.
+    ~b2BlockCache() override;
+
+    b2BlockCache(const b2BlockCache&) = delete;
+    b2BlockCache& operator=(const b2BlockCache&) = delete;
+
+    /// Allocate memory, see b2BlockAllocator::Allocate.
+    void* Allocate(int32_t size, b2MemoryCategory category = b2MemoryCategory::OTHER) override;
+
+    /// Free memory, see b2BlockAllocator::Free.
+    void Free(void* p, int32_t size, b2MemoryCategory category = b2MemoryCategory::OTHER) override;
+
+    /// Get the allocator this cache is in front of.
+    b2BlockAllocator* GetBlockAllocator() override;
+
+    /// Return all cached blocks and the category bytes to the allocator.
+    void Flush();
+
+    /// Get the number of free blocks held in a size class.
+    int32_t GetCachedCount(int32_t sizeClass) const;
+
+    /// Get the number of times the allocator's lock was taken.
+    int32_t GetLockCount() const;
+
+private:
+    friend class b2BlockAllocator;
+
+    void Refill(int32_t index);
+    void Return(int32_t index, int32_t count);
+    void AddBytes(b2MemoryCategory category, int32_t size);
+
+    b2BlockAllocator* m_allocator;
+    b2BlockCache* m_next;
+    b2Block* m_freeLists[b2_blockSizes];
+    int32_t m_counts[b2_blockSizes];
+
+    // Written only by the owning thread, and read by b2BlockAllocator::GetAllocatedBytes.
+    std::atomic<int32_t> m_categoryBytes[(int32_t)b2MemoryCategory::COUNT];
+    int32_t m_lockCount;
+};
+}
+
+#endif
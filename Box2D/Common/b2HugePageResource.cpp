@@ -0,0 +1,196 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2HugePageResource.h>
+#include <Box2D/Common/b2Math.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+using namespace box2d;
+
+// Allocations are rounded to a cache line.
+static const int32_t b2_regionAlignment = 64;
+
+static int32_t b2RoundUp(int32_t size, int32_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+b2HugePageResource::b2HugePageResource(int32_t regionSize, bool prefault)
+{
+    m_regionSize = b2RoundUp(b2Max(regionSize, b2_hugePageSize), b2_hugePageSize);
+    m_prefault = prefault;
+    m_region = 0;
+    m_offset = 0;
+    m_mappedBytes = 0;
+    m_allocatedBytes = 0;
+}
+
+static void b2UnmapRegion(char* base, int32_t size, bool mapped)
+{
+#if defined(__linux__)
+    if (mapped)
+    {
+        munmap(base, size);
+        return;
+    }
+#endif
+    B2_NOT_USED(size);
+    B2_NOT_USED(mapped);
+    b2Free(base);
+}
+
+b2HugePageResource::~b2HugePageResource()
+{
+    for (const b2Region& region : m_regions)
+    {
+        b2UnmapRegion(region.base, region.size, region.mapped);
+    }
+    for (const b2Region& region : m_largeRegions)
+    {
+        b2UnmapRegion(region.base, region.size, region.mapped);
+    }
+}
+
+b2HugePageResource::b2Region b2HugePageResource::MapRegion(int32_t size)
+{
+    b2Region region;
+    region.base = nullptr;
+    region.size = size;
+    region.mapped = false;
+
+#if defined(__linux__)
+    // Over-map so the region can be aligned to a huge page, then trim.
+    size_t length = (size_t)size + b2_hugePageSize;
+    char* p = (char*)mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1, 0);
+    if (p != MAP_FAILED)
+    {
+        char* base =
+            (char*)(((uintptr_t)p + b2_hugePageSize - 1) & ~(uintptr_t)(b2_hugePageSize - 1));
+        if (base > p)
+        {
+            munmap(p, base - p);
+        }
+        munmap(base + size, (p + length) - (base + size));
+
+#if defined(MADV_HUGEPAGE)
+        madvise(base, size, MADV_HUGEPAGE);
+#endif
+        region.base = base;
+        region.mapped = true;
+    }
+#endif
+
+    if (region.base == nullptr)
+    {
+        region.base = (char*)b2Alloc(size);
+    }
+
+    if (m_prefault)
+    {
+        // Touch every page after the advice so the kernel can back it with huge pages.
+        for (int32_t i = 0; i < size; i += 4096)
+        {
+            region.base[i] = 0;
+        }
+    }
+
+    m_mappedBytes += size;
+    return region;
+}
+
+void* b2HugePageResource::Allocate(int32_t size)
+{
+    size = b2RoundUp(b2Max(size, 1), b2_regionAlignment);
+    m_allocatedBytes += size;
+
+    auto it = m_freeLists.find(size);
+    if (it != m_freeLists.end() && it->second)
+    {
+        void* p = it->second;
+        it->second = *(void**)p;
+        return p;
+    }
+
+    // A large allocation gets its own region, so the reserved regions are kept.
+    if (size > m_regionSize)
+    {
+        m_largeRegions.push_back(MapRegion(b2RoundUp(size, b2_hugePageSize)));
+        return m_largeRegions.back().base;
+    }
+
+    // Move on to the next region when this one is full. The tail, smaller than the
+    // allocation, is left unused.
+    if (m_region < (int32_t)m_regions.size() && m_offset + size > m_regions[m_region].size)
+    {
+        ++m_region;
+        m_offset = 0;
+    }
+
+    if (m_region == (int32_t)m_regions.size())
+    {
+        m_regions.push_back(MapRegion(m_regionSize));
+        m_offset = 0;
+    }
+
+    void* p = m_regions[m_region].base + m_offset;
+    m_offset += size;
+    return p;
+}
+
+void b2HugePageResource::Free(void* p, int32_t size)
+{
+    size = b2RoundUp(b2Max(size, 1), b2_regionAlignment);
+    m_allocatedBytes -= size;
+
+    void*& head = m_freeLists[size];
+    *(void**)p = head;
+    head = p;
+}
+
+void b2HugePageResource::Reserve(int32_t size)
+{
+    int32_t available = 0;
+    if (m_region < (int32_t)m_regions.size())
+    {
+        available = m_regions[m_region].size - m_offset;
+        for (int32_t i = m_region + 1; i < (int32_t)m_regions.size(); ++i)
+        {
+            available += m_regions[i].size;
+        }
+    }
+
+    while (available < size)
+    {
+        m_regions.push_back(MapRegion(m_regionSize));
+        available += m_regionSize;
+    }
+}
+
+int64_t b2HugePageResource::GetMappedBytes() const
+{
+    return m_mappedBytes;
+}
+
+int64_t b2HugePageResource::GetAllocatedBytes() const
+{
+    return m_allocatedBytes;
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HUGE_PAGE_RESOURCE_H
+#define B2_HUGE_PAGE_RESOURCE_H
+
+#include <Box2D/Common/b2MemoryResource.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace box2d
+{
+const int32_t b2_hugePageSize = 2 * 1024 * 1024;
+
+/// A memory resource that carves allocations out of large contiguous regions backed by
+/// huge pages where the system supports it (mmap and madvise(MADV_HUGEPAGE) on Linux,
+/// plain heap memory elsewhere). Pass it in b2WorldDef::memoryResource so the block
+/// allocator chunks and the tree node arrays of a very large world are packed together,
+/// which reduces TLB misses. With prefault the pages are touched when a region is mapped,
+/// so Reserve at world creation avoids page faults during the first steps.
+/// Allocations larger than a region get a region of their own. Freed memory is kept for
+/// allocations of the same size and is returned to the system when the resource is
+/// destroyed. If mapping fails the region comes from b2Alloc. This is not thread safe.
+class b2HugePageResource : public b2MemoryResource
+{
+public:
+    /// @param regionSize the bytes mapped at a time, rounded up to b2_hugePageSize.
+    /// @param prefault touch the pages of new regions.
+    b2HugePageResource(int32_t regionSize = 8 * b2_hugePageSize, bool prefault = false);
+    ~b2HugePageResource();
+
+    b2HugePageResource(const b2HugePageResource&) = delete;
+    b2HugePageResource& operator=(const b2HugePageResource&) = delete;
+
+    void* Allocate(int32_t size) override;
+    void Free(void* p, int32_t size) override;
+
+    /// Map regions ahead of time so that at least size more bytes can be allocated
+    /// without mapping.
+    void Reserve(int32_t size);
+
+    /// Get the number of bytes mapped. This is 64 bit, the regions add up past 2 GiB.
+    int64_t GetMappedBytes() const;
+
+    /// Get the number of bytes handed out and not freed.
+    int64_t GetAllocatedBytes() const;
+
+private:
+    struct b2Region
+    {
+        char* base;
+        int32_t size;
+        bool mapped;    // false if the region came from b2Alloc
+    };
+
+    b2Region MapRegion(int32_t size);
+
+    int32_t m_regionSize;
+    bool m_prefault;
+
+    // The regions allocations are carved from, in order, and the regions of the large
+    // allocations.
+    std::vector<b2Region> m_regions;
+    std::vector<b2Region> m_largeRegions;
+    int32_t m_region;
+    int32_t m_offset;
+
+    int64_t m_mappedBytes;
+    int64_t m_allocatedBytes;
+
+    // Freed blocks by rounded size, linked through their first word.
+    std::unordered_map<int32_t, void*> m_freeLists;
+};
+}
+
+#endif
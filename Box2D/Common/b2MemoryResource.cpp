@@ -0,0 +1,45 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2MemoryResource.h>
+
+using namespace box2d;
+
+namespace
+{
+class b2DefaultMemoryResource : public b2MemoryResource
+{
+public:
+    void* Allocate(int32_t size) override
+    {
+        return b2Alloc(size);
+    }
+
+    void Free(void* p, int32_t size) override
+    {
+        B2_NOT_USED(size);
+        b2Free(p);
+    }
+};
+}
+
+b2MemoryResource* box2d::b2GetDefaultMemoryResource()
+{
+    static b2DefaultMemoryResource s_resource;
+    return &s_resource;
+}
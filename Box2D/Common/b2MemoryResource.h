@@ -0,0 +1,131 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_MEMORY_RESOURCE_H
+#define B2_MEMORY_RESOURCE_H
+
+#include <Box2D/Common/b2Settings.h>
+
+#include <cstddef>
+
+namespace box2d
+{
+/// A source of memory, in the spirit of std::pmr::memory_resource. A world takes all of
+/// its memory from one resource: block allocator chunks, stack allocator blocks,
+/// broad-phase buffers, tree nodes, chain vertices and the time of impact queue. The
+/// vertices and normals of polygon shapes are the exception, they are std::vectors on the
+/// global heap. The resource must outlive the world. A resource shared by worlds stepped
+/// on different threads must be thread safe.
+class b2MemoryResource
+{
+public:
+    virtual ~b2MemoryResource() {}
+
+    /// Allocate memory suitably aligned for any type.
+    virtual void* Allocate(int32_t size) = 0;
+
+    /// Free memory returned by Allocate. The size is the one passed to Allocate.
+    virtual void Free(void* p, int32_t size) = 0;
+};
+
+/// Get the resource that forwards to b2Alloc and b2Free. This is the default resource.
+b2MemoryResource* b2GetDefaultMemoryResource();
+
+/// Categories for the memory accounting of the block allocator.
+enum class b2MemoryCategory
+{
+    OTHER,
+    BODIES,
+    FIXTURES,
+    SHAPES,
+    CONTACTS,
+    JOINTS,
+    COUNT
+};
+
+/// Implement this to trace the allocations of a block allocator, for example to find
+/// leaks or growth in long running programs. The call site is the return address of the
+/// function that allocated; resolve it with addr2line or a debugger.
+class b2AllocationListener
+{
+public:
+    virtual ~b2AllocationListener() {}
+
+    /// Called after a block was allocated.
+    virtual void Allocated(void* p, int32_t size, b2MemoryCategory category,
+                           const void* callSite) = 0;
+
+    /// Called before a block is freed.
+    virtual void Freed(void* p, int32_t size, b2MemoryCategory category) = 0;
+
+    /// Called when all blocks are freed at once, without a call to Freed for each block.
+    virtual void Cleared()
+    {
+    }
+};
+
+/// Adapts a memory resource to the standard allocator interface for use in containers.
+template <typename T>
+class b2ResourceAllocator
+{
+public:
+    using value_type = T;
+
+    b2ResourceAllocator(b2MemoryResource* resource = b2GetDefaultMemoryResource())
+        : m_resource(resource)
+    {
+    }
+
+    template <typename U>
+    b2ResourceAllocator(const b2ResourceAllocator<U>& other) : m_resource(other.GetResource())
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return (T*)m_resource->Allocate((int32_t)(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        m_resource->Free(p, (int32_t)(n * sizeof(T)));
+    }
+
+    b2MemoryResource* GetResource() const
+    {
+        return m_resource;
+    }
+
+private:
+    b2MemoryResource* m_resource;
+};
+
+template <typename T, typename U>
+inline bool operator==(const b2ResourceAllocator<T>& a, const b2ResourceAllocator<U>& b)
+{
+    return a.GetResource() == b.GetResource();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const b2ResourceAllocator<T>& a, const b2ResourceAllocator<U>& b)
+{
+    return a.GetResource() != b.GetResource();
+}
+}
+
+#endif
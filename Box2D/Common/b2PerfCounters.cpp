@@ -0,0 +1,142 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2PerfCounters.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+using namespace box2d;
+
+#if defined(__linux__)
+
+static int b2OpenCounter(uint64_t config, int group)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group == -1 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+b2PerfCounters::b2PerfCounters()
+{
+    const uint64_t configs[e_counterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+
+    // The first counter that opens leads the group, so they are all scheduled together.
+    m_group = -1;
+    m_openCount = 0;
+    for (int32_t i = 0; i < e_counterCount; ++i)
+    {
+        m_fds[i] = b2OpenCounter(configs[i], m_group);
+        m_slots[i] = -1;
+        if (m_fds[i] != -1)
+        {
+            if (m_group == -1)
+            {
+                m_group = m_fds[i];
+            }
+            m_slots[i] = m_openCount++;
+        }
+    }
+
+    if (m_group != -1)
+    {
+        ioctl(m_group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+b2PerfCounters::~b2PerfCounters()
+{
+    for (int32_t i = 0; i < e_counterCount; ++i)
+    {
+        if (m_fds[i] != -1)
+        {
+            close(m_fds[i]);
+        }
+    }
+}
+
+b2PerfSample b2PerfCounters::Read() const
+{
+    b2PerfSample sample = b2PerfSample();
+    if (m_group == -1)
+    {
+        return sample;
+    }
+
+    // The group read format: the counter count, then the values in opening order.
+    uint64_t buffer[1 + e_counterCount];
+    if (read(m_group, buffer, sizeof(buffer)) <= 0)
+    {
+        return sample;
+    }
+
+    uint64_t* values[e_counterCount] = {&sample.cycles, &sample.instructions,
+                                        &sample.cacheMisses, &sample.branchMisses};
+    for (int32_t i = 0; i < e_counterCount; ++i)
+    {
+        if (m_slots[i] != -1 && m_slots[i] < (int32_t)buffer[0])
+        {
+            *values[i] = buffer[1 + m_slots[i]];
+        }
+    }
+    return sample;
+}
+
+#else
+
+b2PerfCounters::b2PerfCounters()
+{
+    m_group = -1;
+    m_openCount = 0;
+    for (int32_t i = 0; i < e_counterCount; ++i)
+    {
+        m_fds[i] = -1;
+        m_slots[i] = -1;
+    }
+}
+
+b2PerfCounters::~b2PerfCounters()
+{
+}
+
+b2PerfSample b2PerfCounters::Read() const
+{
+    return b2PerfSample();
+}
+
+#endif
+
+bool b2PerfCounters::IsAvailable() const
+{
+    return m_openCount > 0;
+}
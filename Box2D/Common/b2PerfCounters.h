@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PERF_COUNTERS_H
+#define B2_PERF_COUNTERS_H
+
+#include <Box2D/Common/b2Settings.h>
+
+namespace box2d
+{
+/// Hardware event counts, see b2PerfCounters.
+struct b2PerfSample
+{
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cacheMisses;   ///< last level cache misses
+    uint64_t branchMisses;
+
+    void Add(const b2PerfSample& other)
+    {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        cacheMisses += other.cacheMisses;
+        branchMisses += other.branchMisses;
+    }
+};
+
+inline b2PerfSample operator-(const b2PerfSample& a, const b2PerfSample& b)
+{
+    return b2PerfSample{a.cycles - b.cycles, a.instructions - b.instructions,
+                        a.cacheMisses - b.cacheMisses, a.branchMisses - b.branchMisses};
+}
+
+/// Hardware performance counters of the calling thread (cycles, instructions, last level
+/// cache misses and branch misses in user space), read through perf_event_open on Linux.
+/// Attach them with b2World::SetPerfCounters to get the counts of each step phase in
+/// b2Profile::hardware. The counters may be unavailable, on other systems, in some
+/// virtual machines or with a restrictive kernel.perf_event_paranoid. Then the samples
+/// are zero. Only the thread that created the counters is counted, so step the world on
+/// that thread. Reading costs a system call, so only attach them while investigating.
+class b2PerfCounters
+{
+public:
+    b2PerfCounters();
+    ~b2PerfCounters();
+
+    b2PerfCounters(const b2PerfCounters&) = delete;
+    b2PerfCounters& operator=(const b2PerfCounters&) = delete;
+
+    /// Are any counters open?
+    bool IsAvailable() const;
+
+    /// Read the counts since creation. Counters that could not be opened read zero.
+    b2PerfSample Read() const;
+
+private:
+    enum
+    {
+        e_counterCount = 4
+    };
+
+    int m_group;
+    int m_fds[e_counterCount];
+    // Position of each counter in a group read, or -1 if it could not be opened.
+    int32_t m_slots[e_counterCount];
+    int32_t m_openCount;
+};
+
+/// Measures the hardware counts between construction or Reset and GetSample, like b2Timer
+/// does for time. Does nothing if the counters are null.
+class b2PerfTimer
+{
+public:
+    explicit b2PerfTimer(const b2PerfCounters* counters) : m_counters(counters), m_start()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        if (m_counters)
+        {
+            m_start = m_counters->Read();
+        }
+    }
+
+    b2PerfSample GetSample() const
+    {
+        if (m_counters)
+        {
+            return m_counters->Read() - m_start;
+        }
+        return b2PerfSample();
+    }
+
+private:
+    const b2PerfCounters* m_counters;
+    b2PerfSample m_start;
+};
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Profiler.h>
+#include <Box2D/Common/b2Math.h>
+
+#include <stdio.h>
+
+using namespace box2d;
+
+uint32_t box2d::b2GetThreadId()
+{
+    static std::atomic<uint32_t> s_threadCount(0);
+    thread_local uint32_t s_threadId = s_threadCount.fetch_add(1, std::memory_order_relaxed);
+    return s_threadId;
+}
+
+b2Profiler::b2Profiler(int32_t capacity) : m_head(0)
+{
+    b2Assert(capacity > 0);
+    uint32_t size = 1;
+    while (size < (uint32_t)capacity)
+    {
+        size *= 2;
+    }
+
+    m_events.resize(size);
+    m_mask = size - 1;
+    m_depth = 0;
+    m_origin = b2Timer::GetTimestamp();
+}
+
+int64_t b2Profiler::GetTime() const
+{
+    return b2Timer::GetNanoseconds(b2Timer::GetTimestamp() - m_origin);
+}
+
+void b2Profiler::Record(const char* name, uint64_t start, int32_t depth, int32_t value)
+{
+    uint64_t end = b2Timer::GetTimestamp();
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    b2ProfileEvent* event = &m_events[head & m_mask];
+    event->name = name;
+    event->start = b2Timer::GetNanoseconds(start - m_origin);
+    event->duration = b2Timer::GetNanoseconds(end - start);
+    event->depth = depth;
+    event->value = value;
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+int32_t b2Profiler::GetEventCount() const
+{
+    uint32_t head = m_head.load(std::memory_order_acquire);
+    return (int32_t)b2Min(head, m_mask + 1);
+}
+
+const b2ProfileEvent& b2Profiler::GetEvent(int32_t index) const
+{
+    b2Assert(0 <= index && index < GetEventCount());
+    uint32_t head = m_head.load(std::memory_order_acquire);
+    uint32_t first = head - (uint32_t)GetEventCount();
+    return m_events[(first + index) & m_mask];
+}
+
+void b2Profiler::Clear()
+{
+    m_head.store(0, std::memory_order_release);
+}
+
+bool b2Profiler::WriteChromeTrace(const char* path) const
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    // Complete events, timestamps in microseconds.
+    fprintf(file, "{\"traceEvents\":[\n");
+    int32_t count = GetEventCount();
+    for (int32_t i = 0; i < count; ++i)
+    {
+        const b2ProfileEvent& event = GetEvent(i);
+        fprintf(file, "{\"name\":\"%s\",\"cat\":\"box2d\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+                      "\"ts\":%.3f,\"dur\":%.3f",
+                event.name, 1.0e-3 * event.start, 1.0e-3 * event.duration);
+        if (event.value >= 0)
+        {
+            fprintf(file, ",\"args\":{\"value\":%d}", event.value);
+        }
+        fprintf(file, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "],\"displayTimeUnit\":\"ns\"}\n");
+
+    bool ok = ferror(file) == 0;
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
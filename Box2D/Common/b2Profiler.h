@@ -0,0 +1,216 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PROFILER_H
+#define B2_PROFILER_H
+
+#include <Box2D/Common/b2Timer.h>
+
+#include <atomic>
+#include <vector>
+
+namespace box2d
+{
+/// A timed zone recorded by b2Profiler. Times are in nanoseconds since the profiler was
+/// created.
+struct b2ProfileEvent
+{
+    const char* name;   ///< a string literal
+    int64_t start;
+    int64_t duration;
+    int32_t depth;      ///< nesting depth, 0 for the outermost zone
+    int32_t value;      ///< zone specific, e.g. the island body count, or -1
+};
+
+/// Records the zones of the world step into a ring buffer, the oldest events are
+/// overwritten. Attach one with b2World::SetProfiler. The zones are only compiled in
+/// when Box2D is built with B2_PROFILE_ZONES defined (the BOX2D_PROFILE_ZONES CMake
+/// option), otherwise B2_PROFILE_ZONE expands to nothing.
+/// One thread records and the ring buffer takes no lock. Read the events on that thread,
+/// or on another thread only when it is synchronized with the recording one, for example
+/// between steps under your own lock. Reading while a step records is a data race.
+class b2Profiler
+{
+public:
+    /// @param capacity the number of events kept, rounded up to a power of two.
+    explicit b2Profiler(int32_t capacity = 1 << 16);
+
+    b2Profiler(const b2Profiler&) = delete;
+    b2Profiler& operator=(const b2Profiler&) = delete;
+
+    /// Get the current time in nanoseconds since construction.
+    int64_t GetTime() const;
+
+    /// Record a zone that started at the b2Timer timestamp start. Used by b2ProfileZone.
+    void Record(const char* name, uint64_t start, int32_t depth, int32_t value);
+
+    /// Get the number of events kept.
+    int32_t GetEventCount() const;
+
+    /// Get an event, 0 is the oldest kept. Zones are recorded when they end, so a zone
+    /// follows the zones nested in it.
+    const b2ProfileEvent& GetEvent(int32_t index) const;
+
+    /// Drop all events.
+    void Clear();
+
+    /// Write the events as Chrome trace JSON, for chrome://tracing or Perfetto.
+    /// @return false if the file could not be written.
+    bool WriteChromeTrace(const char* path) const;
+
+private:
+    friend class b2ProfileZone;
+
+    std::vector<b2ProfileEvent> m_events;
+    uint32_t m_mask;
+    std::atomic<uint32_t> m_head;
+    int32_t m_depth;
+    uint64_t m_origin;
+};
+
+/// Records a zone from construction to destruction. Use B2_PROFILE_ZONE.
+class b2ProfileZone
+{
+public:
+    b2ProfileZone(b2Profiler* profiler, const char* name, int32_t value = -1)
+    {
+        m_profiler = profiler;
+        m_name = name;
+        m_value = value;
+        m_start = 0;
+        if (profiler)
+        {
+            m_start = b2Timer::GetTimestamp();
+            ++profiler->m_depth;
+        }
+    }
+
+    ~b2ProfileZone()
+    {
+        if (m_profiler)
+        {
+            --m_profiler->m_depth;
+            m_profiler->Record(m_name, m_start, m_profiler->m_depth, m_value);
+        }
+    }
+
+    b2ProfileZone(const b2ProfileZone&) = delete;
+    b2ProfileZone& operator=(const b2ProfileZone&) = delete;
+
+private:
+    b2Profiler* m_profiler;
+    const char* m_name;
+    uint64_t m_start;
+    int32_t m_value;
+};
+
+/// Implement this class to forward the phases of the step to an external profiler,
+/// such as Tracy, or to a sampler. Attach it with b2World::SetPhaseListener. Unlike
+/// b2Profiler it is always compiled in, and costs one branch per marker while no
+/// listener is attached.
+///
+/// The phases, with their names:
+/// - "Collide": update the contacts, including the contact listener calls
+/// - "BuildIsland": search the constraint graph for the bodies of an island
+/// - "SolveIsland": solve an island
+/// - "PostSolve": call the contact listener with the impulses of an island
+/// - "SynchronizeFixtures": move the broad-phase proxies of the solved bodies
+/// - "UpdatePairs": find the new contacts in the broad-phase
+/// - "SolveTOI": handle the time of impact events
+/// Phases nest, an end marker always matches the last begin marker.
+class b2PhaseListener
+{
+public:
+    virtual ~b2PhaseListener()
+    {
+    }
+
+    /// Called when a phase begins.
+    /// @param name a string literal, the same pointer for every call of a phase.
+    /// @param island the index of the island in the step, or -1 for the phases that are
+    /// not about one island, including the time of impact islands.
+    /// @param thread the b2GetThreadId of the calling thread.
+    virtual void BeginPhase(const char* name, int32_t island, uint32_t thread) = 0;
+
+    /// Called when a phase ends, with the arguments of its begin marker.
+    virtual void EndPhase(const char* name, int32_t island, uint32_t thread) = 0;
+};
+
+/// Get a small number identifying the calling thread, 0 for the first thread that asks.
+uint32_t b2GetThreadId();
+
+/// Mark the begin of a phase, if a listener is attached.
+inline void b2BeginPhase(b2PhaseListener* listener, const char* name, int32_t island = -1)
+{
+    if (listener)
+    {
+        listener->BeginPhase(name, island, b2GetThreadId());
+    }
+}
+
+/// Mark the end of a phase, if a listener is attached.
+inline void b2EndPhase(b2PhaseListener* listener, const char* name, int32_t island = -1)
+{
+    if (listener)
+    {
+        listener->EndPhase(name, island, b2GetThreadId());
+    }
+}
+
+/// Marks a phase from construction to destruction.
+class b2PhaseScope
+{
+public:
+    b2PhaseScope(b2PhaseListener* listener, const char* name, int32_t island = -1)
+    {
+        m_listener = listener;
+        m_name = name;
+        m_island = island;
+        b2BeginPhase(listener, name, island);
+    }
+
+    ~b2PhaseScope()
+    {
+        b2EndPhase(m_listener, m_name, m_island);
+    }
+
+    b2PhaseScope(const b2PhaseScope&) = delete;
+    b2PhaseScope& operator=(const b2PhaseScope&) = delete;
+
+private:
+    b2PhaseListener* m_listener;
+    const char* m_name;
+    int32_t m_island;
+};
+
+#define B2_PROFILE_CONCAT2(a, b) a##b
+#define B2_PROFILE_CONCAT(a, b) B2_PROFILE_CONCAT2(a, b)
+
+/// Time the rest of the enclosing scope as a zone of the profiler, which may be null.
+#if defined(B2_PROFILE_ZONES)
+#define B2_PROFILE_ZONE(profiler, name) \
+    ::box2d::b2ProfileZone B2_PROFILE_CONCAT(b2_zone, __LINE__)(profiler, name)
+#define B2_PROFILE_ZONE_VALUE(profiler, name, value) \
+    ::box2d::b2ProfileZone B2_PROFILE_CONCAT(b2_zone, __LINE__)(profiler, name, value)
+#else
+#define B2_PROFILE_ZONE(profiler, name)
+#define B2_PROFILE_ZONE_VALUE(profiler, name, value)
+#endif
+}
+
+#endif
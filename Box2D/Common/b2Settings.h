@@ -28,6 +28,7 @@
 namespace box2d
 {
 #define B2_NOT_USED(x) ((void)(x))
+
 inline void b2Assert(bool a)
 {
     assert(a);
@@ -77,6 +78,10 @@ constexpr float POLYGON_RADIUS = (2.0f * LINEAR_SLOP);
 /// Maximum number of sub-steps per contact in continuous physics simulation.
 constexpr int MAX_SUB_STEPS = 8;
 
+/// The base distance at which speculative contact points are generated. The relative
+/// motion of the bodies over a step is added to this.
+constexpr float SPECULATIVE_DISTANCE = (4.0f * LINEAR_SLOP);
+
 // Dynamics
 
 /// Maximum number of contacts to be handled to solve a TOI impact.
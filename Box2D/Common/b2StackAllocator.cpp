@@ -18,41 +18,109 @@
 
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Math.h>
+#include <cstring>
 
 using namespace box2d;
 
-b2StackAllocator::b2StackAllocator()
+b2StackAllocator::b2StackAllocator(b2MemoryResource* resource)
 {
-    m_index = 0;
+    m_resource = resource;
+    m_blocks = nullptr;
+    m_block = nullptr;
+    m_blockCount = 0;
+    m_capacity = 0;
     m_allocation = 0;
     m_maxAllocation = 0;
+    m_fallbackCount = 0;
     m_entryCount = 0;
+    m_entryCapacity = b2_maxStackEntries;
+    m_entries = (b2StackEntry*)m_resource->Allocate(m_entryCapacity * sizeof(b2StackEntry));
+
+    AddBlock(b2_stackSize);
 }
 
 b2StackAllocator::~b2StackAllocator()
 {
-    b2Assert(m_index == 0);
     b2Assert(m_entryCount == 0);
+    FreeBlocks();
+    m_resource->Free(m_entries, m_entryCapacity * sizeof(b2StackEntry));
+}
+
+void b2StackAllocator::AddBlock(int32_t capacity)
+{
+    // The block header and its data share one allocation.
+    b2StackBlock* block = (b2StackBlock*)m_resource->Allocate(sizeof(b2StackBlock) + capacity);
+    block->next = nullptr;
+    block->data = (char*)(block + 1);
+    block->capacity = capacity;
+    block->index = 0;
+
+    b2StackBlock** tail = &m_blocks;
+    while (*tail)
+    {
+        tail = &(*tail)->next;
+    }
+    *tail = block;
+
+    ++m_blockCount;
+    m_capacity += capacity;
+}
+
+void b2StackAllocator::FreeBlocks()
+{
+    b2StackBlock* block = m_blocks;
+    while (block)
+    {
+        b2StackBlock* next = block->next;
+        m_resource->Free(block, sizeof(b2StackBlock) + block->capacity);
+        block = next;
+    }
+
+    m_blocks = nullptr;
+    m_block = nullptr;
+    m_blockCount = 0;
+    m_capacity = 0;
 }
 
 void* b2StackAllocator::Allocate(int32_t size)
 {
-    b2Assert(m_entryCount < b2_maxStackEntries);
+    if (m_entryCount == m_entryCapacity)
+    {
+        b2StackEntry* oldEntries = m_entries;
+        m_entryCapacity *= 2;
+        m_entries = (b2StackEntry*)m_resource->Allocate(m_entryCapacity * sizeof(b2StackEntry));
+        memcpy(m_entries, oldEntries, m_entryCount * sizeof(b2StackEntry));
+        m_resource->Free(oldEntries, m_entryCount * sizeof(b2StackEntry));
+        ++m_fallbackCount;
+    }
 
-    b2StackEntry* entry = m_entries + m_entryCount;
-    entry->size = size;
-    if (m_index + size > b2_stackSize)
+    // Blocks after the top block are empty.
+    b2StackBlock* block = m_block ? m_block : m_blocks;
+    while (block && block->index + size > block->capacity)
     {
-        entry->data = (char*)b2Alloc(size);
-        entry->usedMalloc = true;
+        block = block->next;
     }
-    else
+
+    if (block == nullptr)
     {
-        entry->data = m_data + m_index;
-        entry->usedMalloc = false;
-        m_index += size;
+        // Grow geometrically so a burst of allocations settles quickly.
+        AddBlock(b2Max(size, m_capacity));
+        ++m_fallbackCount;
+
+        block = m_blocks;
+        while (block->next)
+        {
+            block = block->next;
+        }
     }
 
+    b2StackEntry* entry = m_entries + m_entryCount;
+    entry->data = block->data + block->index;
+    entry->size = size;
+    entry->block = block;
+    block->index += size;
+    m_block = block;
+
     m_allocation += size;
     m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
     ++m_entryCount;
@@ -65,21 +133,52 @@ void b2StackAllocator::Free(void* p)
     b2Assert(m_entryCount > 0);
     b2StackEntry* entry = m_entries + m_entryCount - 1;
     b2Assert(p == entry->data);
-    if (entry->usedMalloc)
+    entry->block->index -= entry->size;
+    m_allocation -= entry->size;
+    --m_entryCount;
+
+    m_block = m_entryCount > 0 ? m_entries[m_entryCount - 1].block : m_blocks;
+
+    if (m_entryCount == 0 && m_blockCount > 1)
     {
-        b2Free(p);
+        // Merge the chain so the next step fits in one block.
+        Reserve(m_blocks->capacity);
     }
-    else
+
+    p = nullptr;
+}
+
+void b2StackAllocator::Reserve(int32_t capacity)
+{
+    b2Assert(m_entryCount == 0);
+    capacity = b2Max(capacity, m_maxAllocation);
+    if (m_blockCount == 1 && m_blocks->capacity >= capacity)
     {
-        m_index -= entry->size;
+        return;
     }
-    m_allocation -= entry->size;
-    --m_entryCount;
 
-    p = nullptr;
+    // This allocates as well, count it with the growth.
+    FreeBlocks();
+    AddBlock(capacity);
+    ++m_fallbackCount;
 }
 
 int32_t b2StackAllocator::GetMaxAllocation() const
 {
     return m_maxAllocation;
 }
+
+int32_t b2StackAllocator::GetCapacity() const
+{
+    return m_capacity;
+}
+
+int32_t b2StackAllocator::GetBlockCount() const
+{
+    return m_blockCount;
+}
+
+int32_t b2StackAllocator::GetFallbackCount() const
+{
+    return m_fallbackCount;
+}
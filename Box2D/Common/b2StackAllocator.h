@@ -19,43 +19,82 @@
 #ifndef B2_STACK_ALLOCATOR_H
 #define B2_STACK_ALLOCATOR_H
 
-#include <Box2D/Common/b2Settings.h>
+#include <Box2D/Common/b2MemoryResource.h>
 
 namespace box2d
 {
 const int32_t b2_stackSize = 100 * 1024;  // 100k
-const int32_t b2_maxStackEntries = 32;
+const int32_t b2_maxStackEntries = 32;    // initial entry capacity
+
+struct b2StackBlock
+{
+    b2StackBlock* next;
+    char* data;
+    int32_t capacity;
+    int32_t index;
+};
 
 struct b2StackEntry
 {
     char* data;
     int32_t size;
-    bool usedMalloc;
+    b2StackBlock* block;
 };
 
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// The memory is a chain of blocks that is kept between steps. An allocation that
+// does not fit chains on a new block. When the stack is empty again the chain is
+// merged into a single block sized by the high water mark, so a steady workload
+// stops allocating after the first steps.
 class b2StackAllocator
 {
 public:
-    b2StackAllocator();
+    /// The blocks are taken from the memory resource.
+    b2StackAllocator(b2MemoryResource* resource = b2GetDefaultMemoryResource());
     ~b2StackAllocator();
 
+    b2StackAllocator(const b2StackAllocator&) = delete;
+    b2StackAllocator& operator=(const b2StackAllocator&) = delete;
+
     void* Allocate(int32_t size);
     void Free(void* p);
 
+    /// Make sure at least capacity bytes are available in one block.
+    /// The stack must be empty.
+    void Reserve(int32_t capacity);
+
     int32_t GetMaxAllocation() const;
 
+    /// Get the number of bytes held in blocks.
+    int32_t GetCapacity() const;
+
+    /// Get the number of blocks in the chain.
+    int32_t GetBlockCount() const;
+
+    /// Get the number of times the allocator had to allocate memory: to grow, to merge the
+    /// chain once the stack is empty, and in Reserve.
+    int32_t GetFallbackCount() const;
+
 private:
-    char m_data[b2_stackSize];
-    int32_t m_index;
+    void AddBlock(int32_t capacity);
+    void FreeBlocks();
+
+    b2MemoryResource* m_resource;
+
+    b2StackBlock* m_blocks;
+    b2StackBlock* m_block;
+    int32_t m_blockCount;
+    int32_t m_capacity;
 
     int32_t m_allocation;
     int32_t m_maxAllocation;
+    int32_t m_fallbackCount;
 
-    b2StackEntry m_entries[b2_maxStackEntries];
+    b2StackEntry* m_entries;
     int32_t m_entryCount;
+    int32_t m_entryCapacity;
 };
 }
 
@@ -18,86 +18,107 @@
 
 #include <Box2D/Common/b2Timer.h>
 
-using namespace box2d;
-
 #if defined(_WIN32)
-
-double b2Timer::s_invFrequency = 0.0f;
-
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#elif defined(B2_TIMER_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#include <time.h>
+#define B2_TIMER_USE_TSC
+#elif defined(__linux__)
+#include <time.h>
+#else
+#include <chrono>
+#endif
 
-b2Timer::b2Timer()
-{
-    LARGE_INTEGER largeInteger;
+using namespace box2d;
 
-    if (s_invFrequency == 0.0f)
-    {
-        QueryPerformanceFrequency(&largeInteger);
-        s_invFrequency = double(largeInteger.QuadPart);
-        if (s_invFrequency > 0.0f)
-        {
-            s_invFrequency = 1000.0f / s_invFrequency;
-        }
-    }
+#if defined(B2_TIMER_USE_TSC)
 
-    QueryPerformanceCounter(&largeInteger);
-    m_start = double(largeInteger.QuadPart);
+static uint64_t b2MonotonicNanoseconds()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec);
 }
 
-void b2Timer::Reset()
+// Count the time stamp counter ticks over about a millisecond of the monotonic clock.
+static double b2CalibrateTSC()
 {
-    LARGE_INTEGER largeInteger;
-    QueryPerformanceCounter(&largeInteger);
-    m_start = double(largeInteger.QuadPart);
+    uint64_t ns0 = b2MonotonicNanoseconds();
+    uint64_t tsc0 = __rdtsc();
+    uint64_t ns1 = ns0;
+    while (ns1 - ns0 < 1000000)
+    {
+        ns1 = b2MonotonicNanoseconds();
+    }
+    uint64_t tsc1 = __rdtsc();
+    return double(ns1 - ns0) * 1.0e-9 / double(tsc1 - tsc0);
 }
 
-float b2Timer::GetMilliseconds() const
+#endif
+
+uint64_t b2Timer::GetTimestamp()
 {
+#if defined(_WIN32)
     LARGE_INTEGER largeInteger;
     QueryPerformanceCounter(&largeInteger);
-    double count = double(largeInteger.QuadPart);
-    float ms = float(s_invFrequency * (count - m_start));
-    return ms;
+    return uint64_t(largeInteger.QuadPart);
+#elif defined(B2_TIMER_USE_TSC)
+    return __rdtsc();
+#elif defined(__linux__)
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return uint64_t(t.tv_sec) * 1000000000ull + uint64_t(t.tv_nsec);
+#else
+    using namespace std::chrono;
+    return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+#endif
 }
 
-#elif defined(__linux__) || defined(__APPLE__)
-
-#include <sys/time.h>
-
-b2Timer::b2Timer()
+double b2Timer::GetSecondsPerTick()
 {
-    Reset();
+#if defined(_WIN32)
+    static const double secondsPerTick = []()
+    {
+        LARGE_INTEGER largeInteger;
+        QueryPerformanceFrequency(&largeInteger);
+        return 1.0 / double(largeInteger.QuadPart);
+    }();
+    return secondsPerTick;
+#elif defined(B2_TIMER_USE_TSC)
+    static const double secondsPerTick = b2CalibrateTSC();
+    return secondsPerTick;
+#else
+    return 1.0e-9;
+#endif
 }
 
-void b2Timer::Reset()
+int64_t b2Timer::GetNanoseconds(uint64_t ticks)
 {
-    timeval t;
-    gettimeofday(&t, nullptr);
-    m_start_sec = t.tv_sec;
-    m_start_usec = t.tv_usec;
+#if defined(_WIN32) || defined(B2_TIMER_USE_TSC)
+    return int64_t(1.0e9 * GetSecondsPerTick() * double(ticks));
+#else
+    return int64_t(ticks);
+#endif
 }
 
-float b2Timer::GetMilliseconds() const
+b2Timer::b2Timer()
 {
-    timeval t;
-    gettimeofday(&t, nullptr);
-    return 1000.0f * (t.tv_sec - m_start_sec) + 0.001f * (t.tv_usec - m_start_usec);
+    Reset();
 }
 
-#else
-
-b2Timer::b2Timer()
+void b2Timer::Reset()
 {
+    m_start = GetTimestamp();
 }
 
-void b2Timer::Reset()
+uint64_t b2Timer::GetTicks() const
 {
+    return GetTimestamp() - m_start;
 }
 
 float b2Timer::GetMilliseconds() const
 {
-    return 0.0f;
+    return float(1000.0 * GetSecondsPerTick() * double(GetTicks()));
 }
-
-#endif
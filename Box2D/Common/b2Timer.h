@@ -23,8 +23,14 @@
 
 namespace box2d
 {
-/// Timer for profiling. This has platform specific code and may
-/// not work on every platform.
+/// Timer for profiling. The time is kept in raw ticks of a monotonic clock:
+/// - QueryPerformanceCounter on Windows.
+/// - The time stamp counter (rdtsc) on x86 when built with B2_TIMER_TSC (the
+///   BOX2D_TIMER_TSC CMake option). It is calibrated against the monotonic clock the
+///   first time it is used, which takes about a millisecond. The counter must be
+///   invariant, as on all recent x86 processors.
+/// - clock_gettime(CLOCK_MONOTONIC_RAW) on Linux, which is not slewed by NTP.
+/// - std::chrono::steady_clock elsewhere.
 class b2Timer
 {
 public:
@@ -37,14 +43,20 @@ public:
     /// Get the time since construction or the last reset.
     float GetMilliseconds() const;
 
+    /// Get the raw ticks since construction or the last reset.
+    uint64_t GetTicks() const;
+
+    /// Get the current raw tick count. Only differences are meaningful.
+    static uint64_t GetTimestamp();
+
+    /// Get the length of a tick in seconds.
+    static double GetSecondsPerTick();
+
+    /// Convert ticks to nanoseconds.
+    static int64_t GetNanoseconds(uint64_t ticks);
+
 private:
-#if defined(_WIN32)
-    double m_start;
-    static double s_invFrequency;
-#elif defined(__linux__) || defined(__APPLE__)
-    unsigned long m_start_sec;
-    unsigned long m_start_usec;
-#endif
+    uint64_t m_start;
 };
 }
 
@@ -27,16 +27,16 @@
 using namespace box2d;
 
 b2Contact* b2ChainAndCircleContact::Create(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
-                                           int32_t indexB, b2BlockAllocator* allocator)
+                                           int32_t indexB, b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2ChainAndCircleContact));
+    void* mem = allocator->Allocate(sizeof(b2ChainAndCircleContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2ChainAndCircleContact(fixtureA, indexA, fixtureB, indexB);
 }
 
-void b2ChainAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2ChainAndCircleContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2ChainAndCircleContact*)contact)->~b2ChainAndCircleContact();
-    allocator->Free(contact, sizeof(b2ChainAndCircleContact));
+    allocator->Free(contact, sizeof(b2ChainAndCircleContact), b2MemoryCategory::CONTACTS);
 }
 
 b2ChainAndCircleContact::b2ChainAndCircleContact(b2Fixture* fixtureA, int32_t indexA,
@@ -50,8 +50,9 @@ b2ChainAndCircleContact::b2ChainAndCircleContact(b2Fixture* fixtureA, int32_t in
 void b2ChainAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA,
                                        const b2Transform& xfB)
 {
-    b2ChainShape* chain = (b2ChainShape*)m_fixtureA->GetShape();
+    const b2ChainShape* chain = (const b2ChainShape*)GetShapeA();
     b2EdgeShape edge;
     chain->GetChildEdge(&edge, m_indexA);
-    b2CollideEdgeAndCircle(manifold, &edge, xfA, (b2CircleShape*)m_fixtureB->GetShape(), xfB);
+    b2CollideEdgeAndCircle(manifold, &edge, xfA, (const b2CircleShape*)GetShapeB(), xfB,
+                           m_speculativeDistance);
 }
@@ -28,16 +28,16 @@ using namespace box2d;
 
 b2Contact* b2ChainAndPolygonContact::Create(b2Fixture* fixtureA, int32_t indexA,
                                             b2Fixture* fixtureB, int32_t indexB,
-                                            b2BlockAllocator* allocator)
+                                            b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2ChainAndPolygonContact));
+    void* mem = allocator->Allocate(sizeof(b2ChainAndPolygonContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2ChainAndPolygonContact(fixtureA, indexA, fixtureB, indexB);
 }
 
-void b2ChainAndPolygonContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2ChainAndPolygonContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2ChainAndPolygonContact*)contact)->~b2ChainAndPolygonContact();
-    allocator->Free(contact, sizeof(b2ChainAndPolygonContact));
+    allocator->Free(contact, sizeof(b2ChainAndPolygonContact), b2MemoryCategory::CONTACTS);
 }
 
 b2ChainAndPolygonContact::b2ChainAndPolygonContact(b2Fixture* fixtureA, int32_t indexA,
@@ -51,8 +51,9 @@ b2ChainAndPolygonContact::b2ChainAndPolygonContact(b2Fixture* fixtureA, int32_t
 void b2ChainAndPolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA,
                                         const b2Transform& xfB)
 {
-    b2ChainShape* chain = (b2ChainShape*)m_fixtureA->GetShape();
+    const b2ChainShape* chain = (const b2ChainShape*)GetShapeA();
     b2EdgeShape edge;
     chain->GetChildEdge(&edge, m_indexA);
-    b2CollideEdgeAndPolygon(manifold, &edge, xfA, (b2PolygonShape*)m_fixtureB->GetShape(), xfB);
+    b2CollideEdgeAndPolygon(manifold, &edge, xfA, (const b2PolygonShape*)GetShapeB(), xfB,
+                            m_speculativeDistance);
 }
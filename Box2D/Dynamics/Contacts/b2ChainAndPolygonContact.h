@@ -23,14 +23,14 @@
 
 namespace box2d
 {
-class b2BlockAllocator;
+class b2SmallObjectAllocator;
 
 class b2ChainAndPolygonContact : public b2Contact
 {
 public:
     static b2Contact* Create(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
-                             int32_t indexB, b2BlockAllocator* allocator);
-    static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+                             int32_t indexB, b2SmallObjectAllocator* allocator);
+    static void Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator);
 
     b2ChainAndPolygonContact(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
                              int32_t indexB);
@@ -28,16 +28,16 @@
 using namespace box2d;
 
 b2Contact* b2CircleContact::Create(b2Fixture* fixtureA, int32_t, b2Fixture* fixtureB, int32_t,
-                                   b2BlockAllocator* allocator)
+                                   b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2CircleContact));
+    void* mem = allocator->Allocate(sizeof(b2CircleContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2CircleContact(fixtureA, fixtureB);
 }
 
-void b2CircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2CircleContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2CircleContact*)contact)->~b2CircleContact();
-    allocator->Free(contact, sizeof(b2CircleContact));
+    allocator->Free(contact, sizeof(b2CircleContact), b2MemoryCategory::CONTACTS);
 }
 
 b2CircleContact::b2CircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
@@ -49,6 +49,6 @@ b2CircleContact::b2CircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
 
 void b2CircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
-    b2CollideCircles(manifold, (b2CircleShape*)m_fixtureA->GetShape(), xfA,
-                     (b2CircleShape*)m_fixtureB->GetShape(), xfB);
+    b2CollideCircles(manifold, (const b2CircleShape*)GetShapeA(), xfA,
+                     (const b2CircleShape*)GetShapeB(), xfB, m_speculativeDistance);
 }
@@ -76,7 +76,7 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 }
 
 b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
-                             int32_t indexB, b2BlockAllocator* allocator)
+                             int32_t indexB, b2SmallObjectAllocator* allocator)
 {
     if (s_initialized == false)
     {
@@ -108,14 +108,14 @@ b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fix
     }
 }
 
-void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2Contact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     b2Assert(s_initialized == true);
 
     b2Fixture* fixtureA = contact->m_fixtureA;
     b2Fixture* fixtureB = contact->m_fixtureB;
 
-    if (contact->m_manifold.pointCount > 0 && fixtureA->IsSensor() == false &&
+    if (contact->GetManifold()->pointCount > 0 && fixtureA->IsSensor() == false &&
         fixtureB->IsSensor() == false)
     {
         fixtureA->GetBody()->SetAwake(true);
@@ -142,7 +142,9 @@ b2Contact::b2Contact(b2Fixture* fA, int32_t indexA, b2Fixture* fB, int32_t index
     m_indexA = indexA;
     m_indexB = indexB;
 
-    m_manifold.pointCount = 0;
+    // The contact manager gives the contact its state when it inserts it.
+    m_states = nullptr;
+    m_index = -1;
 
     m_prev = nullptr;
     m_next = nullptr;
@@ -158,18 +160,15 @@ b2Contact::b2Contact(b2Fixture* fA, int32_t indexA, b2Fixture* fB, int32_t index
     m_nodeB.other = nullptr;
 
     m_toiCount = 0;
-
-    m_friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
-    m_restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
-
-    m_tangentSpeed = 0.0f;
+    m_speculativeDistance = 0.0f;
 }
 
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+void b2Contact::Update(b2ContactListener* listener, b2GJKStats* gjkStats)
 {
-    b2Manifold oldManifold = m_manifold;
+    b2Manifold& manifold = GetState().manifold;
+    b2Manifold oldManifold = manifold;
 
     // Re-enable this contact.
     m_flags |= e_enabledFlag;
@@ -189,23 +188,23 @@ void b2Contact::Update(b2ContactListener* listener)
     // Is this contact a sensor?
     if (sensor)
     {
-        const b2Shape* shapeA = m_fixtureA->GetShape();
-        const b2Shape* shapeB = m_fixtureB->GetShape();
-        touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+        const b2Shape* shapeA = GetShapeA();
+        const b2Shape* shapeB = GetShapeB();
+        touching = b2TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB, gjkStats);
 
         // Sensors don't generate manifolds.
-        m_manifold.pointCount = 0;
+        manifold.pointCount = 0;
     }
     else
     {
-        Evaluate(&m_manifold, xfA, xfB);
-        touching = m_manifold.pointCount > 0;
+        Evaluate(&manifold, xfA, xfB);
+        touching = manifold.pointCount > 0;
 
         // Match old contact ids to new contact ids and copy the
         // stored impulses to warm start the solver.
-        for (int32_t i = 0; i < m_manifold.pointCount; ++i)
+        for (int32_t i = 0; i < manifold.pointCount; ++i)
         {
-            b2ManifoldPoint* mp2 = m_manifold.points + i;
+            b2ManifoldPoint* mp2 = manifold.points + i;
             mp2->normalImpulse = 0.0f;
             mp2->tangentImpulse = 0.0f;
             b2ContactID id2 = mp2->id;
@@ -23,6 +23,8 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Common/b2MemoryResource.h>
+#include <vector>
 
 namespace box2d
 {
@@ -30,9 +32,10 @@ class b2Body;
 class b2Contact;
 class b2Fixture;
 class b2World;
-class b2BlockAllocator;
+class b2SmallObjectAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2GJKStats;
 
 /// Friction mixing law. The idea is to allow either fixture to drive the restitution to zero.
 /// For example, anything slides on ice.
@@ -49,8 +52,22 @@ inline float b2MixRestitution(float restitution1, float restitution2)
 }
 
 typedef b2Contact* b2ContactCreateFcn(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
-                                      int32_t indexB, b2BlockAllocator* allocator);
-typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
+                                      int32_t indexB, b2SmallObjectAllocator* allocator);
+typedef void b2ContactDestroyFcn(b2Contact* contact, b2SmallObjectAllocator* allocator);
+
+/// The part of a contact that the narrow-phase and the contact solver read and write: the
+/// manifold with its accumulated impulses and the mixed material properties. The contact
+/// manager keeps the states of all contacts in one dense array, next to the array of contact
+/// handles that Collide walks.
+struct b2ContactState
+{
+    b2Manifold manifold;
+    float friction;
+    float restitution;
+    float tangentSpeed;
+};
+
+using b2ContactStateArray = std::vector<b2ContactState, b2ResourceAllocator<b2ContactState>>;
 
 struct b2ContactRegister
 {
@@ -170,7 +187,10 @@ protected:
         e_bulletHitFlag = 0x0010,
 
         // This contact has a valid TOI in m_toi
-        e_toiFlag = 0x0020
+        e_toiFlag = 0x0020,
+
+        // This contact is solved speculatively instead of with continuous collision
+        e_speculativeFlag = 0x0040
     };
 
     /// Flag this contact for filtering. Filtering will occur the next time step.
@@ -180,10 +200,10 @@ protected:
                         b2Shape::Type typeA, b2Shape::Type typeB);
     static void InitializeRegisters();
     static b2Contact* Create(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
-                             int32_t indexB, b2BlockAllocator* allocator);
+                             int32_t indexB, b2SmallObjectAllocator* allocator);
     static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB,
-                        b2BlockAllocator* allocator);
-    static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+                        b2SmallObjectAllocator* allocator);
+    static void Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator);
 
     b2Contact() : m_fixtureA(nullptr), m_fixtureB(nullptr)
     {
@@ -193,56 +213,93 @@ protected:
     {
     }
 
-    void Update(b2ContactListener* listener);
+    void Update(b2ContactListener* listener, b2GJKStats* gjkStats = nullptr);
+
+    /// The shapes of the fixtures, read only so that shared shapes can be used.
+    const b2Shape* GetShapeA() const;
+    const b2Shape* GetShapeB() const;
+
+    /// The state of this contact in the contact manager arrays. The reference is only valid
+    /// until the next contact is created or destroyed.
+    b2ContactState& GetState();
+    const b2ContactState& GetState() const;
 
     static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
     static bool s_initialized;
 
-    uint32_t m_flags;
+    // The manifold and the material properties used by the narrow-phase and the solver are
+    // kept in the contact manager, at m_index of its dense arrays. What Collide and the TOI
+    // scan read for every contact comes first. The graph linkage, only used when contacts
+    // are created, destroyed or gathered into islands, comes last.
 
-    // World pool and list pointers.
-    b2Contact* m_prev;
-    b2Contact* m_next;
+    b2ContactStateArray* m_states;
+    int32_t m_index;
 
-    // Nodes for connecting bodies.
-    b2ContactEdge m_nodeA;
-    b2ContactEdge m_nodeB;
+    uint32_t m_flags;
+    int32_t m_indexA;
 
     b2Fixture* m_fixtureA;
     b2Fixture* m_fixtureB;
 
-    int32_t m_indexA;
-    int32_t m_indexB;
+    // World list pointer. Newer contacts come first.
+    b2Contact* m_next;
 
-    b2Manifold m_manifold;
+    int32_t m_indexB;
 
     int32_t m_toiCount;
     float m_toi;
 
-    float m_friction;
-    float m_restitution;
+    // Distance at which speculative points are generated, zero for regular contacts.
+    float m_speculativeDistance;
 
-    float m_tangentSpeed;
+    // Creation order. Newer contacts come first in the world contact list.
+    uint64_t m_serial;
+
+    b2Contact* m_prev;
+
+    // Nodes for connecting bodies.
+    b2ContactEdge m_nodeA;
+    b2ContactEdge m_nodeB;
 };
 
+inline const b2Shape* b2Contact::GetShapeA() const
+{
+    return m_fixtureA->m_shape;
+}
+
+inline const b2Shape* b2Contact::GetShapeB() const
+{
+    return m_fixtureB->m_shape;
+}
+
+inline b2ContactState& b2Contact::GetState()
+{
+    return (*m_states)[m_index];
+}
+
+inline const b2ContactState& b2Contact::GetState() const
+{
+    return (*m_states)[m_index];
+}
+
 inline b2Manifold* b2Contact::GetManifold()
 {
-    return &m_manifold;
+    return &GetState().manifold;
 }
 
 inline const b2Manifold* b2Contact::GetManifold() const
 {
-    return &m_manifold;
+    return &GetState().manifold;
 }
 
 inline void b2Contact::GetWorldManifold(b2WorldManifold* worldManifold) const
 {
     const b2Body* bodyA = m_fixtureA->GetBody();
     const b2Body* bodyB = m_fixtureB->GetBody();
-    const b2Shape* shapeA = m_fixtureA->GetShape();
-    const b2Shape* shapeB = m_fixtureB->GetShape();
+    const b2Shape* shapeA = GetShapeA();
+    const b2Shape* shapeB = GetShapeB();
 
-    worldManifold->Initialize(&m_manifold, bodyA->GetTransform(), shapeA->GetRadius(),
+    worldManifold->Initialize(GetManifold(), bodyA->GetTransform(), shapeA->GetRadius(),
                               bodyB->GetTransform(), shapeB->GetRadius());
 }
 
@@ -315,42 +372,42 @@ inline void b2Contact::FlagForFiltering()
 
 inline void b2Contact::SetFriction(float friction)
 {
-    m_friction = friction;
+    GetState().friction = friction;
 }
 
 inline float b2Contact::GetFriction() const
 {
-    return m_friction;
+    return GetState().friction;
 }
 
 inline void b2Contact::ResetFriction()
 {
-    m_friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
+    GetState().friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
 }
 
 inline void b2Contact::SetRestitution(float restitution)
 {
-    m_restitution = restitution;
+    GetState().restitution = restitution;
 }
 
 inline float b2Contact::GetRestitution() const
 {
-    return m_restitution;
+    return GetState().restitution;
 }
 
 inline void b2Contact::ResetRestitution()
 {
-    m_restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
+    GetState().restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
 }
 
 inline void b2Contact::SetTangentSpeed(float speed)
 {
-    m_tangentSpeed = speed;
+    GetState().tangentSpeed = speed;
 }
 
 inline float b2Contact::GetTangentSpeed() const
 {
-    return m_tangentSpeed;
+    return GetState().tangentSpeed;
 }
 }
 
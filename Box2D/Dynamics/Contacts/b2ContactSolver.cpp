@@ -42,6 +42,7 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
     m_positions = def->positions;
     m_velocities = def->velocities;
     m_contacts = def->contacts;
+    m_minSeparation = 0.0f;
 
     // Initialize position independent portions of the constraints.
     for (int32_t i = 0; i < m_count; ++i)
@@ -50,27 +51,30 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
         b2Fixture* fixtureA = contact->m_fixtureA;
         b2Fixture* fixtureB = contact->m_fixtureB;
-        b2Shape* shapeA = fixtureA->GetShape();
-        b2Shape* shapeB = fixtureB->GetShape();
+        const b2Shape* shapeA = contact->GetShapeA();
+        const b2Shape* shapeB = contact->GetShapeB();
         float radiusA = shapeA->GetRadius();
         float radiusB = shapeB->GetRadius();
         b2Body* bodyA = fixtureA->GetBody();
         b2Body* bodyB = fixtureB->GetBody();
-        b2Manifold* manifold = contact->GetManifold();
+        const b2BodyState& stateA = bodyA->GetState();
+        const b2BodyState& stateB = bodyB->GetState();
+        b2ContactState& state = contact->GetState();
+        b2Manifold* manifold = &state.manifold;
 
         int32_t pointCount = manifold->pointCount;
         b2Assert(pointCount > 0);
 
         b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
-        vc->friction = contact->m_friction;
-        vc->restitution = contact->m_restitution;
-        vc->tangentSpeed = contact->m_tangentSpeed;
+        vc->friction = state.friction;
+        vc->restitution = state.restitution;
+        vc->tangentSpeed = state.tangentSpeed;
         vc->indexA = bodyA->m_islandIndex;
         vc->indexB = bodyB->m_islandIndex;
-        vc->invMassA = bodyA->m_invMass;
-        vc->invMassB = bodyB->m_invMass;
-        vc->invIA = bodyA->m_invI;
-        vc->invIB = bodyB->m_invI;
+        vc->invMassA = stateA.invMass;
+        vc->invMassB = stateB.invMass;
+        vc->invIA = stateA.invI;
+        vc->invIB = stateB.invI;
         vc->contactIndex = i;
         vc->pointCount = pointCount;
         vc->K.SetZero();
@@ -79,12 +83,12 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
         b2ContactPositionConstraint* pc = m_positionConstraints + i;
         pc->indexA = bodyA->m_islandIndex;
         pc->indexB = bodyB->m_islandIndex;
-        pc->invMassA = bodyA->m_invMass;
-        pc->invMassB = bodyB->m_invMass;
-        pc->localCenterA = bodyA->m_sweep.localCenter;
-        pc->localCenterB = bodyB->m_sweep.localCenter;
-        pc->invIA = bodyA->m_invI;
-        pc->invIB = bodyB->m_invI;
+        pc->invMassA = stateA.invMass;
+        pc->invMassB = stateB.invMass;
+        pc->localCenterA = stateA.sweep.localCenter;
+        pc->localCenterB = stateB.sweep.localCenter;
+        pc->invIA = stateA.invI;
+        pc->invIB = stateB.invI;
         pc->localNormal = manifold->localNormal;
         pc->localPoint = manifold->localPoint;
         pc->pointCount = pointCount;
@@ -170,6 +174,9 @@ void b2ContactSolver::InitializeVelocityConstraints()
 
         vc->normal = worldManifold.normal;
 
+        b2Contact* contact = m_contacts[vc->contactIndex];
+        bool speculative = (contact->m_flags & b2Contact::e_speculativeFlag) != 0;
+
         int32_t pointCount = vc->pointCount;
         for (int32_t j = 0; j < pointCount; ++j)
         {
@@ -197,7 +204,12 @@ void b2ContactSolver::InitializeVelocityConstraints()
             // Setup a velocity bias for restitution.
             vcp->velocityBias = 0.0f;
             float vRel = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
-            if (vRel < -VELOCITY_THRESHOLD)
+            if (speculative && worldManifold.separations[j] > 0.0f)
+            {
+                // The shapes are apart, let them close the gap during this step.
+                vcp->velocityBias = -m_step.inv_dt * worldManifold.separations[j];
+            }
+            else if (vRel < -VELOCITY_THRESHOLD)
             {
                 vcp->velocityBias = -vc->restitution * vRel;
             }
@@ -611,6 +623,32 @@ void b2ContactSolver::StoreImpulses()
     }
 }
 
+// A point with an impulse must move apart at its bias velocity, a point without one must
+// not approach faster than it.
+float b2ContactSolver::ComputeVelocityResidual() const
+{
+    float residual = 0.0f;
+    for (int32_t i = 0; i < m_count; ++i)
+    {
+        const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+
+        b2Vec<float, 2> vA = m_velocities[vc->indexA].v;
+        float wA = m_velocities[vc->indexA].w;
+        b2Vec<float, 2> vB = m_velocities[vc->indexB].v;
+        float wB = m_velocities[vc->indexB].w;
+
+        for (int32_t j = 0; j < vc->pointCount; ++j)
+        {
+            const b2VelocityConstraintPoint* vcp = vc->points + j;
+            b2Vec<float, 2> dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+            float vn = b2Dot(dv, vc->normal) - vcp->velocityBias;
+            float error = vcp->normalImpulse > 0.0f ? std::abs(vn) : b2Max(-vn, 0.0f);
+            residual = b2Max(residual, error);
+        }
+    }
+    return residual;
+}
+
 struct b2PositionSolverManifold
 {
     void Initialize(b2ContactPositionConstraint* pc, const b2Transform& xfA, const b2Transform& xfB,
@@ -738,6 +776,8 @@ bool b2ContactSolver::SolvePositionConstraints()
         m_positions[indexB].a = aB;
     }
 
+    m_minSeparation = minSeparation;
+
     // We can't expect minSpeparation >= -LINEAR_SLOP because we don't
     // push the separation above -LINEAR_SLOP.
     return minSeparation >= -3.0f * LINEAR_SLOP;
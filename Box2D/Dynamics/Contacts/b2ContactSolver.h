@@ -98,6 +98,9 @@ public:
     bool SolvePositionConstraints();
     bool SolveTOIPositionConstraints(int32_t toiIndexA, int32_t toiIndexB);
 
+    // The largest normal velocity error of the contact points, see b2IslandSolverStats.
+    float ComputeVelocityResidual() const;
+
     b2TimeStep m_step;
     b2Position* m_positions;
     b2Velocity* m_velocities;
@@ -106,6 +109,9 @@ public:
     b2ContactVelocityConstraint* m_velocityConstraints;
     b2Contact** m_contacts;
     int m_count;
+
+    // The smallest separation found by the last call to SolvePositionConstraints.
+    float m_minSeparation;
     
     static bool m_blockSolve;
 };
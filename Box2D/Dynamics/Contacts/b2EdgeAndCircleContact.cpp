@@ -25,16 +25,16 @@
 using namespace box2d;
 
 b2Contact* b2EdgeAndCircleContact::Create(b2Fixture* fixtureA, int32_t, b2Fixture* fixtureB,
-                                          int32_t, b2BlockAllocator* allocator)
+                                          int32_t, b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2EdgeAndCircleContact));
+    void* mem = allocator->Allocate(sizeof(b2EdgeAndCircleContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2EdgeAndCircleContact(fixtureA, fixtureB);
 }
 
-void b2EdgeAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2EdgeAndCircleContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2EdgeAndCircleContact*)contact)->~b2EdgeAndCircleContact();
-    allocator->Free(contact, sizeof(b2EdgeAndCircleContact));
+    allocator->Free(contact, sizeof(b2EdgeAndCircleContact), b2MemoryCategory::CONTACTS);
 }
 
 b2EdgeAndCircleContact::b2EdgeAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
@@ -47,6 +47,6 @@ b2EdgeAndCircleContact::b2EdgeAndCircleContact(b2Fixture* fixtureA, b2Fixture* f
 void b2EdgeAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA,
                                       const b2Transform& xfB)
 {
-    b2CollideEdgeAndCircle(manifold, (b2EdgeShape*)m_fixtureA->GetShape(), xfA,
-                           (b2CircleShape*)m_fixtureB->GetShape(), xfB);
+    b2CollideEdgeAndCircle(manifold, (const b2EdgeShape*)GetShapeA(), xfA,
+                           (const b2CircleShape*)GetShapeB(), xfB, m_speculativeDistance);
 }
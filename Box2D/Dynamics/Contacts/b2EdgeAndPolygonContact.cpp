@@ -25,16 +25,16 @@
 using namespace box2d;
 
 b2Contact* b2EdgeAndPolygonContact::Create(b2Fixture* fixtureA, int32_t, b2Fixture* fixtureB,
-                                           int32_t, b2BlockAllocator* allocator)
+                                           int32_t, b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2EdgeAndPolygonContact));
+    void* mem = allocator->Allocate(sizeof(b2EdgeAndPolygonContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2EdgeAndPolygonContact(fixtureA, fixtureB);
 }
 
-void b2EdgeAndPolygonContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2EdgeAndPolygonContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2EdgeAndPolygonContact*)contact)->~b2EdgeAndPolygonContact();
-    allocator->Free(contact, sizeof(b2EdgeAndPolygonContact));
+    allocator->Free(contact, sizeof(b2EdgeAndPolygonContact), b2MemoryCategory::CONTACTS);
 }
 
 b2EdgeAndPolygonContact::b2EdgeAndPolygonContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
@@ -47,6 +47,6 @@ b2EdgeAndPolygonContact::b2EdgeAndPolygonContact(b2Fixture* fixtureA, b2Fixture*
 void b2EdgeAndPolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA,
                                        const b2Transform& xfB)
 {
-    b2CollideEdgeAndPolygon(manifold, (b2EdgeShape*)m_fixtureA->GetShape(), xfA,
-                            (b2PolygonShape*)m_fixtureB->GetShape(), xfB);
+    b2CollideEdgeAndPolygon(manifold, (const b2EdgeShape*)GetShapeA(), xfA,
+                            (const b2PolygonShape*)GetShapeB(), xfB, m_speculativeDistance);
 }
@@ -25,16 +25,16 @@
 using namespace box2d;
 
 b2Contact* b2PolygonAndCircleContact::Create(b2Fixture* fixtureA, int32_t, b2Fixture* fixtureB,
-                                             int32_t, b2BlockAllocator* allocator)
+                                             int32_t, b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2PolygonAndCircleContact));
+    void* mem = allocator->Allocate(sizeof(b2PolygonAndCircleContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2PolygonAndCircleContact(fixtureA, fixtureB);
 }
 
-void b2PolygonAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2PolygonAndCircleContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2PolygonAndCircleContact*)contact)->~b2PolygonAndCircleContact();
-    allocator->Free(contact, sizeof(b2PolygonAndCircleContact));
+    allocator->Free(contact, sizeof(b2PolygonAndCircleContact), b2MemoryCategory::CONTACTS);
 }
 
 b2PolygonAndCircleContact::b2PolygonAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
@@ -47,6 +47,6 @@ b2PolygonAndCircleContact::b2PolygonAndCircleContact(b2Fixture* fixtureA, b2Fixt
 void b2PolygonAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA,
                                          const b2Transform& xfB)
 {
-    b2CollidePolygonAndCircle(manifold, (b2PolygonShape*)m_fixtureA->GetShape(), xfA,
-                              (b2CircleShape*)m_fixtureB->GetShape(), xfB);
+    b2CollidePolygonAndCircle(manifold, (const b2PolygonShape*)GetShapeA(), xfA,
+                              (const b2CircleShape*)GetShapeB(), xfB, m_speculativeDistance);
 }
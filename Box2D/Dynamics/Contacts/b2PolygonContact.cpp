@@ -28,16 +28,16 @@
 using namespace box2d;
 
 b2Contact* b2PolygonContact::Create(b2Fixture* fixtureA, int32_t, b2Fixture* fixtureB, int32_t,
-                                    b2BlockAllocator* allocator)
+                                    b2SmallObjectAllocator* allocator)
 {
-    void* mem = allocator->Allocate(sizeof(b2PolygonContact));
+    void* mem = allocator->Allocate(sizeof(b2PolygonContact), b2MemoryCategory::CONTACTS);
     return new (mem) b2PolygonContact(fixtureA, fixtureB);
 }
 
-void b2PolygonContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+void b2PolygonContact::Destroy(b2Contact* contact, b2SmallObjectAllocator* allocator)
 {
     ((b2PolygonContact*)contact)->~b2PolygonContact();
-    allocator->Free(contact, sizeof(b2PolygonContact));
+    allocator->Free(contact, sizeof(b2PolygonContact), b2MemoryCategory::CONTACTS);
 }
 
 b2PolygonContact::b2PolygonContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
@@ -50,6 +50,6 @@ b2PolygonContact::b2PolygonContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
 void b2PolygonContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA,
                                 const b2Transform& xfB)
 {
-    b2CollidePolygons(manifold, (b2PolygonShape*)m_fixtureA->GetShape(), xfA,
-                      (b2PolygonShape*)m_fixtureB->GetShape(), xfB);
+    b2CollidePolygons(manifold, (const b2PolygonShape*)GetShapeA(), xfA,
+                      (const b2PolygonShape*)GetShapeB(), xfB, m_speculativeDistance);
 }
@@ -64,12 +64,12 @@ void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 {
     m_indexA = m_bodyA->m_islandIndex;
     m_indexB = m_bodyB->m_islandIndex;
-    m_localCenterA = m_bodyA->m_sweep.localCenter;
-    m_localCenterB = m_bodyB->m_sweep.localCenter;
-    m_invMassA = m_bodyA->m_invMass;
-    m_invMassB = m_bodyB->m_invMass;
-    m_invIA = m_bodyA->m_invI;
-    m_invIB = m_bodyB->m_invI;
+    m_localCenterA = m_bodyA->GetState().sweep.localCenter;
+    m_localCenterB = m_bodyB->GetState().sweep.localCenter;
+    m_invMassA = m_bodyA->GetState().invMass;
+    m_invMassB = m_bodyB->GetState().invMass;
+    m_invIA = m_bodyA->GetState().invI;
+    m_invIB = m_bodyB->GetState().invI;
 
     b2Vec<float, 2> cA = data.positions[m_indexA].c;
     float aA = data.positions[m_indexA].a;
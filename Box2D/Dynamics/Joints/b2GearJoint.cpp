@@ -63,9 +63,9 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def) : b2Joint(def)
 
     // Get geometry of joint1
     b2Transform xfA = m_bodyA->m_xf;
-    float aA = m_bodyA->m_sweep.a;
+    float aA = m_bodyA->GetState().sweep.a;
     b2Transform xfC = m_bodyC->m_xf;
-    float aC = m_bodyC->m_sweep.a;
+    float aC = m_bodyC->GetState().sweep.a;
 
     if (m_typeA == b2JointType::REVOLUTE_JOINT)
     {
@@ -95,9 +95,9 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def) : b2Joint(def)
 
     // Get geometry of joint2
     b2Transform xfB = m_bodyB->m_xf;
-    float aB = m_bodyB->m_sweep.a;
+    float aB = m_bodyB->GetState().sweep.a;
     b2Transform xfD = m_bodyD->m_xf;
-    float aD = m_bodyD->m_sweep.a;
+    float aD = m_bodyD->GetState().sweep.a;
 
     if (m_typeB == b2JointType::REVOLUTE_JOINT)
     {
@@ -135,18 +135,18 @@ void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
     m_indexB = m_bodyB->m_islandIndex;
     m_indexC = m_bodyC->m_islandIndex;
     m_indexD = m_bodyD->m_islandIndex;
-    m_lcA = m_bodyA->m_sweep.localCenter;
-    m_lcB = m_bodyB->m_sweep.localCenter;
-    m_lcC = m_bodyC->m_sweep.localCenter;
-    m_lcD = m_bodyD->m_sweep.localCenter;
-    m_mA = m_bodyA->m_invMass;
-    m_mB = m_bodyB->m_invMass;
-    m_mC = m_bodyC->m_invMass;
-    m_mD = m_bodyD->m_invMass;
-    m_iA = m_bodyA->m_invI;
-    m_iB = m_bodyB->m_invI;
-    m_iC = m_bodyC->m_invI;
-    m_iD = m_bodyD->m_invI;
+    m_lcA = m_bodyA->GetState().sweep.localCenter;
+    m_lcB = m_bodyB->GetState().sweep.localCenter;
+    m_lcC = m_bodyC->GetState().sweep.localCenter;
+    m_lcD = m_bodyD->GetState().sweep.localCenter;
+    m_mA = m_bodyA->GetState().invMass;
+    m_mB = m_bodyB->GetState().invMass;
+    m_mC = m_bodyC->GetState().invMass;
+    m_mD = m_bodyD->GetState().invMass;
+    m_iA = m_bodyA->GetState().invI;
+    m_iB = m_bodyB->GetState().invI;
+    m_iC = m_bodyC->GetState().invI;
+    m_iD = m_bodyD->GetState().invI;
 
     float aA = data.positions[m_indexA].a;
     b2Vec<float, 2> vA = data.velocities[m_indexA].v;
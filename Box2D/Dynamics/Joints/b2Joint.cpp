@@ -44,77 +44,77 @@ b2Joint* b2Joint::Create(const b2JointDef* def, b2BlockAllocator* allocator)
     {
         case b2JointType::DISTANCE_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2DistanceJoint));
+            void* mem = allocator->Allocate(sizeof(b2DistanceJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2DistanceJoint(static_cast<const b2DistanceJointDef*>(def));
         }
         break;
 
         case b2JointType::MOUSE_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2MouseJoint));
+            void* mem = allocator->Allocate(sizeof(b2MouseJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2MouseJoint(static_cast<const b2MouseJointDef*>(def));
         }
         break;
 
         case b2JointType::PRISMATIC_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2PrismaticJoint));
+            void* mem = allocator->Allocate(sizeof(b2PrismaticJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2PrismaticJoint(static_cast<const b2PrismaticJointDef*>(def));
         }
         break;
 
         case b2JointType::REVOLUTE_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2RevoluteJoint));
+            void* mem = allocator->Allocate(sizeof(b2RevoluteJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2RevoluteJoint(static_cast<const b2RevoluteJointDef*>(def));
         }
         break;
 
         case b2JointType::PULLEY_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2PulleyJoint));
+            void* mem = allocator->Allocate(sizeof(b2PulleyJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2PulleyJoint(static_cast<const b2PulleyJointDef*>(def));
         }
         break;
 
         case b2JointType::GEAR_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2GearJoint));
+            void* mem = allocator->Allocate(sizeof(b2GearJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2GearJoint(static_cast<const b2GearJointDef*>(def));
         }
         break;
 
         case b2JointType::WHEEL_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2WheelJoint));
+            void* mem = allocator->Allocate(sizeof(b2WheelJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2WheelJoint(static_cast<const b2WheelJointDef*>(def));
         }
         break;
 
         case b2JointType::WELD_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2WeldJoint));
+            void* mem = allocator->Allocate(sizeof(b2WeldJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2WeldJoint(static_cast<const b2WeldJointDef*>(def));
         }
         break;
 
         case b2JointType::FRICTION_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2FrictionJoint));
+            void* mem = allocator->Allocate(sizeof(b2FrictionJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2FrictionJoint(static_cast<const b2FrictionJointDef*>(def));
         }
         break;
 
         case b2JointType::ROPE_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2RopeJoint));
+            void* mem = allocator->Allocate(sizeof(b2RopeJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2RopeJoint(static_cast<const b2RopeJointDef*>(def));
         }
         break;
 
         case b2JointType::MOTOR_JOINT:
         {
-            void* mem = allocator->Allocate(sizeof(b2MotorJoint));
+            void* mem = allocator->Allocate(sizeof(b2MotorJoint), b2MemoryCategory::JOINTS);
             joint = new (mem) b2MotorJoint(static_cast<const b2MotorJointDef*>(def));
         }
         break;
@@ -133,47 +133,47 @@ void b2Joint::Destroy(b2Joint* joint, b2BlockAllocator* allocator)
     switch (joint->m_type)
     {
         case b2JointType::DISTANCE_JOINT:
-            allocator->Free(joint, sizeof(b2DistanceJoint));
+            allocator->Free(joint, sizeof(b2DistanceJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::MOUSE_JOINT:
-            allocator->Free(joint, sizeof(b2MouseJoint));
+            allocator->Free(joint, sizeof(b2MouseJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::PRISMATIC_JOINT:
-            allocator->Free(joint, sizeof(b2PrismaticJoint));
+            allocator->Free(joint, sizeof(b2PrismaticJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::REVOLUTE_JOINT:
-            allocator->Free(joint, sizeof(b2RevoluteJoint));
+            allocator->Free(joint, sizeof(b2RevoluteJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::PULLEY_JOINT:
-            allocator->Free(joint, sizeof(b2PulleyJoint));
+            allocator->Free(joint, sizeof(b2PulleyJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::GEAR_JOINT:
-            allocator->Free(joint, sizeof(b2GearJoint));
+            allocator->Free(joint, sizeof(b2GearJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::WHEEL_JOINT:
-            allocator->Free(joint, sizeof(b2WheelJoint));
+            allocator->Free(joint, sizeof(b2WheelJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::WELD_JOINT:
-            allocator->Free(joint, sizeof(b2WeldJoint));
+            allocator->Free(joint, sizeof(b2WeldJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::FRICTION_JOINT:
-            allocator->Free(joint, sizeof(b2FrictionJoint));
+            allocator->Free(joint, sizeof(b2FrictionJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::ROPE_JOINT:
-            allocator->Free(joint, sizeof(b2RopeJoint));
+            allocator->Free(joint, sizeof(b2RopeJoint), b2MemoryCategory::JOINTS);
             break;
 
         case b2JointType::MOTOR_JOINT:
-            allocator->Free(joint, sizeof(b2MotorJoint));
+            allocator->Free(joint, sizeof(b2MotorJoint), b2MemoryCategory::JOINTS);
             break;
 
         default:
@@ -97,9 +97,9 @@ float b2MouseJoint::GetDampingRatio() const
 void b2MouseJoint::InitVelocityConstraints(const b2SolverData& data)
 {
     m_indexB = m_bodyB->m_islandIndex;
-    m_localCenterB = m_bodyB->m_sweep.localCenter;
-    m_invMassB = m_bodyB->m_invMass;
-    m_invIB = m_bodyB->m_invI;
+    m_localCenterB = m_bodyB->GetState().sweep.localCenter;
+    m_invMassB = m_bodyB->GetState().invMass;
+    m_invIB = m_bodyB->GetState().invI;
 
     b2Vec<float, 2> cB = data.positions[m_indexB].c;
     float aB = data.positions[m_indexB].a;
@@ -129,12 +129,12 @@ void b2PrismaticJoint::InitVelocityConstraints(const b2SolverData& data)
 {
     m_indexA = m_bodyA->m_islandIndex;
     m_indexB = m_bodyB->m_islandIndex;
-    m_localCenterA = m_bodyA->m_sweep.localCenter;
-    m_localCenterB = m_bodyB->m_sweep.localCenter;
-    m_invMassA = m_bodyA->m_invMass;
-    m_invMassB = m_bodyB->m_invMass;
-    m_invIA = m_bodyA->m_invI;
-    m_invIB = m_bodyB->m_invI;
+    m_localCenterA = m_bodyA->GetState().sweep.localCenter;
+    m_localCenterB = m_bodyB->GetState().sweep.localCenter;
+    m_invMassA = m_bodyA->GetState().invMass;
+    m_invMassB = m_bodyB->GetState().invMass;
+    m_invIA = m_bodyA->GetState().invI;
+    m_invIB = m_bodyB->GetState().invI;
 
     b2Vec<float, 2> cA = data.positions[m_indexA].c;
     float aA = data.positions[m_indexA].a;
@@ -521,17 +521,17 @@ float b2PrismaticJoint::GetJointSpeed() const
     b2Body* bA = m_bodyA;
     b2Body* bB = m_bodyB;
 
-    b2Vec<float, 2> rA = b2Mul(bA->m_xf.q, m_localAnchorA - bA->m_sweep.localCenter);
-    b2Vec<float, 2> rB = b2Mul(bB->m_xf.q, m_localAnchorB - bB->m_sweep.localCenter);
-    b2Vec<float, 2> p1 = bA->m_sweep.c + rA;
-    b2Vec<float, 2> p2 = bB->m_sweep.c + rB;
+    b2Vec<float, 2> rA = b2Mul(bA->m_xf.q, m_localAnchorA - bA->GetState().sweep.localCenter);
+    b2Vec<float, 2> rB = b2Mul(bB->m_xf.q, m_localAnchorB - bB->GetState().sweep.localCenter);
+    b2Vec<float, 2> p1 = bA->GetState().sweep.c + rA;
+    b2Vec<float, 2> p2 = bB->GetState().sweep.c + rB;
     b2Vec<float, 2> d = p2 - p1;
     b2Vec<float, 2> axis = b2Mul(bA->m_xf.q, m_localXAxisA);
 
-    b2Vec<float, 2> vA = bA->m_linearVelocity;
-    b2Vec<float, 2> vB = bB->m_linearVelocity;
-    float wA = bA->m_angularVelocity;
-    float wB = bB->m_angularVelocity;
+    b2Vec<float, 2> vA = bA->GetState().linearVelocity;
+    b2Vec<float, 2> vB = bB->GetState().linearVelocity;
+    float wA = bA->GetState().angularVelocity;
+    float wB = bB->GetState().angularVelocity;
 
     float speed =
         b2Dot(d, b2Cross(wA, axis)) + b2Dot(axis, vB + b2Cross(wB, rB) - vA - b2Cross(wA, rA));
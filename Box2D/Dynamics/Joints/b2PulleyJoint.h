@@ -92,6 +92,18 @@ public:
     /// Get the second ground anchor.
     b2Vec<float, 2> GetGroundAnchorB() const;
 
+    /// The local anchor point relative to bodyA's origin.
+    const b2Vec<float, 2>& GetLocalAnchorA() const
+    {
+        return m_localAnchorA;
+    }
+
+    /// The local anchor point relative to bodyB's origin.
+    const b2Vec<float, 2>& GetLocalAnchorB() const
+    {
+        return m_localAnchorB;
+    }
+
     /// Get the current length of the segment attached to bodyA.
     float GetLengthA() const;
 
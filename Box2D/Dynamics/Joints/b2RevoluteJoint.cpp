@@ -66,12 +66,12 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2SolverData& data)
 {
     m_indexA = m_bodyA->m_islandIndex;
     m_indexB = m_bodyB->m_islandIndex;
-    m_localCenterA = m_bodyA->m_sweep.localCenter;
-    m_localCenterB = m_bodyB->m_sweep.localCenter;
-    m_invMassA = m_bodyA->m_invMass;
-    m_invMassB = m_bodyB->m_invMass;
-    m_invIA = m_bodyA->m_invI;
-    m_invIB = m_bodyB->m_invI;
+    m_localCenterA = m_bodyA->GetState().sweep.localCenter;
+    m_localCenterB = m_bodyB->GetState().sweep.localCenter;
+    m_invMassA = m_bodyA->GetState().invMass;
+    m_invMassB = m_bodyB->GetState().invMass;
+    m_invIA = m_bodyA->GetState().invI;
+    m_invIB = m_bodyB->GetState().invI;
 
     float aA = data.positions[m_indexA].a;
     b2Vec<float, 2> vA = data.velocities[m_indexA].v;
@@ -401,14 +401,14 @@ float b2RevoluteJoint::GetJointAngle() const
 {
     b2Body* bA = m_bodyA;
     b2Body* bB = m_bodyB;
-    return bB->m_sweep.a - bA->m_sweep.a - m_referenceAngle;
+    return bB->GetState().sweep.a - bA->GetState().sweep.a - m_referenceAngle;
 }
 
 float b2RevoluteJoint::GetJointSpeed() const
 {
     b2Body* bA = m_bodyA;
     b2Body* bB = m_bodyB;
-    return bB->m_angularVelocity - bA->m_angularVelocity;
+    return bB->GetState().angularVelocity - bA->GetState().angularVelocity;
 }
 
 bool b2RevoluteJoint::IsMotorEnabled() const
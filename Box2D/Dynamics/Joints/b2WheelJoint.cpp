@@ -79,12 +79,12 @@ void b2WheelJoint::InitVelocityConstraints(const b2SolverData& data)
 {
     m_indexA = m_bodyA->m_islandIndex;
     m_indexB = m_bodyB->m_islandIndex;
-    m_localCenterA = m_bodyA->m_sweep.localCenter;
-    m_localCenterB = m_bodyB->m_sweep.localCenter;
-    m_invMassA = m_bodyA->m_invMass;
-    m_invMassB = m_bodyB->m_invMass;
-    m_invIA = m_bodyA->m_invI;
-    m_invIB = m_bodyB->m_invI;
+    m_localCenterA = m_bodyA->GetState().sweep.localCenter;
+    m_localCenterB = m_bodyB->GetState().sweep.localCenter;
+    m_invMassA = m_bodyA->GetState().invMass;
+    m_invMassB = m_bodyB->GetState().invMass;
+    m_invIA = m_bodyA->GetState().invI;
+    m_invIB = m_bodyB->GetState().invI;
 
     float mA = m_invMassA, mB = m_invMassB;
     float iA = m_invIA, iB = m_invIB;
@@ -363,8 +363,8 @@ float b2WheelJoint::GetJointTranslation() const
 
 float b2WheelJoint::GetJointSpeed() const
 {
-    float wA = m_bodyA->m_angularVelocity;
-    float wB = m_bodyB->m_angularVelocity;
+    float wA = m_bodyA->GetState().angularVelocity;
+    float wB = m_bodyB->GetState().angularVelocity;
     return wB - wA;
 }
 
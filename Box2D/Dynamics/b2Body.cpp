@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
 
@@ -39,6 +40,10 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
     {
         m_flags |= e_bulletFlag;
     }
+    if (bd->speculative)
+    {
+        m_flags |= e_speculativeFlag;
+    }
     if (bd->fixedRotation)
     {
         m_flags |= e_fixedRotationFlag;
@@ -57,31 +62,34 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
     }
 
     m_world = world;
+    m_states = &world->m_bodyStates;
+    m_slot = world->CreateBodyState();
+    b2BodyState& state = GetState();
 
     m_xf.p = bd->position;
     m_xf.q.Set(bd->angle);
 
-    m_sweep.localCenter = {{0.0f, 0.0f}};
-    m_sweep.c0 = m_xf.p;
-    m_sweep.c = m_xf.p;
-    m_sweep.a0 = bd->angle;
-    m_sweep.a = bd->angle;
-    m_sweep.alpha0 = 0.0f;
+    state.sweep.localCenter = {{0.0f, 0.0f}};
+    state.sweep.c0 = m_xf.p;
+    state.sweep.c = m_xf.p;
+    state.sweep.a0 = bd->angle;
+    state.sweep.a = bd->angle;
+    state.sweep.alpha0 = 0.0f;
 
     m_jointList = nullptr;
     m_contactList = nullptr;
     m_prev = nullptr;
     m_next = nullptr;
 
-    m_linearVelocity = bd->linearVelocity;
-    m_angularVelocity = bd->angularVelocity;
+    state.linearVelocity = bd->linearVelocity;
+    state.angularVelocity = bd->angularVelocity;
 
     m_linearDamping = bd->linearDamping;
     m_angularDamping = bd->angularDamping;
     m_gravityScale = bd->gravityScale;
 
-    m_force = {{0.0f, 0.0f}};
-    m_torque = 0.0f;
+    state.force = {{0.0f, 0.0f}};
+    state.torque = 0.0f;
 
     m_sleepTime = 0.0f;
 
@@ -90,16 +98,16 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
     if (m_type == b2BodyType::DYNAMIC_BODY)
     {
         m_mass = 1.0f;
-        m_invMass = 1.0f;
+        state.invMass = 1.0f;
     }
     else
     {
         m_mass = 0.0f;
-        m_invMass = 0.0f;
+        state.invMass = 0.0f;
     }
 
     m_I = 0.0f;
-    m_invI = 0.0f;
+    state.invI = 0.0f;
 
     m_userData = bd->userData;
 
@@ -129,19 +137,20 @@ void b2Body::SetType(b2BodyType type)
 
     ResetMassData();
 
+    b2BodyState& state = GetState();
     if (m_type == b2BodyType::STATIC_BODY)
     {
-        m_linearVelocity = {{0.0f, 0.0f}};
-        m_angularVelocity = 0.0f;
-        m_sweep.a0 = m_sweep.a;
-        m_sweep.c0 = m_sweep.c;
+        state.linearVelocity = {{0.0f, 0.0f}};
+        state.angularVelocity = 0.0f;
+        state.sweep.a0 = state.sweep.a;
+        state.sweep.c0 = state.sweep.c;
         SynchronizeFixtures();
     }
 
     SetAwake(true);
 
-    m_force = {{0.0f, 0.0f}};
-    m_torque = 0.0f;
+    state.force = {{0.0f, 0.0f}};
+    state.torque = 0.0f;
 
     // Delete the attached contacts.
     b2ContactEdge* ce = m_contactList;
@@ -175,7 +184,7 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 
     b2BlockAllocator* allocator = &m_world->m_blockAllocator;
 
-    void* memory = allocator->Allocate(sizeof(b2Fixture));
+    void* memory = allocator->Allocate(sizeof(b2Fixture), b2MemoryCategory::FIXTURES);
     auto fixture = new (memory) b2Fixture;
     fixture->Create(allocator, this, def);
 
@@ -201,6 +210,11 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
     // to be created at the beginning of the next time step.
     m_world->m_flags |= b2World::e_newFixture;
 
+    if (m_world->m_recorder)
+    {
+        m_world->m_recorder->FixtureCreated(fixture);
+    }
+
     return fixture;
 }
 
@@ -213,6 +227,15 @@ b2Fixture* b2Body::CreateFixture(const b2Shape* shape, float density)
     return CreateFixture(&def);
 }
 
+b2Fixture* b2Body::CreateFixture(std::shared_ptr<const b2Shape> shape, float density)
+{
+    b2FixtureDef def;
+    def.sharedShape = std::move(shape);
+    def.density = density;
+
+    return CreateFixture(&def);
+}
+
 void b2Body::DestroyFixture(b2Fixture* fixture)
 {
     b2Assert(m_world->IsLocked() == false);
@@ -223,6 +246,11 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
     b2Assert(fixture->m_body == this);
 
+    if (m_world->m_recorder)
+    {
+        m_world->m_recorder->FixtureDestroyed(fixture);
+    }
+
     // Remove the fixture from this body's singly linked list.
     b2Assert(m_fixtureCount > 0);
     b2Fixture** node = &m_fixtureList;
@@ -272,7 +300,7 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
     fixture->m_body = nullptr;
     fixture->m_next = nullptr;
     fixture->~b2Fixture();
-    allocator->Free(fixture, sizeof(b2Fixture));
+    allocator->Free(fixture, sizeof(b2Fixture), b2MemoryCategory::FIXTURES);
 
     --m_fixtureCount;
 
@@ -283,18 +311,19 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 void b2Body::ResetMassData()
 {
     // Compute mass data from shapes. Each shape has its own density.
+    b2BodyState& state = GetState();
     m_mass = 0.0f;
-    m_invMass = 0.0f;
+    state.invMass = 0.0f;
     m_I = 0.0f;
-    m_invI = 0.0f;
-    m_sweep.localCenter = {{0.0f, 0.0f}};
+    state.invI = 0.0f;
+    state.sweep.localCenter = {{0.0f, 0.0f}};
 
     // Static and kinematic bodies have zero mass.
     if (m_type == b2BodyType::STATIC_BODY || m_type == b2BodyType::KINEMATIC_BODY)
     {
-        m_sweep.c0 = m_xf.p;
-        m_sweep.c = m_xf.p;
-        m_sweep.a0 = m_sweep.a;
+        state.sweep.c0 = m_xf.p;
+        state.sweep.c = m_xf.p;
+        state.sweep.a0 = state.sweep.a;
         return;
     }
 
@@ -319,14 +348,14 @@ void b2Body::ResetMassData()
     // Compute center of mass.
     if (m_mass > 0.0f)
     {
-        m_invMass = 1.0f / m_mass;
-        localCenter *= m_invMass;
+        state.invMass = 1.0f / m_mass;
+        localCenter *= state.invMass;
     }
     else
     {
         // Force all dynamic bodies to have a positive mass.
         m_mass = 1.0f;
-        m_invMass = 1.0f;
+        state.invMass = 1.0f;
     }
 
     if (m_I > 0.0f && (m_flags & e_fixedRotationFlag) == 0)
@@ -334,21 +363,21 @@ void b2Body::ResetMassData()
         // Center the inertia about the center of mass.
         m_I -= m_mass * b2Dot(localCenter, localCenter);
         b2Assert(m_I > 0.0f);
-        m_invI = 1.0f / m_I;
+        state.invI = 1.0f / m_I;
     }
     else
     {
         m_I = 0.0f;
-        m_invI = 0.0f;
+        state.invI = 0.0f;
     }
 
     // Move center of mass.
-    b2Vec<float, 2> oldCenter = m_sweep.c;
-    m_sweep.localCenter = localCenter;
-    m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+    b2Vec<float, 2> oldCenter = state.sweep.c;
+    state.sweep.localCenter = localCenter;
+    state.sweep.c0 = state.sweep.c = b2Mul(m_xf, state.sweep.localCenter);
 
     // Update center of mass velocity.
-    m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+    state.linearVelocity += b2Cross(state.angularVelocity, state.sweep.c - oldCenter);
 }
 
 void b2Body::SetMassData(const b2MassData* massData)
@@ -364,9 +393,10 @@ void b2Body::SetMassData(const b2MassData* massData)
         return;
     }
 
-    m_invMass = 0.0f;
+    b2BodyState& state = GetState();
+    state.invMass = 0.0f;
     m_I = 0.0f;
-    m_invI = 0.0f;
+    state.invI = 0.0f;
 
     m_mass = massData->mass;
     if (m_mass <= 0.0f)
@@ -374,22 +404,22 @@ void b2Body::SetMassData(const b2MassData* massData)
         m_mass = 1.0f;
     }
 
-    m_invMass = 1.0f / m_mass;
+    state.invMass = 1.0f / m_mass;
 
     if (massData->I > 0.0f && (m_flags & b2Body::e_fixedRotationFlag) == 0)
     {
         m_I = massData->I - m_mass * b2Dot(massData->center, massData->center);
         b2Assert(m_I > 0.0f);
-        m_invI = 1.0f / m_I;
+        state.invI = 1.0f / m_I;
     }
 
     // Move center of mass.
-    b2Vec<float, 2> oldCenter = m_sweep.c;
-    m_sweep.localCenter = massData->center;
-    m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
+    b2Vec<float, 2> oldCenter = state.sweep.c;
+    state.sweep.localCenter = massData->center;
+    state.sweep.c0 = state.sweep.c = b2Mul(m_xf, state.sweep.localCenter);
 
     // Update center of mass velocity.
-    m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
+    state.linearVelocity += b2Cross(state.angularVelocity, state.sweep.c - oldCenter);
 }
 
 bool b2Body::ShouldCollide(const b2Body* other) const
@@ -426,11 +456,12 @@ void b2Body::SetTransform(const b2Vec<float, 2>& position, float angle)
     m_xf.q.Set(angle);
     m_xf.p = position;
 
-    m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
-    m_sweep.a = angle;
+    b2BodyState& state = GetState();
+    state.sweep.c = b2Mul(m_xf, state.sweep.localCenter);
+    state.sweep.a = angle;
 
-    m_sweep.c0 = m_sweep.c;
-    m_sweep.a0 = angle;
+    state.sweep.c0 = state.sweep.c;
+    state.sweep.a0 = angle;
 
     b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
     for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -442,8 +473,9 @@ void b2Body::SetTransform(const b2Vec<float, 2>& position, float angle)
 void b2Body::SynchronizeFixtures()
 {
     b2Transform xf1;
-    xf1.q.Set(m_sweep.a0);
-    xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+    b2BodyState& state = GetState();
+    xf1.q.Set(state.sweep.a0);
+    xf1.p = state.sweep.c0 - b2Mul(xf1.q, state.sweep.localCenter);
 
     b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
     for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -452,6 +484,20 @@ void b2Body::SynchronizeFixtures()
     }
 }
 
+void b2Body::SynchronizeSpeculativeFixtures(float dt)
+{
+    b2Transform xf2;
+    b2BodyState& state = GetState();
+    xf2.q.Set(state.sweep.a + dt * state.angularVelocity);
+    xf2.p = state.sweep.c + dt * state.linearVelocity - b2Mul(xf2.q, state.sweep.localCenter);
+
+    b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+    for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+    {
+        f->Synchronize(broadPhase, m_xf, xf2);
+    }
+}
+
 void b2Body::SetActive(bool flag)
 {
     b2Assert(m_world->IsLocked() == false);
@@ -514,7 +560,7 @@ void b2Body::SetFixedRotation(bool flag)
         m_flags &= ~e_fixedRotationFlag;
     }
 
-    m_angularVelocity = 0.0f;
+    GetState().angularVelocity = 0.0f;
 
     ResetMassData();
 }
@@ -523,19 +569,21 @@ void b2Body::Dump()
 {
     int32_t bodyIndex = m_islandIndex;
 
+    b2BodyState& state = GetState();
     b2Log("{\n");
     b2Log("  b2BodyDef bd;\n");
     b2Log("  bd.type = b2BodyType(%d);\n", m_type);
     b2Log("  bd.position.Set(%.15lef, %.15lef);\n", m_xf.p[b2VecX], m_xf.p[b2VecY]);
-    b2Log("  bd.angle = %.15lef;\n", m_sweep.a);
-    b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", m_linearVelocity[b2VecX], m_linearVelocity[b2VecY]);
-    b2Log("  bd.angularVelocity = %.15lef;\n", m_angularVelocity);
+    b2Log("  bd.angle = %.15lef;\n", state.sweep.a);
+    b2Log("  bd.linearVelocity.Set(%.15lef, %.15lef);\n", state.linearVelocity[b2VecX], state.linearVelocity[b2VecY]);
+    b2Log("  bd.angularVelocity = %.15lef;\n", state.angularVelocity);
     b2Log("  bd.linearDamping = %.15lef;\n", m_linearDamping);
     b2Log("  bd.angularDamping = %.15lef;\n", m_angularDamping);
     b2Log("  bd.allowSleep = bool(%d);\n", m_flags & e_autoSleepFlag);
     b2Log("  bd.awake = bool(%d);\n", m_flags & e_awakeFlag);
     b2Log("  bd.fixedRotation = bool(%d);\n", m_flags & e_fixedRotationFlag);
     b2Log("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
+    b2Log("  bd.speculative = bool(%d);\n", m_flags & e_speculativeFlag);
     b2Log("  bd.active = bool(%d);\n", m_flags & e_activeFlag);
     b2Log("  bd.gravityScale = %.15lef;\n", m_gravityScale);
     b2Log("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
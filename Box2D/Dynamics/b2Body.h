@@ -20,8 +20,10 @@
 #define B2_BODY_H
 
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Common/b2MemoryResource.h>
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <memory>
+#include <vector>
 
 namespace box2d
 {
@@ -66,6 +68,7 @@ struct b2BodyDef
         awake = true;
         fixedRotation = false;
         bullet = false;
+        speculative = false;
         type = b2BodyType::STATIC_BODY;
         active = true;
         gravityScale = 1.0f;
@@ -114,6 +117,12 @@ struct b2BodyDef
     /// @warning You should use this flag sparingly since it increases processing time.
     bool bullet;
 
+    /// Solve the contacts of this body with speculative contacts instead of continuous
+    /// collision. Speculative contacts are created within a margin that grows with the
+    /// relative velocity and are solved by the regular solver, so they are cheaper
+    /// than time of impact sub-steps. @see b2World::SetSpeculativeContacts
+    bool speculative;
+
     /// Does this body start out active?
     bool active;
 
@@ -124,6 +133,28 @@ struct b2BodyDef
     float gravityScale;
 };
 
+/// The state of a body that integration and the constraint solvers read and write. The
+/// world keeps the states of all bodies in one dense array indexed by the body slot, so
+/// the passes over them do not pull the rest of each body into the cache.
+struct b2BodyState
+{
+    b2Sweep sweep;  // the swept motion for CCD
+
+    b2Vec<float, 2> linearVelocity;
+    float angularVelocity;
+
+    b2Vec<float, 2> force;
+    float torque;
+
+    float invMass;
+
+    // Inverse rotational inertia about the center of mass.
+    float invI;
+};
+
+/// The dense array of body states owned by a world.
+using b2BodyStateArray = std::vector<b2BodyState, b2ResourceAllocator<b2BodyState>>;
+
 /// A rigid body. These are created via b2World::CreateBody.
 class b2Body
 {
@@ -146,6 +177,12 @@ public:
     /// @warning This function is locked during callbacks.
     b2Fixture* CreateFixture(const b2Shape* shape, float density);
 
+    /// Creates a fixture that shares a shape with other fixtures and attach it to this body.
+    /// @param shape the shared shape, see b2FixtureDef::sharedShape.
+    /// @param density the shape density (set to zero for static bodies).
+    /// @warning This function is locked during callbacks.
+    b2Fixture* CreateFixture(std::shared_ptr<const b2Shape> shape, float density);
+
     /// Destroy a fixture. This removes the fixture from the broad-phase and
     /// destroys all contacts associated with this fixture. This will
     /// automatically adjust the mass of the body if the body is dynamic and the
@@ -313,6 +350,12 @@ public:
     /// Is this body treated like a bullet for continuous collision detection?
     bool IsBullet() const;
 
+    /// Should the contacts of this body be solved speculatively?
+    void SetSpeculative(bool flag);
+
+    /// Are the contacts of this body solved speculatively?
+    bool IsSpeculative() const;
+
     /// You can disable sleeping on this body. If you disable sleeping, the
     /// body will be woken.
     void SetSleepingAllowed(bool flag);
@@ -391,6 +434,8 @@ private:
     friend class b2ContactManager;
     friend class b2ContactSolver;
     friend class b2Contact;
+    friend class b2Recorder;
+    friend class b2Replay;
 
     friend class b2DistanceJoint;
     friend class b2FrictionJoint;
@@ -413,13 +458,19 @@ private:
         e_bulletFlag = 0x0008,
         e_fixedRotationFlag = 0x0010,
         e_activeFlag = 0x0020,
-        e_toiFlag = 0x0040
+        e_toiFlag = 0x0040,
+        e_speculativeFlag = 0x0080
     };
 
     b2Body(const b2BodyDef* bd, b2World* world);
     ~b2Body();
 
     void SynchronizeFixtures();
+
+    // Like SynchronizeFixtures, but the proxies cover the motion over the next step
+    // instead of the last one, so speculative contacts exist before the shapes meet.
+    void SynchronizeSpeculativeFixtures(float dt);
+
     void SynchronizeTransform();
 
     // This is used to prevent connected bodies from colliding.
@@ -428,41 +479,45 @@ private:
 
     void Advance(float t);
 
-    b2BodyType m_type;
+    // The state in the world's array. The reference is only valid until the next body is
+    // created, which may grow the array.
+    b2BodyState& GetState();
+    const b2BodyState& GetState() const;
+
+    // The members are ordered by how often the step touches them. The flags, transform
+    // and the slot of the state come first. The damping and the graph heads used by
+    // island building follow. The rest is only used by the object API.
 
     uint16_t m_flags;
+    b2BodyType m_type;
 
     int32_t m_islandIndex;
 
     b2Transform m_xf;  // the body origin transform
-    b2Sweep m_sweep;   // the swept motion for CCD
 
-    b2Vec<float, 2> m_linearVelocity;
-    float m_angularVelocity;
+    b2BodyStateArray* m_states;
+    int32_t m_slot;
 
-    b2Vec<float, 2> m_force;
-    float m_torque;
+    float m_linearDamping;
+    float m_angularDamping;
+    float m_gravityScale;
 
-    b2World* m_world;
-    b2Body* m_prev;
-    b2Body* m_next;
+    float m_sleepTime;
 
     b2Fixture* m_fixtureList;
-    int32_t m_fixtureCount;
-
     b2JointEdge* m_jointList;
     b2ContactEdge* m_contactList;
 
-    float m_mass, m_invMass;
+    float m_mass;
 
     // Rotational inertia about the center of mass.
-    float m_I, m_invI;
+    float m_I;
 
-    float m_linearDamping;
-    float m_angularDamping;
-    float m_gravityScale;
+    int32_t m_fixtureCount;
 
-    float m_sleepTime;
+    b2World* m_world;
+    b2Body* m_prev;
+    b2Body* m_next;
 
     void* m_userData;
 };
@@ -484,17 +539,17 @@ inline const b2Vec<float, 2>& b2Body::GetPosition() const
 
 inline float b2Body::GetAngle() const
 {
-    return m_sweep.a;
+    return GetState().sweep.a;
 }
 
 inline const b2Vec<float, 2>& b2Body::GetWorldCenter() const
 {
-    return m_sweep.c;
+    return GetState().sweep.c;
 }
 
 inline const b2Vec<float, 2>& b2Body::GetLocalCenter() const
 {
-    return m_sweep.localCenter;
+    return GetState().sweep.localCenter;
 }
 
 inline void b2Body::SetLinearVelocity(const b2Vec<float, 2>& v)
@@ -509,12 +564,12 @@ inline void b2Body::SetLinearVelocity(const b2Vec<float, 2>& v)
         SetAwake(true);
     }
 
-    m_linearVelocity = v;
+    GetState().linearVelocity = v;
 }
 
 inline const b2Vec<float, 2>& b2Body::GetLinearVelocity() const
 {
-    return m_linearVelocity;
+    return GetState().linearVelocity;
 }
 
 inline void b2Body::SetAngularVelocity(float w)
@@ -529,12 +584,12 @@ inline void b2Body::SetAngularVelocity(float w)
         SetAwake(true);
     }
 
-    m_angularVelocity = w;
+    GetState().angularVelocity = w;
 }
 
 inline float b2Body::GetAngularVelocity() const
 {
-    return m_angularVelocity;
+    return GetState().angularVelocity;
 }
 
 inline float b2Body::GetMass() const
@@ -544,14 +599,16 @@ inline float b2Body::GetMass() const
 
 inline float b2Body::GetInertia() const
 {
-    return m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
+    const b2BodyState& state = GetState();
+    return m_I + m_mass * b2Dot(state.sweep.localCenter, state.sweep.localCenter);
 }
 
 inline void b2Body::GetMassData(b2MassData* data) const
 {
     data->mass = m_mass;
-    data->I = m_I + m_mass * b2Dot(m_sweep.localCenter, m_sweep.localCenter);
-    data->center = m_sweep.localCenter;
+    const b2BodyState& state = GetState();
+    data->I = m_I + m_mass * b2Dot(state.sweep.localCenter, state.sweep.localCenter);
+    data->center = state.sweep.localCenter;
 }
 
 inline b2Vec<float, 2> b2Body::GetWorldPoint(const b2Vec<float, 2>& localPoint) const
@@ -576,7 +633,8 @@ inline b2Vec<float, 2> b2Body::GetLocalVector(const b2Vec<float, 2>& worldVector
 
 inline b2Vec<float, 2> b2Body::GetLinearVelocityFromWorldPoint(const b2Vec<float, 2>& worldPoint) const
 {
-    return m_linearVelocity + b2Cross(m_angularVelocity, worldPoint - m_sweep.c);
+    const b2BodyState& state = GetState();
+    return state.linearVelocity + b2Cross(state.angularVelocity, worldPoint - state.sweep.c);
 }
 
 inline b2Vec<float, 2> b2Body::GetLinearVelocityFromLocalPoint(const b2Vec<float, 2>& localPoint) const
@@ -631,6 +689,23 @@ inline bool b2Body::IsBullet() const
     return (m_flags & e_bulletFlag) == e_bulletFlag;
 }
 
+inline void b2Body::SetSpeculative(bool flag)
+{
+    if (flag)
+    {
+        m_flags |= e_speculativeFlag;
+    }
+    else
+    {
+        m_flags &= ~e_speculativeFlag;
+    }
+}
+
+inline bool b2Body::IsSpeculative() const
+{
+    return (m_flags & e_speculativeFlag) == e_speculativeFlag;
+}
+
 inline void b2Body::SetAwake(bool flag)
 {
     if (flag)
@@ -645,10 +720,11 @@ inline void b2Body::SetAwake(bool flag)
     {
         m_flags &= ~e_awakeFlag;
         m_sleepTime = 0.0f;
-        m_linearVelocity = {{0.0f, 0.0f}};
-        m_angularVelocity = 0.0f;
-        m_force = {{0.0f, 0.0f}};
-        m_torque = 0.0f;
+        b2BodyState& state = GetState();
+        state.linearVelocity = {{0.0f, 0.0f}};
+        state.angularVelocity = 0.0f;
+        state.force = {{0.0f, 0.0f}};
+        state.torque = 0.0f;
     }
 }
 
@@ -747,11 +823,12 @@ inline void b2Body::ApplyForce(const b2Vec<float, 2>& force, const b2Vec<float,
         SetAwake(true);
     }
 
+    b2BodyState& state = GetState();
     // Don't accumulate a force if the body is sleeping.
     if (m_flags & e_awakeFlag)
     {
-        m_force += force;
-        m_torque += b2Cross(point - m_sweep.c, force);
+        state.force += force;
+        state.torque += b2Cross(point - state.sweep.c, force);
     }
 }
 
@@ -770,7 +847,7 @@ inline void b2Body::ApplyForceToCenter(const b2Vec<float, 2>& force, bool wake)
     // Don't accumulate a force if the body is sleeping
     if (m_flags & e_awakeFlag)
     {
-        m_force += force;
+        GetState().force += force;
     }
 }
 
@@ -789,7 +866,7 @@ inline void b2Body::ApplyTorque(float torque, bool wake)
     // Don't accumulate a force if the body is sleeping
     if (m_flags & e_awakeFlag)
     {
-        m_torque += torque;
+        GetState().torque += torque;
     }
 }
 
@@ -805,11 +882,12 @@ inline void b2Body::ApplyLinearImpulse(const b2Vec<float, 2>& impulse, const b2V
         SetAwake(true);
     }
 
+    b2BodyState& state = GetState();
     // Don't accumulate velocity if the body is sleeping
     if (m_flags & e_awakeFlag)
     {
-        m_linearVelocity += m_invMass * impulse;
-        m_angularVelocity += m_invI * b2Cross(point - m_sweep.c, impulse);
+        state.linearVelocity += state.invMass * impulse;
+        state.angularVelocity += state.invI * b2Cross(point - state.sweep.c, impulse);
     }
 }
 
@@ -825,27 +903,30 @@ inline void b2Body::ApplyAngularImpulse(float impulse, bool wake)
         SetAwake(true);
     }
 
+    b2BodyState& state = GetState();
     // Don't accumulate velocity if the body is sleeping
     if (m_flags & e_awakeFlag)
     {
-        m_angularVelocity += m_invI * impulse;
+        state.angularVelocity += state.invI * impulse;
     }
 }
 
 inline void b2Body::SynchronizeTransform()
 {
-    m_xf.q.Set(m_sweep.a);
-    m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+    b2BodyState& state = GetState();
+    m_xf.q.Set(state.sweep.a);
+    m_xf.p = state.sweep.c - b2Mul(m_xf.q, state.sweep.localCenter);
 }
 
 inline void b2Body::Advance(float alpha)
 {
+    b2BodyState& state = GetState();
     // Advance to the new safe time. This doesn't sync the broad-phase.
-    m_sweep.Advance(alpha);
-    m_sweep.c = m_sweep.c0;
-    m_sweep.a = m_sweep.a0;
-    m_xf.q.Set(m_sweep.a);
-    m_xf.p = m_sweep.c - b2Mul(m_xf.q, m_sweep.localCenter);
+    state.sweep.Advance(alpha);
+    state.sweep.c = state.sweep.c0;
+    state.sweep.a = state.sweep.a0;
+    m_xf.q.Set(state.sweep.a);
+    m_xf.p = state.sweep.c - b2Mul(m_xf.q, state.sweep.localCenter);
 }
 
 inline b2World* b2Body::GetWorld()
@@ -858,6 +939,16 @@ inline const b2World* b2Body::GetWorld() const
     return m_world;
 }
 
+inline b2BodyState& b2Body::GetState()
+{
+    return (*m_states)[m_slot];
+}
+
+inline const b2BodyState& b2Body::GetState() const
+{
+    return (*m_states)[m_slot];
+}
+
 
 /// The b2BodyRef class allows tracking bodies in a world through vector reallocations
 class b2BodyRef
@@ -17,10 +17,14 @@
 */
 
 #include <Box2D/Dynamics/b2ContactManager.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Common/b2Profiler.h>
+
+#include <utility>
 
 using namespace box2d;
 
@@ -30,13 +34,23 @@ namespace box2d
     b2ContactListener b2_defaultListener;
 }
 
-b2ContactManager::b2ContactManager()
+b2ContactManager::b2ContactManager(b2MemoryResource* resource) :
+    m_broadPhase(resource),
+    m_contacts{b2ResourceAllocator<b2Contact*>(resource)},
+    m_contactStates{b2ResourceAllocator<b2ContactState>(resource)}
 {
     m_contactList = nullptr;
     m_contactCount = 0;
     m_contactFilter = &b2_defaultFilter;
     m_contactListener = &b2_defaultListener;
+    m_profiler = nullptr;
+    m_phaseListener = nullptr;
     m_allocator = nullptr;
+    m_speculativeContacts = false;
+    m_contactSerial = 0;
+    m_contactsCreated = 0;
+    m_contactsDestroyed = 0;
+    m_touchingCount = 0;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -100,19 +114,54 @@ void b2ContactManager::Destroy(b2Contact* c)
     }
 
     // Call the factory.
+    int32_t index = c->m_index;
     b2Contact::Destroy(c, m_allocator);
+
+    // Move the last contact into the freed slot.
+    int32_t lastIndex = (int32_t)m_contacts.size() - 1;
+    if (index != lastIndex)
+    {
+        b2Contact* last = m_contacts[lastIndex];
+        last->m_index = index;
+        m_contacts[index] = last;
+        m_contactStates[index] = m_contactStates[lastIndex];
+    }
+    m_contacts.pop_back();
+    m_contactStates.pop_back();
+
     --m_contactCount;
+    ++m_contactsDestroyed;
+}
+
+// The distance the fixtures of a speculative contact may close in one step. This
+// bounds the linear motion and the rotation of the fixture AABBs.
+static float b2ComputeSpeculativeDistance(const b2Fixture* fixtureA, int32_t indexA,
+                                          const b2Fixture* fixtureB, int32_t indexB, float dt)
+{
+    const b2Body* bodyA = fixtureA->GetBody();
+    const b2Body* bodyB = fixtureB->GetBody();
+    b2AABB aabbA = fixtureA->GetAABB(fixtureA->GetChildTree() ? 0 : indexA);
+    b2AABB aabbB = fixtureB->GetAABB(fixtureB->GetChildTree() ? 0 : indexB);
+
+    float speed = (bodyB->GetLinearVelocity() - bodyA->GetLinearVelocity()).Length();
+    speed += std::abs(bodyA->GetAngularVelocity()) * aabbA.GetExtents().Length();
+    speed += std::abs(bodyB->GetAngularVelocity()) * aabbB.GetExtents().Length();
+    return SPECULATIVE_DISTANCE + dt * speed;
 }
 
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
-void b2ContactManager::Collide()
+void b2ContactManager::Collide(const b2TimeStep& step, b2GJKStats* gjkStats)
 {
-    // Update awake contacts.
-    b2Contact* c = m_contactList;
-    while (c)
+    b2PhaseScope phase(m_phaseListener, "Collide");
+    m_touchingCount = 0;
+
+    // Update awake contacts, newest first like the world list. Destroying a contact moves
+    // the last one, which was already visited, into its slot.
+    for (int32_t i = (int32_t)m_contacts.size() - 1; i >= 0; --i)
     {
+        b2Contact* c = m_contacts[i];
         b2Fixture* fixtureA = c->GetFixtureA();
         b2Fixture* fixtureB = c->GetFixtureB();
         int32_t indexA = c->GetChildIndexA();
@@ -126,18 +175,14 @@ void b2ContactManager::Collide()
             // Should these bodies collide?
             if (bodyB->ShouldCollide(bodyA) == false)
             {
-                b2Contact* cNuke = c;
-                c = cNuke->GetNext();
-                Destroy(cNuke);
+                Destroy(c);
                 continue;
             }
 
             // Check user filtering.
             if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
             {
-                b2Contact* cNuke = c;
-                c = cNuke->GetNext();
-                Destroy(cNuke);
+                Destroy(c);
                 continue;
             }
 
@@ -151,45 +196,132 @@ void b2ContactManager::Collide()
         // At least one body must be awake and it must be dynamic or kinematic.
         if (activeA == false && activeB == false)
         {
-            c = c->GetNext();
+            m_touchingCount += c->IsTouching() ? 1 : 0;
             continue;
         }
 
-        int32_t proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-        int32_t proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-        bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+        bool overlap = TestOverlap(fixtureA, indexA, fixtureB, indexB);
 
         // Here we destroy contacts that cease to overlap in the broad-phase.
         if (overlap == false)
         {
-            b2Contact* cNuke = c;
-            c = cNuke->GetNext();
-            Destroy(cNuke);
+            Destroy(c);
             continue;
         }
 
+        if (m_speculativeContacts || bodyA->IsSpeculative() || bodyB->IsSpeculative())
+        {
+            c->m_flags |= b2Contact::e_speculativeFlag;
+            c->m_speculativeDistance =
+                b2ComputeSpeculativeDistance(fixtureA, indexA, fixtureB, indexB, step.dt);
+        }
+        else
+        {
+            c->m_flags &= ~b2Contact::e_speculativeFlag;
+            c->m_speculativeDistance = 0.0f;
+        }
+
         // The contact persists.
-        c->Update(m_contactListener);
-        c = c->GetNext();
+        c->Update(m_contactListener, gjkStats);
+        m_touchingCount += c->IsTouching() ? 1 : 0;
     }
 }
 
 void b2ContactManager::FindNewContacts()
 {
+    B2_PROFILE_ZONE(m_profiler, "UpdatePairs");
+    b2PhaseScope phase(m_phaseListener, "UpdatePairs");
     m_broadPhase.UpdatePairs(this);
 }
 
+bool b2ContactManager::TestOverlap(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
+                                   int32_t indexB) const
+{
+    if (fixtureA->m_childTree == nullptr && fixtureB->m_childTree == nullptr)
+    {
+        int32_t proxyIdA = fixtureA->m_proxies[indexA].proxyId;
+        int32_t proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+        return m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+    }
+
+    if (fixtureA->m_childTree == nullptr)
+    {
+        std::swap(fixtureA, fixtureB);
+        std::swap(indexA, indexB);
+    }
+
+    // This is the test AddTreePairs did through the local tree.
+    const b2ChainShape* chain = (const b2ChainShape*)fixtureA->m_shape;
+    b2AABB edgeAABB;
+    chain->GetTreeAABB(&edgeAABB, indexA);
+
+    const b2AABB& fatAABB = m_broadPhase.GetFatAABB(fixtureB->m_proxies[indexB].proxyId);
+    return b2TestOverlap(edgeAABB, b2MulT(fixtureA->GetBody()->GetTransform(), fatAABB));
+}
+
 void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 {
     b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
     b2FixtureProxy* proxyB = (b2FixtureProxy*)proxyUserDataB;
 
-    b2Fixture* fixtureA = proxyA->fixture;
-    b2Fixture* fixtureB = proxyB->fixture;
+    // A chain with a local tree has one proxy for all edges.
+    if (proxyA->fixture->m_childTree)
+    {
+        AddTreePairs(proxyA, proxyB);
+        return;
+    }
+
+    if (proxyB->fixture->m_childTree)
+    {
+        AddTreePairs(proxyB, proxyA);
+        return;
+    }
+
+    AddPair(proxyA->fixture, proxyA->childIndex, proxyB->fixture, proxyB->childIndex);
+}
+
+struct b2TreePairQuery
+{
+    bool QueryCallback(int32_t nodeId)
+    {
+        int32_t edgeIndex = static_cast<int32_t>(reinterpret_cast<intptr_t>(tree->GetUserData(nodeId)));
+        contactManager->AddPair(treeFixture, edgeIndex, otherFixture, otherIndex);
+        return true;
+    }
+
+    b2ContactManager* contactManager;
+    const b2DynamicTree* tree;
+    b2Fixture* treeFixture;
+    b2Fixture* otherFixture;
+    int32_t otherIndex;
+};
+
+void b2ContactManager::AddTreePairs(b2FixtureProxy* treeProxy, b2FixtureProxy* otherProxy)
+{
+    b2Fixture* treeFixture = treeProxy->fixture;
+    b2Fixture* otherFixture = otherProxy->fixture;
 
-    int32_t indexA = proxyA->childIndex;
-    int32_t indexB = proxyB->childIndex;
+    // Chains do not collide with chains. Skip the query for fixtures on the same body.
+    if (otherFixture->m_childTree || treeFixture->GetBody() == otherFixture->GetBody())
+    {
+        return;
+    }
 
+    b2TreePairQuery query;
+    query.contactManager = this;
+    query.tree = treeFixture->m_childTree;
+    query.treeFixture = treeFixture;
+    query.otherFixture = otherFixture;
+    query.otherIndex = otherProxy->childIndex;
+
+    // Move the other fat AABB into the frame of the chain.
+    const b2AABB& fatAABB = m_broadPhase.GetFatAABB(otherProxy->proxyId);
+    query.tree->Query(&query, b2MulT(treeFixture->GetBody()->GetTransform(), fatAABB));
+}
+
+void b2ContactManager::AddPair(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB,
+                               int32_t indexB)
+{
     b2Body* bodyA = fixtureA->GetBody();
     b2Body* bodyB = fixtureB->GetBody();
 
@@ -256,6 +388,7 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
     bodyB = fixtureB->GetBody();
 
     // Insert into the world.
+    c->m_serial = m_contactSerial++;
     c->m_prev = nullptr;
     c->m_next = m_contactList;
     if (m_contactList != nullptr)
@@ -264,6 +397,18 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
     }
     m_contactList = c;
 
+    // Append to the dense arrays.
+    c->m_states = &m_contactStates;
+    c->m_index = (int32_t)m_contacts.size();
+    m_contacts.push_back(c);
+    m_contactStates.emplace_back();
+
+    b2ContactState& state = m_contactStates.back();
+    state.manifold.pointCount = 0;
+    state.friction = b2MixFriction(fixtureA->m_friction, fixtureB->m_friction);
+    state.restitution = b2MixRestitution(fixtureA->m_restitution, fixtureB->m_restitution);
+    state.tangentSpeed = 0.0f;
+
     // Connect to island graph.
 
     // Connect to body A
@@ -298,4 +443,5 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
     }
 
     ++m_contactCount;
+    ++m_contactsCreated;
 }
@@ -20,19 +20,24 @@
 #define B2_CONTACT_MANAGER_H
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
 
 namespace box2d
 {
-class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
-class b2BlockAllocator;
+class b2SmallObjectAllocator;
+class b2Fixture;
+class b2Profiler;
+class b2PhaseListener;
+struct b2FixtureProxy;
 
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
-    b2ContactManager();
+    b2ContactManager(b2MemoryResource* resource = b2GetDefaultMemoryResource());
 
     // Broad-phase callback.
     void AddPair(void* proxyUserDataA, void* proxyUserDataB);
@@ -41,14 +46,38 @@ public:
 
     void Destroy(b2Contact* c);
 
-    void Collide();
+    void Collide(const b2TimeStep& step, b2GJKStats* gjkStats);
+
+    // Add a contact for a pair of fixture children.
+    void AddPair(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB, int32_t indexB);
+
+    // Add the contacts between the edges of a chain with a local tree and another proxy.
+    void AddTreePairs(b2FixtureProxy* treeProxy, b2FixtureProxy* otherProxy);
+
+    // Do the (fat) bounds of two fixture children overlap?
+    bool TestOverlap(b2Fixture* fixtureA, int32_t indexA, b2Fixture* fixtureB, int32_t indexB) const;
 
     b2BroadPhase m_broadPhase;
     b2Contact* m_contactList;
     int32_t m_contactCount;
+
+    // The contact handles and the contact states, at the same dense index. A destroyed
+    // contact is replaced by the last one, so Collide and the solver scan them linearly.
+    std::vector<b2Contact*, b2ResourceAllocator<b2Contact*>> m_contacts;
+    b2ContactStateArray m_contactStates;
+
     b2ContactFilter* m_contactFilter;
     b2ContactListener* m_contactListener;
-    b2BlockAllocator* m_allocator;
+    b2Profiler* m_profiler;
+    b2PhaseListener* m_phaseListener;
+    b2SmallObjectAllocator* m_allocator;
+    bool m_speculativeContacts;
+    uint64_t m_contactSerial;
+
+    // Counters for b2Profile. Collide sets the touching count.
+    int32_t m_contactsCreated;
+    int32_t m_contactsDestroyed;
+    int32_t m_touchingCount;
 };
 }
 
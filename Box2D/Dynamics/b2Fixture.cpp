@@ -36,6 +36,7 @@ b2Fixture::b2Fixture()
     m_next = nullptr;
     m_proxies = nullptr;
     m_proxyCount = 0;
+    m_childTree = nullptr;
     m_shape = nullptr;
     m_density = 0.0f;
 }
@@ -53,11 +54,27 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 
     m_isSensor = def->isSensor;
 
-    m_shape = def->shape->Clone(allocator);
+    if (def->sharedShape)
+    {
+        m_sharedShape = def->sharedShape;
+        m_shape = const_cast<b2Shape*>(m_sharedShape.get());
+    }
+    else
+    {
+        m_shape = def->shape->Clone(allocator);
+    }
+
+    // A chain with a local edge tree is a single proxy in the broad-phase.
+    m_childTree = nullptr;
+    if (m_shape->GetType() == b2Shape::e_chain)
+    {
+        m_childTree = ((b2ChainShape*)m_shape)->GetLocalTree();
+    }
 
     // Reserve proxy space
-    int32_t childCount = m_shape->GetChildCount();
-    m_proxies = (b2FixtureProxy*)allocator->Allocate(childCount * sizeof(b2FixtureProxy));
+    int32_t childCount = m_childTree ? 1 : m_shape->GetChildCount();
+    m_proxies = (b2FixtureProxy*)allocator->Allocate(childCount * sizeof(b2FixtureProxy),
+                                                     b2MemoryCategory::FIXTURES);
     for (int32_t i = 0; i < childCount; ++i)
     {
         m_proxies[i].fixture = nullptr;
@@ -74,9 +91,17 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
     b2Assert(m_proxyCount == 0);
 
     // Free the proxy array.
-    int32_t childCount = m_shape->GetChildCount();
-    allocator->Free(m_proxies, childCount * sizeof(b2FixtureProxy));
+    int32_t childCount = m_childTree ? 1 : m_shape->GetChildCount();
+    allocator->Free(m_proxies, childCount * sizeof(b2FixtureProxy), b2MemoryCategory::FIXTURES);
     m_proxies = nullptr;
+    m_childTree = nullptr;
+
+    if (m_sharedShape)
+    {
+        m_sharedShape.reset();
+        m_shape = nullptr;
+        return;
+    }
 
     // Free the child shape.
     switch (m_shape->GetType())
@@ -85,7 +110,7 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
         {
             b2CircleShape* s = (b2CircleShape*)m_shape;
             s->~b2CircleShape();
-            allocator->Free(s, sizeof(b2CircleShape));
+            allocator->Free(s, sizeof(b2CircleShape), b2MemoryCategory::SHAPES);
         }
         break;
 
@@ -93,7 +118,7 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
         {
             b2EdgeShape* s = (b2EdgeShape*)m_shape;
             s->~b2EdgeShape();
-            allocator->Free(s, sizeof(b2EdgeShape));
+            allocator->Free(s, sizeof(b2EdgeShape), b2MemoryCategory::SHAPES);
         }
         break;
 
@@ -101,7 +126,7 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
         {
             b2PolygonShape* s = (b2PolygonShape*)m_shape;
             s->~b2PolygonShape();
-            allocator->Free(s, sizeof(b2PolygonShape));
+            allocator->Free(s, sizeof(b2PolygonShape), b2MemoryCategory::SHAPES);
         }
         break;
 
@@ -109,7 +134,7 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
         {
             b2ChainShape* s = (b2ChainShape*)m_shape;
             s->~b2ChainShape();
-            allocator->Free(s, sizeof(b2ChainShape));
+            allocator->Free(s, sizeof(b2ChainShape), b2MemoryCategory::SHAPES);
         }
         break;
 
@@ -126,12 +151,12 @@ void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
     b2Assert(m_proxyCount == 0);
 
     // Create proxies in the broad-phase.
-    m_proxyCount = m_shape->GetChildCount();
+    m_proxyCount = m_childTree ? 1 : m_shape->GetChildCount();
 
     for (int32_t i = 0; i < m_proxyCount; ++i)
     {
         b2FixtureProxy* proxy = m_proxies + i;
-        m_shape->ComputeAABB(&proxy->aabb, xf, i);
+        ComputeProxyAABB(&proxy->aabb, xf, i);
         proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
         proxy->fixture = this;
         proxy->childIndex = i;
@@ -165,14 +190,33 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 
         // Compute an AABB that covers the swept shape (may miss some rotation effect).
         b2AABB aabb1, aabb2;
-        m_shape->ComputeAABB(&aabb1, transform1, proxy->childIndex);
-        m_shape->ComputeAABB(&aabb2, transform2, proxy->childIndex);
+        ComputeProxyAABB(&aabb1, transform1, proxy->childIndex);
+        ComputeProxyAABB(&aabb2, transform2, proxy->childIndex);
 
         proxy->aabb.Combine(aabb1, aabb2);
 
         b2Vec<float, 2> displacement = transform2.p - transform1.p;
 
         broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
+
+        // The edges move inside the fat AABB of a chain proxy, so the pairs with the
+        // local tree must be found again even if the proxy stays put.
+        if (m_childTree)
+        {
+            broadPhase->TouchProxy(proxy->proxyId);
+        }
+    }
+}
+
+void b2Fixture::ComputeProxyAABB(b2AABB* aabb, const b2Transform& xf, int32_t childIndex) const
+{
+    if (m_childTree)
+    {
+        ((const b2ChainShape*)m_shape)->ComputeTreeAABB(aabb, xf);
+    }
+    else
+    {
+        m_shape->ComputeAABB(aabb, xf, childIndex);
     }
 }
 
@@ -24,6 +24,8 @@
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <Box2D/Collision/b2DynamicTree.h>
 
+#include <memory>
+
 namespace box2d
 {
 class b2BlockAllocator;
@@ -69,10 +71,15 @@ struct b2FixtureDef
         isSensor = false;
     }
 
-    /// The shape, this must be set. The shape will be cloned, so you
+    /// The shape, this must be set unless sharedShape is. The shape will be cloned, so you
     /// can create the shape on the stack.
     const b2Shape* shape;
 
+    /// A shape shared by many fixtures. If this is set the fixture keeps a reference to
+    /// it instead of cloning shape, which saves memory when many bodies have the same
+    /// geometry. The shape must not be modified while fixtures use it.
+    std::shared_ptr<const b2Shape> sharedShape;
+
     /// Use this to store application specific fixture data.
     void* userData;
 
@@ -119,9 +126,14 @@ public:
     /// Get the child shape. You can modify the child shape, however you should not change the
     /// number of vertices because this will crash some collision caching mechanisms.
     /// Manipulating the shape may lead to non-physical behavior.
+    /// @warning a shared shape must not be modified, it is only available through the const
+    /// accessor. This one asserts if the shape is shared, see IsShapeShared.
     b2Shape* GetShape();
     const b2Shape* GetShape() const;
 
+    /// Is the shape shared with other fixtures? See b2FixtureDef::sharedShape.
+    bool IsShapeShared() const;
+
     /// Set if this fixture is a sensor.
     void SetSensor(bool sensor);
 
@@ -198,6 +210,11 @@ public:
     /// the body transform.
     const b2AABB& GetAABB(int32_t childIndex) const;
 
+    /// Get the local edge tree of a chain fixture, see b2ChainShape::SetLocalTree.
+    /// Such a fixture has a single proxy covering all of its children.
+    /// @return the tree or nullptr if the children have their own proxies.
+    const b2DynamicTree* GetChildTree() const;
+
     /// Dump this fixture to the log file.
     void Dump(int32_t bodyIndex);
 
@@ -221,23 +238,31 @@ protected:
 
     void Synchronize(b2BroadPhase* broadPhase, const b2Transform& xf1, const b2Transform& xf2);
 
-    float m_density;
+    void ComputeProxyAABB(b2AABB* aabb, const b2Transform& xf, int32_t childIndex) const;
+
+    // Synchronization, pair filtering and the narrow-phase use the members up to
+    // m_isSensor, which are kept together at the start.
 
     b2Fixture* m_next;
     b2Body* m_body;
 
     b2Shape* m_shape;
 
-    float m_friction;
-    float m_restitution;
-
     b2FixtureProxy* m_proxies;
+    const b2DynamicTree* m_childTree;
     int32_t m_proxyCount;
 
     b2Filter m_filter;
 
     bool m_isSensor;
 
+    float m_density;
+    float m_friction;
+    float m_restitution;
+
+    // Holds a reference to m_shape if it is shared.
+    std::shared_ptr<const b2Shape> m_sharedShape;
+
     void* m_userData;
 };
 
@@ -246,8 +271,14 @@ inline b2Shape::Type b2Fixture::GetType() const
     return m_shape->GetType();
 }
 
+inline const b2DynamicTree* b2Fixture::GetChildTree() const
+{
+    return m_childTree;
+}
+
 inline b2Shape* b2Fixture::GetShape()
 {
+    b2Assert(m_sharedShape == nullptr);
     return m_shape;
 }
 
@@ -256,6 +287,11 @@ inline const b2Shape* b2Fixture::GetShape() const
     return m_shape;
 }
 
+inline bool b2Fixture::IsShapeShared() const
+{
+    return m_sharedShape != nullptr;
+}
+
 inline bool b2Fixture::IsSensor() const
 {
     return m_isSensor;
@@ -21,11 +21,13 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Profiler.h>
 
 using namespace box2d;
 
@@ -149,7 +151,9 @@ However, we can compute sin+cos of the same angle fast.
 */
 
 b2Island::b2Island(int32_t bodyCapacity, int32_t contactCapacity, int32_t jointCapacity,
-                   b2StackAllocator* allocator, b2ContactListener* listener)
+                   b2StackAllocator* allocator, b2ContactListener* listener,
+                   b2Profiler* profiler, const b2PerfCounters* perfCounters,
+                   b2SolverListener* solverListener, b2PhaseListener* phaseListener)
 {
     m_bodyCapacity = bodyCapacity;
     m_contactCapacity = contactCapacity;
@@ -160,6 +164,11 @@ b2Island::b2Island(int32_t bodyCapacity, int32_t contactCapacity, int32_t jointC
 
     m_allocator = allocator;
     m_listener = listener;
+    m_profiler = profiler;
+    m_perfCounters = perfCounters;
+    m_solverListener = solverListener;
+    m_phaseListener = phaseListener;
+    m_index = -1;
 
     m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
     m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity * sizeof(b2Contact*));
@@ -182,7 +191,9 @@ b2Island::~b2Island()
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<float, 2>& gravity,
                      bool allowSleep)
 {
+    B2_PROFILE_ZONE_VALUE(m_profiler, "Island", m_bodyCount);
     b2Timer timer;
+    b2PerfTimer perf(m_perfCounters);
 
     float h = step.dt;
 
@@ -190,21 +201,22 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
     for (int32_t i = 0; i < m_bodyCount; ++i)
     {
         b2Body* b = m_bodies[i];
+        b2BodyState& state = b->GetState();
 
-        b2Vec<float, 2> c = b->m_sweep.c;
-        float a = b->m_sweep.a;
-        b2Vec<float, 2> v = b->m_linearVelocity;
-        float w = b->m_angularVelocity;
+        b2Vec<float, 2> c = state.sweep.c;
+        float a = state.sweep.a;
+        b2Vec<float, 2> v = state.linearVelocity;
+        float w = state.angularVelocity;
 
         // Store positions for continuous collision.
-        b->m_sweep.c0 = b->m_sweep.c;
-        b->m_sweep.a0 = b->m_sweep.a;
+        state.sweep.c0 = state.sweep.c;
+        state.sweep.a0 = state.sweep.a;
 
         if (b->m_type == b2BodyType::DYNAMIC_BODY)
         {
             // Integrate velocities.
-            v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
-            w += h * b->m_invI * b->m_torque;
+            v += h * (b->m_gravityScale * gravity + state.invMass * state.force);
+            w += h * state.invI * state.torque;
 
             // Apply damping.
             // ODE: dv/dt + c * v = 0
@@ -225,6 +237,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
     }
 
     timer.Reset();
+    perf.Reset();
 
     // Solver data
     b2SolverData solverData;
@@ -255,9 +268,21 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
     }
 
     profile->solveInit = timer.GetMilliseconds();
+    profile->hardware.solveInit = perf.GetSample();
+
+    // Convergence of each iteration, only measured for the solver listener.
+    float* velocityResiduals = nullptr;
+    float* positionErrors = nullptr;
+    if (m_solverListener)
+    {
+        velocityResiduals =
+            (float*)m_allocator->Allocate(step.velocityIterations * sizeof(float));
+        positionErrors = (float*)m_allocator->Allocate(step.positionIterations * sizeof(float));
+    }
 
     // Solve velocity constraints
     timer.Reset();
+    perf.Reset();
     for (int32_t i = 0; i < step.velocityIterations; ++i)
     {
         for (int32_t j = 0; j < m_jointCount; ++j)
@@ -266,11 +291,17 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
         }
 
         contactSolver.SolveVelocityConstraints();
+
+        if (velocityResiduals)
+        {
+            velocityResiduals[i] = contactSolver.ComputeVelocityResidual();
+        }
     }
 
     // Store impulses for warm starting
     contactSolver.StoreImpulses();
     profile->solveVelocity = timer.GetMilliseconds();
+    profile->hardware.solveVelocity = perf.GetSample();
 
     // Integrate positions
     for (int32_t i = 0; i < m_bodyCount; ++i)
@@ -307,10 +338,18 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
 
     // Solve position constraints
     timer.Reset();
+    perf.Reset();
     bool positionSolved = false;
+    int32_t positionIterations = 0;
     for (int32_t i = 0; i < step.positionIterations; ++i)
     {
         bool contactsOkay = contactSolver.SolvePositionConstraints();
+        ++positionIterations;
+
+        if (positionErrors)
+        {
+            positionErrors[i] = -contactSolver.m_minSeparation;
+        }
 
         bool jointsOkay = true;
         for (int32_t i = 0; i < m_jointCount; ++i)
@@ -331,17 +370,38 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
     for (int32_t i = 0; i < m_bodyCount; ++i)
     {
         b2Body* body = m_bodies[i];
-        body->m_sweep.c = m_positions[i].c;
-        body->m_sweep.a = m_positions[i].a;
-        body->m_linearVelocity = m_velocities[i].v;
-        body->m_angularVelocity = m_velocities[i].w;
+        b2BodyState& state = body->GetState();
+        state.sweep.c = m_positions[i].c;
+        state.sweep.a = m_positions[i].a;
+        state.linearVelocity = m_velocities[i].v;
+        state.angularVelocity = m_velocities[i].w;
         body->SynchronizeTransform();
     }
 
     profile->solvePosition = timer.GetMilliseconds();
+    profile->hardware.solvePosition = perf.GetSample();
+    profile->positionIterations = positionIterations;
+    profile->unsolvedIslands = positionSolved ? 0 : 1;
 
     Report(contactSolver.m_velocityConstraints);
 
+    if (m_solverListener)
+    {
+        b2IslandSolverStats stats;
+        stats.bodyCount = m_bodyCount;
+        stats.contactCount = m_contactCount;
+        stats.jointCount = m_jointCount;
+        stats.velocityResiduals = velocityResiduals;
+        stats.velocityIterations = step.velocityIterations;
+        stats.positionErrors = positionErrors;
+        stats.positionIterations = positionIterations;
+        stats.positionSolved = positionSolved;
+        m_solverListener->IslandSolved(stats);
+
+        m_allocator->Free(positionErrors);
+        m_allocator->Free(velocityResiduals);
+    }
+
     if (allowSleep)
     {
         float minSleepTime = MAX_FLOAT;
@@ -357,9 +417,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
                 continue;
             }
 
+            const b2BodyState& state = b->GetState();
             if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-                b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-                b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+                state.angularVelocity * state.angularVelocity > angTolSqr ||
+                b2Dot(state.linearVelocity, state.linearVelocity) > linTolSqr)
             {
                 b->m_sleepTime = 0.0f;
                 minSleepTime = 0.0f;
@@ -384,17 +445,18 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec<flo
 
 void b2Island::SolveTOI(const b2TimeStep& subStep, int32_t toiIndexA, int32_t toiIndexB)
 {
+    B2_PROFILE_ZONE_VALUE(m_profiler, "IslandTOI", m_bodyCount);
     b2Assert(toiIndexA < m_bodyCount);
     b2Assert(toiIndexB < m_bodyCount);
 
     // Initialize the body state.
     for (int32_t i = 0; i < m_bodyCount; ++i)
     {
-        b2Body* b = m_bodies[i];
-        m_positions[i].c = b->m_sweep.c;
-        m_positions[i].a = b->m_sweep.a;
-        m_velocities[i].v = b->m_linearVelocity;
-        m_velocities[i].w = b->m_angularVelocity;
+        const b2BodyState& state = m_bodies[i]->GetState();
+        m_positions[i].c = state.sweep.c;
+        m_positions[i].a = state.sweep.a;
+        m_velocities[i].v = state.linearVelocity;
+        m_velocities[i].w = state.angularVelocity;
     }
 
     b2ContactSolverDef contactSolverDef;
@@ -450,10 +512,12 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32_t toiIndexA, int32_t to
 #endif
 
     // Leap of faith to new safe state.
-    m_bodies[toiIndexA]->m_sweep.c0 = m_positions[toiIndexA].c;
-    m_bodies[toiIndexA]->m_sweep.a0 = m_positions[toiIndexA].a;
-    m_bodies[toiIndexB]->m_sweep.c0 = m_positions[toiIndexB].c;
-    m_bodies[toiIndexB]->m_sweep.a0 = m_positions[toiIndexB].a;
+    b2Sweep& sweepA = m_bodies[toiIndexA]->GetState().sweep;
+    b2Sweep& sweepB = m_bodies[toiIndexB]->GetState().sweep;
+    sweepA.c0 = m_positions[toiIndexA].c;
+    sweepA.a0 = m_positions[toiIndexA].a;
+    sweepB.c0 = m_positions[toiIndexB].c;
+    sweepB.a0 = m_positions[toiIndexB].a;
 
     // No warm starting is needed for TOI events because warm
     // starting impulses were applied in the discrete solver.
@@ -504,10 +568,11 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32_t toiIndexA, int32_t to
 
         // Sync bodies
         b2Body* body = m_bodies[i];
-        body->m_sweep.c = c;
-        body->m_sweep.a = a;
-        body->m_linearVelocity = v;
-        body->m_angularVelocity = w;
+        b2BodyState& state = body->GetState();
+        state.sweep.c = c;
+        state.sweep.a = a;
+        state.linearVelocity = v;
+        state.angularVelocity = w;
         body->SynchronizeTransform();
     }
 
@@ -521,6 +586,7 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
         return;
     }
 
+    b2PhaseScope phase(m_phaseListener, "PostSolve", m_index);
     for (int32_t i = 0; i < m_contactCount; ++i)
     {
         b2Contact* c = m_contacts[i];
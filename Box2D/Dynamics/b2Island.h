@@ -29,6 +29,10 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+class b2SolverListener;
+class b2Profiler;
+class b2PhaseListener;
+class b2PerfCounters;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -37,7 +41,9 @@ class b2Island
 {
 public:
     b2Island(int32_t bodyCapacity, int32_t contactCapacity, int32_t jointCapacity,
-             b2StackAllocator* allocator, b2ContactListener* listener);
+             b2StackAllocator* allocator, b2ContactListener* listener, b2Profiler* profiler,
+             const b2PerfCounters* perfCounters, b2SolverListener* solverListener,
+             b2PhaseListener* phaseListener);
     ~b2Island();
 
     void Clear()
@@ -75,6 +81,13 @@ public:
 
     b2StackAllocator* m_allocator;
     b2ContactListener* m_listener;
+    b2Profiler* m_profiler;
+    const b2PerfCounters* m_perfCounters;
+    b2SolverListener* m_solverListener;
+    b2PhaseListener* m_phaseListener;
+
+    // The index of the island in the step for the phase markers, -1 for time of impact.
+    int32_t m_index;
 
     b2Body** m_bodies;
     b2Contact** m_contacts;
@@ -0,0 +1,1583 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2Recorder.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
+#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
+#include <Box2D/Dynamics/Joints/b2GearJoint.h>
+#include <Box2D/Dynamics/Joints/b2MotorJoint.h>
+#include <Box2D/Dynamics/Joints/b2MouseJoint.h>
+#include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
+#include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2RopeJoint.h>
+#include <Box2D/Dynamics/Joints/b2WeldJoint.h>
+#include <Box2D/Dynamics/Joints/b2WheelJoint.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace box2d;
+
+static const char b2_captureMagic[4] = {'B', '2', 'R', 'C'};
+static const uint32_t b2_captureVersion = 1;
+
+// A capture is the header followed by records, each starting with one of these tags.
+enum b2RecordTag : uint8_t
+{
+    e_recordSettings = 1,
+    e_recordCreateBody,
+    e_recordDestroyBody,
+    e_recordBodyState,
+    e_recordCreateFixture,
+    e_recordDestroyFixture,
+    e_recordCreateJoint,
+    e_recordDestroyJoint,
+    e_recordJointState,
+    e_recordShiftOrigin,
+    e_recordCompact,
+    e_recordReset,
+    e_recordStep
+};
+
+// The parts of a body state record.
+enum
+{
+    e_stateFlags = 0x01,
+    e_stateTransform = 0x02,
+    e_stateVelocity = 0x04,
+    e_stateForce = 0x08,
+    e_stateSleep = 0x10,
+    e_stateDamping = 0x20,
+    e_stateGravity = 0x40
+};
+
+// b2RecordedBody::flags, the body type is in the low two bits.
+enum
+{
+    e_bodyTypeMask = 0x03,
+    e_bodyAwake = 0x04,
+    e_bodyActive = 0x08,
+    e_bodyFixedRotation = 0x10,
+    e_bodyBullet = 0x20,
+    e_bodySleepingAllowed = 0x40,
+    e_bodySpeculative = 0x80
+};
+
+// The world settings.
+enum
+{
+    e_worldAllowSleep = 0x01,
+    e_worldWarmStarting = 0x02,
+    e_worldContinuous = 0x04,
+    e_worldSubStepping = 0x08,
+    e_worldAnalyticTOI = 0x10,
+    e_worldSpeculative = 0x20,
+    e_worldClearForces = 0x40
+};
+
+static uint8_t b2GetSettings(const b2World* world)
+{
+    uint8_t settings = 0;
+    settings |= world->GetAllowSleeping() ? e_worldAllowSleep : 0;
+    settings |= world->GetWarmStarting() ? e_worldWarmStarting : 0;
+    settings |= world->GetContinuousPhysics() ? e_worldContinuous : 0;
+    settings |= world->GetSubStepping() ? e_worldSubStepping : 0;
+    settings |= world->GetAnalyticTOI() ? e_worldAnalyticTOI : 0;
+    settings |= world->GetSpeculativeContacts() ? e_worldSpeculative : 0;
+    settings |= world->GetAutoClearForces() ? e_worldClearForces : 0;
+    return settings;
+}
+
+// Get the parameters of a joint in the order of its definition. Booleans are stored as
+// 0 or 1. The gear joint only stores its ratio, the joints it couples are recorded apart.
+static int32_t b2GetJointParams(const b2Joint* joint, float* p)
+{
+    int32_t n = 0;
+    auto vec = [&](const b2Vec<float, 2>& v) {
+        p[n++] = v[b2VecX];
+        p[n++] = v[b2VecY];
+    };
+
+    switch (joint->GetType())
+    {
+        case b2JointType::REVOLUTE_JOINT:
+        {
+            auto j = static_cast<const b2RevoluteJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            p[n++] = j->GetReferenceAngle();
+            p[n++] = j->IsLimitEnabled() ? 1.0f : 0.0f;
+            p[n++] = j->GetLowerLimit();
+            p[n++] = j->GetUpperLimit();
+            p[n++] = j->IsMotorEnabled() ? 1.0f : 0.0f;
+            p[n++] = j->GetMotorSpeed();
+            p[n++] = j->GetMaxMotorTorque();
+        }
+        break;
+
+        case b2JointType::PRISMATIC_JOINT:
+        {
+            auto j = static_cast<const b2PrismaticJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            vec(j->GetLocalAxisA());
+            p[n++] = j->GetReferenceAngle();
+            p[n++] = j->IsLimitEnabled() ? 1.0f : 0.0f;
+            p[n++] = j->GetLowerLimit();
+            p[n++] = j->GetUpperLimit();
+            p[n++] = j->IsMotorEnabled() ? 1.0f : 0.0f;
+            p[n++] = j->GetMaxMotorForce();
+            p[n++] = j->GetMotorSpeed();
+        }
+        break;
+
+        case b2JointType::DISTANCE_JOINT:
+        {
+            auto j = static_cast<const b2DistanceJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            p[n++] = j->GetLength();
+            p[n++] = j->GetFrequency();
+            p[n++] = j->GetDampingRatio();
+        }
+        break;
+
+        case b2JointType::PULLEY_JOINT:
+        {
+            auto j = static_cast<const b2PulleyJoint*>(joint);
+            vec(j->GetGroundAnchorA());
+            vec(j->GetGroundAnchorB());
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            p[n++] = j->GetLengthA();
+            p[n++] = j->GetLengthB();
+            p[n++] = j->GetRatio();
+        }
+        break;
+
+        case b2JointType::MOUSE_JOINT:
+        {
+            auto j = static_cast<const b2MouseJoint*>(joint);
+            vec(j->GetTarget());
+            p[n++] = j->GetMaxForce();
+            p[n++] = j->GetFrequency();
+            p[n++] = j->GetDampingRatio();
+        }
+        break;
+
+        case b2JointType::GEAR_JOINT:
+        {
+            auto j = static_cast<const b2GearJoint*>(joint);
+            p[n++] = j->GetRatio();
+        }
+        break;
+
+        case b2JointType::WHEEL_JOINT:
+        {
+            auto j = static_cast<const b2WheelJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            vec(j->GetLocalAxisA());
+            p[n++] = j->IsMotorEnabled() ? 1.0f : 0.0f;
+            p[n++] = j->GetMaxMotorTorque();
+            p[n++] = j->GetMotorSpeed();
+            p[n++] = j->GetSpringFrequencyHz();
+            p[n++] = j->GetSpringDampingRatio();
+        }
+        break;
+
+        case b2JointType::WELD_JOINT:
+        {
+            auto j = static_cast<const b2WeldJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            p[n++] = j->GetReferenceAngle();
+            p[n++] = j->GetFrequency();
+            p[n++] = j->GetDampingRatio();
+        }
+        break;
+
+        case b2JointType::FRICTION_JOINT:
+        {
+            auto j = static_cast<const b2FrictionJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            p[n++] = j->GetMaxForce();
+            p[n++] = j->GetMaxTorque();
+        }
+        break;
+
+        case b2JointType::ROPE_JOINT:
+        {
+            auto j = static_cast<const b2RopeJoint*>(joint);
+            vec(j->GetLocalAnchorA());
+            vec(j->GetLocalAnchorB());
+            p[n++] = j->GetMaxLength();
+        }
+        break;
+
+        case b2JointType::MOTOR_JOINT:
+        {
+            auto j = static_cast<const b2MotorJoint*>(joint);
+            vec(j->GetLinearOffset());
+            p[n++] = j->GetAngularOffset();
+            p[n++] = j->GetMaxForce();
+            p[n++] = j->GetMaxTorque();
+            p[n++] = j->GetCorrectionFactor();
+        }
+        break;
+
+        default:
+            b2Assert(false);
+            break;
+    }
+
+    return n;
+}
+
+// Apply the parameters that the joint setters can change. Only the changed values are
+// set, since the setters wake the bodies and may reset the accumulated impulses.
+static void b2SetJointParams(b2Joint* joint, const float* p)
+{
+    float q[16];
+    b2GetJointParams(joint, q);
+    auto changed = [&](int32_t i) { return std::memcmp(p + i, q + i, sizeof(float)) != 0; };
+    auto vec = [&](int32_t i) { return b2Vec<float, 2>{{p[i], p[i + 1]}}; };
+
+    switch (joint->GetType())
+    {
+        case b2JointType::REVOLUTE_JOINT:
+        {
+            auto j = static_cast<b2RevoluteJoint*>(joint);
+            if (changed(5))
+            {
+                j->EnableLimit(p[5] != 0.0f);
+            }
+            if (changed(6) || changed(7))
+            {
+                j->SetLimits(p[6], p[7]);
+            }
+            if (changed(8))
+            {
+                j->EnableMotor(p[8] != 0.0f);
+            }
+            if (changed(9))
+            {
+                j->SetMotorSpeed(p[9]);
+            }
+            if (changed(10))
+            {
+                j->SetMaxMotorTorque(p[10]);
+            }
+        }
+        break;
+
+        case b2JointType::PRISMATIC_JOINT:
+        {
+            auto j = static_cast<b2PrismaticJoint*>(joint);
+            if (changed(7))
+            {
+                j->EnableLimit(p[7] != 0.0f);
+            }
+            if (changed(8) || changed(9))
+            {
+                j->SetLimits(p[8], p[9]);
+            }
+            if (changed(10))
+            {
+                j->EnableMotor(p[10] != 0.0f);
+            }
+            if (changed(11))
+            {
+                j->SetMaxMotorForce(p[11]);
+            }
+            if (changed(12))
+            {
+                j->SetMotorSpeed(p[12]);
+            }
+        }
+        break;
+
+        case b2JointType::DISTANCE_JOINT:
+        {
+            auto j = static_cast<b2DistanceJoint*>(joint);
+            if (changed(4))
+            {
+                j->SetLength(p[4]);
+            }
+            if (changed(5))
+            {
+                j->SetFrequency(p[5]);
+            }
+            if (changed(6))
+            {
+                j->SetDampingRatio(p[6]);
+            }
+        }
+        break;
+
+        case b2JointType::MOUSE_JOINT:
+        {
+            auto j = static_cast<b2MouseJoint*>(joint);
+            if (changed(0) || changed(1))
+            {
+                j->SetTarget(vec(0));
+            }
+            if (changed(2))
+            {
+                j->SetMaxForce(p[2]);
+            }
+            if (changed(3))
+            {
+                j->SetFrequency(p[3]);
+            }
+            if (changed(4))
+            {
+                j->SetDampingRatio(p[4]);
+            }
+        }
+        break;
+
+        case b2JointType::GEAR_JOINT:
+        {
+            auto j = static_cast<b2GearJoint*>(joint);
+            if (changed(0))
+            {
+                j->SetRatio(p[0]);
+            }
+        }
+        break;
+
+        case b2JointType::WHEEL_JOINT:
+        {
+            auto j = static_cast<b2WheelJoint*>(joint);
+            if (changed(6))
+            {
+                j->EnableMotor(p[6] != 0.0f);
+            }
+            if (changed(7))
+            {
+                j->SetMaxMotorTorque(p[7]);
+            }
+            if (changed(8))
+            {
+                j->SetMotorSpeed(p[8]);
+            }
+            if (changed(9))
+            {
+                j->SetSpringFrequencyHz(p[9]);
+            }
+            if (changed(10))
+            {
+                j->SetSpringDampingRatio(p[10]);
+            }
+        }
+        break;
+
+        case b2JointType::WELD_JOINT:
+        {
+            auto j = static_cast<b2WeldJoint*>(joint);
+            if (changed(5))
+            {
+                j->SetFrequency(p[5]);
+            }
+            if (changed(6))
+            {
+                j->SetDampingRatio(p[6]);
+            }
+        }
+        break;
+
+        case b2JointType::FRICTION_JOINT:
+        {
+            auto j = static_cast<b2FrictionJoint*>(joint);
+            if (changed(4))
+            {
+                j->SetMaxForce(p[4]);
+            }
+            if (changed(5))
+            {
+                j->SetMaxTorque(p[5]);
+            }
+        }
+        break;
+
+        case b2JointType::ROPE_JOINT:
+        {
+            auto j = static_cast<b2RopeJoint*>(joint);
+            if (changed(4))
+            {
+                j->SetMaxLength(p[4]);
+            }
+        }
+        break;
+
+        case b2JointType::MOTOR_JOINT:
+        {
+            auto j = static_cast<b2MotorJoint*>(joint);
+            if (changed(0) || changed(1))
+            {
+                j->SetLinearOffset(vec(0));
+            }
+            if (changed(2))
+            {
+                j->SetAngularOffset(p[2]);
+            }
+            if (changed(3))
+            {
+                j->SetMaxForce(p[3]);
+            }
+            if (changed(4))
+            {
+                j->SetMaxTorque(p[4]);
+            }
+            if (changed(5))
+            {
+                j->SetCorrectionFactor(p[5]);
+            }
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+// Create a joint from its parameters, see b2GetJointParams.
+static b2Joint* b2CreateJoint(b2World* world, b2JointType type, b2Body* bodyA, b2Body* bodyB,
+                              bool collideConnected, b2Joint* joint1, b2Joint* joint2,
+                              const float* p)
+{
+    auto vec = [&](int32_t i) { return b2Vec<float, 2>{{p[i], p[i + 1]}}; };
+    auto setBase = [&](b2JointDef* def) {
+        def->bodyA = bodyA;
+        def->bodyB = bodyB;
+        def->collideConnected = collideConnected;
+        return world->CreateJoint(def);
+    };
+
+    switch (type)
+    {
+        case b2JointType::REVOLUTE_JOINT:
+        {
+            b2RevoluteJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.referenceAngle = p[4];
+            def.enableLimit = p[5] != 0.0f;
+            def.lowerAngle = p[6];
+            def.upperAngle = p[7];
+            def.enableMotor = p[8] != 0.0f;
+            def.motorSpeed = p[9];
+            def.maxMotorTorque = p[10];
+            return setBase(&def);
+        }
+
+        case b2JointType::PRISMATIC_JOINT:
+        {
+            b2PrismaticJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.localAxisA = vec(4);
+            def.referenceAngle = p[6];
+            def.enableLimit = p[7] != 0.0f;
+            def.lowerTranslation = p[8];
+            def.upperTranslation = p[9];
+            def.enableMotor = p[10] != 0.0f;
+            def.maxMotorForce = p[11];
+            def.motorSpeed = p[12];
+            return setBase(&def);
+        }
+
+        case b2JointType::DISTANCE_JOINT:
+        {
+            b2DistanceJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.length = p[4];
+            def.frequencyHz = p[5];
+            def.dampingRatio = p[6];
+            return setBase(&def);
+        }
+
+        case b2JointType::PULLEY_JOINT:
+        {
+            b2PulleyJointDef def;
+            def.groundAnchorA = vec(0);
+            def.groundAnchorB = vec(2);
+            def.localAnchorA = vec(4);
+            def.localAnchorB = vec(6);
+            def.lengthA = p[8];
+            def.lengthB = p[9];
+            def.ratio = p[10];
+            return setBase(&def);
+        }
+
+        case b2JointType::MOUSE_JOINT:
+        {
+            b2MouseJointDef def;
+            def.target = vec(0);
+            def.maxForce = p[2];
+            def.frequencyHz = p[3];
+            def.dampingRatio = p[4];
+            return setBase(&def);
+        }
+
+        case b2JointType::GEAR_JOINT:
+        {
+            if (joint1 == nullptr || joint2 == nullptr)
+            {
+                return nullptr;
+            }
+            b2GearJointDef def;
+            def.joint1 = joint1;
+            def.joint2 = joint2;
+            def.ratio = p[0];
+            return setBase(&def);
+        }
+
+        case b2JointType::WHEEL_JOINT:
+        {
+            b2WheelJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.localAxisA = vec(4);
+            def.enableMotor = p[6] != 0.0f;
+            def.maxMotorTorque = p[7];
+            def.motorSpeed = p[8];
+            def.frequencyHz = p[9];
+            def.dampingRatio = p[10];
+            return setBase(&def);
+        }
+
+        case b2JointType::WELD_JOINT:
+        {
+            b2WeldJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.referenceAngle = p[4];
+            def.frequencyHz = p[5];
+            def.dampingRatio = p[6];
+            return setBase(&def);
+        }
+
+        case b2JointType::FRICTION_JOINT:
+        {
+            b2FrictionJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.maxForce = p[4];
+            def.maxTorque = p[5];
+            return setBase(&def);
+        }
+
+        case b2JointType::ROPE_JOINT:
+        {
+            b2RopeJointDef def;
+            def.localAnchorA = vec(0);
+            def.localAnchorB = vec(2);
+            def.maxLength = p[4];
+            return setBase(&def);
+        }
+
+        case b2JointType::MOTOR_JOINT:
+        {
+            b2MotorJointDef def;
+            def.linearOffset = vec(0);
+            def.angularOffset = p[2];
+            def.maxForce = p[3];
+            def.maxTorque = p[4];
+            def.correctionFactor = p[5];
+            return setBase(&def);
+        }
+
+        default:
+            return nullptr;
+    }
+}
+
+b2Recorder::b2Recorder() :
+    m_world{},
+    m_stepCount{},
+    m_nextBodyId{},
+    m_nextFixtureId{},
+    m_nextJointId{},
+    m_gravity{{0.0f, 0.0f}},
+    m_settings{}
+{
+}
+
+b2Recorder::~b2Recorder()
+{
+    End();
+}
+
+void b2Recorder::Begin(b2World* world)
+{
+    b2Assert(world->m_recorder == nullptr || world->m_recorder == this);
+    End();
+
+    m_world = world;
+    world->m_recorder = this;
+
+    m_data.clear();
+    m_stepCount = 0;
+    m_nextBodyId = 0;
+    m_nextFixtureId = 0;
+    m_nextJointId = 0;
+
+    Write(b2_captureMagic);
+    Write(b2_captureVersion);
+
+    m_gravity = world->GetGravity();
+    m_settings = b2GetSettings(world);
+    Write(e_recordSettings);
+    Write(m_gravity);
+    Write(m_settings);
+
+    // The world lists are in reverse order of creation. Write them in order of creation,
+    // so the replay builds the same lists.
+    std::vector<const b2Body*> bodies;
+    for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+    {
+        bodies.push_back(b);
+    }
+
+    std::vector<const b2Fixture*> fixtures;
+    for (auto b = bodies.rbegin(); b != bodies.rend(); ++b)
+    {
+        BodyCreated(*b);
+
+        fixtures.clear();
+        for (const b2Fixture* f = (*b)->GetFixtureList(); f; f = f->GetNext())
+        {
+            fixtures.push_back(f);
+        }
+        for (auto f = fixtures.rbegin(); f != fixtures.rend(); ++f)
+        {
+            FixtureCreated(*f);
+        }
+    }
+
+    std::vector<b2Joint*> joints;
+    for (b2Joint* j = world->GetJointList(); j; j = j->GetNext())
+    {
+        joints.push_back(j);
+    }
+    for (auto j = joints.rbegin(); j != joints.rend(); ++j)
+    {
+        JointCreated(*j);
+    }
+}
+
+void b2Recorder::End()
+{
+    if (m_world)
+    {
+        m_world->m_recorder = nullptr;
+        m_world = nullptr;
+    }
+
+    m_bodies.clear();
+    m_fixtures.clear();
+    m_joints.clear();
+}
+
+bool b2Recorder::Save(const char* path) const
+{
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = fwrite(m_data.data(), 1, m_data.size(), file) == m_data.size();
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+void b2Recorder::Write(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
+void b2Recorder::GetState(const b2Body* body, b2RecordedBody* state)
+{
+    uint8_t flags = static_cast<uint8_t>(body->GetType());
+    flags |= body->IsAwake() ? e_bodyAwake : 0;
+    flags |= body->IsActive() ? e_bodyActive : 0;
+    flags |= body->IsFixedRotation() ? e_bodyFixedRotation : 0;
+    flags |= body->IsBullet() ? e_bodyBullet : 0;
+    flags |= body->IsSleepingAllowed() ? e_bodySleepingAllowed : 0;
+    flags |= body->IsSpeculative() ? e_bodySpeculative : 0;
+    state->flags = flags;
+
+    const b2BodyState& bodyState = body->GetState();
+    state->transform[0] = body->m_xf.p[b2VecX];
+    state->transform[1] = body->m_xf.p[b2VecY];
+    state->transform[2] = bodyState.sweep.a;
+    state->velocity[0] = bodyState.linearVelocity[b2VecX];
+    state->velocity[1] = bodyState.linearVelocity[b2VecY];
+    state->velocity[2] = bodyState.angularVelocity;
+    state->force[0] = bodyState.force[b2VecX];
+    state->force[1] = bodyState.force[b2VecY];
+    state->force[2] = bodyState.torque;
+    state->sleepTime = body->m_sleepTime;
+    state->damping[0] = body->m_linearDamping;
+    state->damping[1] = body->m_angularDamping;
+    state->gravityScale = body->m_gravityScale;
+}
+
+void b2Recorder::BodyCreated(const b2Body* body)
+{
+    b2RecordedBody& state = m_bodies[body];
+    state.id = m_nextBodyId++;
+    GetState(body, &state);
+
+    Write(e_recordCreateBody);
+    Write(state);
+}
+
+void b2Recorder::BodyDestroyed(const b2Body* body)
+{
+    auto it = m_bodies.find(body);
+    b2Assert(it != m_bodies.end());
+
+    Write(e_recordDestroyBody);
+    Write(it->second.id);
+    m_bodies.erase(it);
+
+    // The world destroys the fixtures with the body. The joints are already destroyed.
+    for (const b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext())
+    {
+        m_fixtures.erase(f);
+    }
+}
+
+void b2Recorder::FixtureCreated(const b2Fixture* fixture)
+{
+    uint32_t id = m_nextFixtureId++;
+    m_fixtures[fixture] = id;
+
+    Write(e_recordCreateFixture);
+    Write(id);
+    Write(m_bodies.at(fixture->GetBody()).id);
+    Write(fixture->GetFriction());
+    Write(fixture->GetRestitution());
+    Write(fixture->GetDensity());
+    Write(static_cast<uint8_t>(fixture->IsSensor()));
+    Write(fixture->GetFilterData().categoryBits);
+    Write(fixture->GetFilterData().maskBits);
+    Write(fixture->GetFilterData().groupIndex);
+
+    const b2Shape* shape = fixture->GetShape();
+    Write(static_cast<uint8_t>(shape->GetType()));
+    Write(shape->GetRadius());
+    switch (shape->GetType())
+    {
+        case b2Shape::e_circle:
+        {
+            auto circle = static_cast<const b2CircleShape*>(shape);
+            Write(circle->m_p);
+        }
+        break;
+
+        case b2Shape::e_edge:
+        {
+            auto edge = static_cast<const b2EdgeShape*>(shape);
+            Write(edge->m_vertex0);
+            Write(edge->m_vertex1);
+            Write(edge->m_vertex2);
+            Write(edge->m_vertex3);
+            Write(static_cast<uint8_t>(edge->m_hasVertex0));
+            Write(static_cast<uint8_t>(edge->m_hasVertex3));
+        }
+        break;
+
+        case b2Shape::e_polygon:
+        {
+            // The vertices are written as they are, since b2PolygonShape::Set may
+            // reorder them.
+            auto polygon = static_cast<const b2PolygonShape*>(shape);
+            int32_t count = polygon->GetVertexCount();
+            Write(count);
+            Write(polygon->GetCentroid());
+            Write(polygon->GetVertices().data(), count * sizeof(b2Vec<float, 2>));
+            Write(polygon->GetNormals().data(), count * sizeof(b2Vec<float, 2>));
+        }
+        break;
+
+        case b2Shape::e_chain:
+        {
+            auto chain = static_cast<const b2ChainShape*>(shape);
+            Write(chain->m_count);
+            Write(chain->m_vertices, chain->m_count * sizeof(b2Vec<float, 2>));
+            Write(chain->m_prevVertex);
+            Write(chain->m_nextVertex);
+            Write(static_cast<uint8_t>(chain->m_hasPrevVertex));
+            Write(static_cast<uint8_t>(chain->m_hasNextVertex));
+            Write(static_cast<uint8_t>(chain->GetLocalTree() != nullptr));
+        }
+        break;
+
+        default:
+            b2Assert(false);
+            break;
+    }
+}
+
+void b2Recorder::FixtureDestroyed(const b2Fixture* fixture)
+{
+    auto it = m_fixtures.find(fixture);
+    b2Assert(it != m_fixtures.end());
+
+    Write(e_recordDestroyFixture);
+    Write(it->second);
+    m_fixtures.erase(it);
+}
+
+void b2Recorder::JointCreated(b2Joint* joint)
+{
+    b2RecordedJoint& state = m_joints[joint];
+    state.id = m_nextJointId++;
+    state.count = b2GetJointParams(joint, state.params.data());
+
+    Write(e_recordCreateJoint);
+    Write(state.id);
+    Write(static_cast<uint8_t>(joint->GetType()));
+    Write(m_bodies.at(joint->GetBodyA()).id);
+    Write(m_bodies.at(joint->GetBodyB()).id);
+    Write(static_cast<uint8_t>(joint->GetCollideConnected()));
+    if (joint->GetType() == b2JointType::GEAR_JOINT)
+    {
+        auto gear = static_cast<b2GearJoint*>(joint);
+        Write(m_joints.at(gear->GetJoint1()).id);
+        Write(m_joints.at(gear->GetJoint2()).id);
+    }
+    Write(state.count);
+    Write(state.params.data(), state.count * sizeof(float));
+}
+
+void b2Recorder::JointDestroyed(const b2Joint* joint)
+{
+    auto it = m_joints.find(joint);
+    b2Assert(it != m_joints.end());
+
+    Write(e_recordDestroyJoint);
+    Write(it->second.id);
+    m_joints.erase(it);
+}
+
+void b2Recorder::Flush()
+{
+    b2Vec<float, 2> gravity = m_world->GetGravity();
+    uint8_t settings = b2GetSettings(m_world);
+    if (std::memcmp(&gravity, &m_gravity, sizeof(gravity)) != 0 || settings != m_settings)
+    {
+        m_gravity = gravity;
+        m_settings = settings;
+        Write(e_recordSettings);
+        Write(m_gravity);
+        Write(m_settings);
+    }
+
+    for (const b2Body* b = m_world->GetBodyList(); b; b = b->GetNext())
+    {
+        b2RecordedBody& last = m_bodies.at(b);
+        b2RecordedBody state;
+        GetState(b, &state);
+
+        auto changed = [&](const void* p, const void* q, size_t size) {
+            return std::memcmp(p, q, size) != 0;
+        };
+
+        uint8_t mask = 0;
+        mask |= state.flags != last.flags ? e_stateFlags : 0;
+        mask |= changed(state.transform, last.transform, sizeof(state.transform)) ?
+                    e_stateTransform : 0;
+        mask |= changed(state.velocity, last.velocity, sizeof(state.velocity)) ?
+                    e_stateVelocity : 0;
+        mask |= changed(state.force, last.force, sizeof(state.force)) ? e_stateForce : 0;
+        mask |= changed(&state.sleepTime, &last.sleepTime, sizeof(float)) ? e_stateSleep : 0;
+        mask |= changed(state.damping, last.damping, sizeof(state.damping)) ? e_stateDamping : 0;
+        mask |= changed(&state.gravityScale, &last.gravityScale, sizeof(float)) ?
+                    e_stateGravity : 0;
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        Write(e_recordBodyState);
+        Write(last.id);
+        Write(mask);
+        if (mask & e_stateFlags)
+        {
+            Write(state.flags);
+        }
+        if (mask & e_stateTransform)
+        {
+            Write(state.transform);
+        }
+        if (mask & e_stateVelocity)
+        {
+            Write(state.velocity);
+        }
+        if (mask & e_stateForce)
+        {
+            Write(state.force);
+        }
+        if (mask & e_stateSleep)
+        {
+            Write(state.sleepTime);
+        }
+        if (mask & e_stateDamping)
+        {
+            Write(state.damping);
+        }
+        if (mask & e_stateGravity)
+        {
+            Write(state.gravityScale);
+        }
+
+        state.id = last.id;
+        last = state;
+    }
+
+    for (b2Joint* j = m_world->GetJointList(); j; j = j->GetNext())
+    {
+        b2RecordedJoint& last = m_joints.at(j);
+        float params[16];
+        b2GetJointParams(j, params);
+        if (std::memcmp(params, last.params.data(), last.count * sizeof(float)) == 0)
+        {
+            continue;
+        }
+
+        std::copy(params, params + last.count, last.params.begin());
+        Write(e_recordJointState);
+        Write(last.id);
+        Write(last.params.data(), last.count * sizeof(float));
+    }
+}
+
+void b2Recorder::StepBegin(float dt, int32_t velocityIterations, int32_t positionIterations)
+{
+    Flush();
+
+    Write(e_recordStep);
+    Write(dt);
+    Write(velocityIterations);
+    Write(positionIterations);
+    ++m_stepCount;
+}
+
+void b2Recorder::StepEnd()
+{
+    // The step moves the bodies, only the changes made after it are inputs.
+    for (const b2Body* b = m_world->GetBodyList(); b; b = b->GetNext())
+    {
+        b2RecordedBody& state = m_bodies.at(b);
+        GetState(b, &state);
+    }
+}
+
+void b2Recorder::ShiftOrigin(const b2Vec<float, 2>& newOrigin)
+{
+    Flush();
+
+    Write(e_recordShiftOrigin);
+    Write(newOrigin);
+
+    // Shift the bodies the same way the world does.
+    for (auto& entry : m_bodies)
+    {
+        entry.second.transform[0] -= newOrigin[b2VecX];
+        entry.second.transform[1] -= newOrigin[b2VecY];
+    }
+}
+
+void b2Recorder::Compact()
+{
+    // Compacting renumbers the proxies, which changes the order of the new pairs.
+    Flush();
+    Write(e_recordCompact);
+}
+
+void b2Recorder::Reset()
+{
+    Write(e_recordReset);
+    m_bodies.clear();
+    m_fixtures.clear();
+    m_joints.clear();
+}
+
+b2Replay::b2Replay() : m_offset{}, m_valid{}, m_stepIndex{}
+{
+}
+
+b2Replay::~b2Replay()
+{
+}
+
+bool b2Replay::Load(const std::vector<uint8_t>& data)
+{
+    m_data = data;
+    m_offset = 0;
+    m_valid = true;
+    m_stepIndex = 0;
+    m_bodies.clear();
+    m_fixtures.clear();
+    m_joints.clear();
+    m_world.reset();
+
+    char magic[4];
+    uint32_t version;
+    if (Read(magic, sizeof(magic)) == false || std::memcmp(magic, b2_captureMagic, 4) != 0 ||
+        Read(&version) == false || version != b2_captureVersion)
+    {
+        return false;
+    }
+
+    m_world.reset(new b2World(b2Vec<float, 2>{{0.0f, 0.0f}}));
+    Apply();
+    return m_valid;
+}
+
+bool b2Replay::Load(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+    bool ok = ferror(file) == 0;
+    fclose(file);
+
+    return ok && Load(data);
+}
+
+bool b2Replay::Read(void* data, size_t size)
+{
+    if (m_offset + size > m_data.size())
+    {
+        m_valid = false;
+        return false;
+    }
+
+    std::memcpy(data, m_data.data() + m_offset, size);
+    m_offset += size;
+    return true;
+}
+
+bool b2Replay::Step()
+{
+    if (m_world == nullptr || Apply() == false)
+    {
+        return false;
+    }
+
+    uint8_t tag;
+    float dt;
+    int32_t velocityIterations, positionIterations;
+    if (Read(&tag) == false || Read(&dt) == false || Read(&velocityIterations) == false ||
+        Read(&positionIterations) == false)
+    {
+        return false;
+    }
+
+    m_world->Step(dt, velocityIterations, positionIterations);
+    ++m_stepIndex;
+    return true;
+}
+
+bool b2Replay::Apply()
+{
+    while (m_valid && m_offset < m_data.size())
+    {
+        uint8_t tag = m_data[m_offset];
+        if (tag == e_recordStep)
+        {
+            return true;
+        }
+        ++m_offset;
+
+        uint32_t id;
+        switch (tag)
+        {
+            case e_recordSettings:
+                ReadSettings();
+                break;
+
+            case e_recordCreateBody:
+                ReadBody();
+                break;
+
+            case e_recordDestroyBody:
+                if (Read(&id) && id < m_bodies.size() && m_bodies[id])
+                {
+                    m_world->DestroyBody(m_bodies[id]);
+                    m_bodies[id] = nullptr;
+                }
+                else
+                {
+                    m_valid = false;
+                }
+                break;
+
+            case e_recordBodyState:
+                ReadBodyState();
+                break;
+
+            case e_recordCreateFixture:
+                ReadFixture();
+                break;
+
+            case e_recordDestroyFixture:
+                if (Read(&id) && id < m_fixtures.size() && m_fixtures[id])
+                {
+                    m_fixtures[id]->GetBody()->DestroyFixture(m_fixtures[id]);
+                    m_fixtures[id] = nullptr;
+                }
+                else
+                {
+                    m_valid = false;
+                }
+                break;
+
+            case e_recordCreateJoint:
+                ReadJoint();
+                break;
+
+            case e_recordDestroyJoint:
+                if (Read(&id) && id < m_joints.size() && m_joints[id])
+                {
+                    m_world->DestroyJoint(m_joints[id]);
+                    m_joints[id] = nullptr;
+                }
+                else
+                {
+                    m_valid = false;
+                }
+                break;
+
+            case e_recordJointState:
+                ReadJointState();
+                break;
+
+            case e_recordShiftOrigin:
+            {
+                b2Vec<float, 2> newOrigin;
+                if (Read(&newOrigin))
+                {
+                    m_world->ShiftOrigin(newOrigin);
+                }
+            }
+            break;
+
+            case e_recordCompact:
+                m_world->Compact();
+                break;
+
+            case e_recordReset:
+                m_world->Reset(false);
+                std::fill(m_bodies.begin(), m_bodies.end(), nullptr);
+                std::fill(m_fixtures.begin(), m_fixtures.end(), nullptr);
+                std::fill(m_joints.begin(), m_joints.end(), nullptr);
+                break;
+
+            default:
+                m_valid = false;
+                break;
+        }
+    }
+
+    return false;
+}
+
+bool b2Replay::ReadSettings()
+{
+    b2Vec<float, 2> gravity;
+    uint8_t settings;
+    if (Read(&gravity) == false || Read(&settings) == false)
+    {
+        return false;
+    }
+
+    m_world->SetGravity(gravity);
+    m_world->SetAllowSleeping((settings & e_worldAllowSleep) != 0);
+    m_world->SetWarmStarting((settings & e_worldWarmStarting) != 0);
+    m_world->SetContinuousPhysics((settings & e_worldContinuous) != 0);
+    m_world->SetSubStepping((settings & e_worldSubStepping) != 0);
+    m_world->SetAnalyticTOI((settings & e_worldAnalyticTOI) != 0);
+    m_world->SetSpeculativeContacts((settings & e_worldSpeculative) != 0);
+    m_world->SetAutoClearForces((settings & e_worldClearForces) != 0);
+    return true;
+}
+
+void b2Replay::SetState(b2Body* body, const b2RecordedBody& state, uint8_t mask)
+{
+    // The flags go first, their setters have side effects that the recorded values undo.
+    // The awake flag goes last, as the other setters may wake the body.
+    if (mask & e_stateFlags)
+    {
+        b2BodyType type = static_cast<b2BodyType>(state.flags & e_bodyTypeMask);
+        if (body->GetType() != type)
+        {
+            body->SetType(type);
+        }
+        if (body->IsActive() != ((state.flags & e_bodyActive) != 0))
+        {
+            body->SetActive((state.flags & e_bodyActive) != 0);
+        }
+        if (body->IsFixedRotation() != ((state.flags & e_bodyFixedRotation) != 0))
+        {
+            body->SetFixedRotation((state.flags & e_bodyFixedRotation) != 0);
+        }
+        if (body->IsBullet() != ((state.flags & e_bodyBullet) != 0))
+        {
+            body->SetBullet((state.flags & e_bodyBullet) != 0);
+        }
+        if (body->IsSleepingAllowed() != ((state.flags & e_bodySleepingAllowed) != 0))
+        {
+            body->SetSleepingAllowed((state.flags & e_bodySleepingAllowed) != 0);
+        }
+        if (body->IsSpeculative() != ((state.flags & e_bodySpeculative) != 0))
+        {
+            body->SetSpeculative((state.flags & e_bodySpeculative) != 0);
+        }
+        if (body->IsAwake() != ((state.flags & e_bodyAwake) != 0))
+        {
+            body->SetAwake((state.flags & e_bodyAwake) != 0);
+        }
+    }
+
+    if (mask & e_stateTransform)
+    {
+        body->SetTransform({{state.transform[0], state.transform[1]}}, state.transform[2]);
+    }
+
+    if (mask & e_stateVelocity)
+    {
+        body->GetState().linearVelocity = {{state.velocity[0], state.velocity[1]}};
+        body->GetState().angularVelocity = state.velocity[2];
+    }
+
+    if (mask & e_stateForce)
+    {
+        body->GetState().force = {{state.force[0], state.force[1]}};
+        body->GetState().torque = state.force[2];
+    }
+
+    if (mask & e_stateSleep)
+    {
+        body->m_sleepTime = state.sleepTime;
+    }
+
+    if (mask & e_stateDamping)
+    {
+        body->m_linearDamping = state.damping[0];
+        body->m_angularDamping = state.damping[1];
+    }
+
+    if (mask & e_stateGravity)
+    {
+        body->m_gravityScale = state.gravityScale;
+    }
+}
+
+bool b2Replay::ReadBody()
+{
+    b2RecordedBody state;
+    if (Read(&state) == false || state.id != m_bodies.size())
+    {
+        m_valid = false;
+        return false;
+    }
+
+    b2BodyDef def;
+    def.type = static_cast<b2BodyType>(state.flags & e_bodyTypeMask);
+    def.position = {{state.transform[0], state.transform[1]}};
+    def.angle = state.transform[2];
+    def.linearVelocity = {{state.velocity[0], state.velocity[1]}};
+    def.angularVelocity = state.velocity[2];
+    def.linearDamping = state.damping[0];
+    def.angularDamping = state.damping[1];
+    def.allowSleep = (state.flags & e_bodySleepingAllowed) != 0;
+    def.awake = (state.flags & e_bodyAwake) != 0;
+    def.fixedRotation = (state.flags & e_bodyFixedRotation) != 0;
+    def.bullet = (state.flags & e_bodyBullet) != 0;
+    def.speculative = (state.flags & e_bodySpeculative) != 0;
+    def.active = (state.flags & e_bodyActive) != 0;
+    def.gravityScale = state.gravityScale;
+
+    b2Body* body = m_world->CreateBody(&def);
+    SetState(body, state, e_stateVelocity | e_stateForce | e_stateSleep);
+    m_bodies.push_back(body);
+    return true;
+}
+
+bool b2Replay::ReadBodyState()
+{
+    uint32_t id;
+    uint8_t mask;
+    if (Read(&id) == false || Read(&mask) == false || id >= m_bodies.size() ||
+        m_bodies[id] == nullptr)
+    {
+        m_valid = false;
+        return false;
+    }
+
+    b2RecordedBody state;
+    bool ok = true;
+    if (mask & e_stateFlags)
+    {
+        ok = ok && Read(&state.flags);
+    }
+    if (mask & e_stateTransform)
+    {
+        ok = ok && Read(&state.transform);
+    }
+    if (mask & e_stateVelocity)
+    {
+        ok = ok && Read(&state.velocity);
+    }
+    if (mask & e_stateForce)
+    {
+        ok = ok && Read(&state.force);
+    }
+    if (mask & e_stateSleep)
+    {
+        ok = ok && Read(&state.sleepTime);
+    }
+    if (mask & e_stateDamping)
+    {
+        ok = ok && Read(&state.damping);
+    }
+    if (mask & e_stateGravity)
+    {
+        ok = ok && Read(&state.gravityScale);
+    }
+    if (ok == false)
+    {
+        return false;
+    }
+
+    SetState(m_bodies[id], state, mask);
+    return true;
+}
+
+bool b2Replay::ReadFixture()
+{
+    uint32_t id, bodyId;
+    b2FixtureDef def;
+    uint8_t isSensor, type;
+    float radius;
+    if (Read(&id) == false || Read(&bodyId) == false || Read(&def.friction) == false ||
+        Read(&def.restitution) == false || Read(&def.density) == false ||
+        Read(&isSensor) == false || Read(&def.filter.categoryBits) == false ||
+        Read(&def.filter.maskBits) == false || Read(&def.filter.groupIndex) == false ||
+        Read(&type) == false || Read(&radius) == false)
+    {
+        return false;
+    }
+
+    if (id != m_fixtures.size() || bodyId >= m_bodies.size() || m_bodies[bodyId] == nullptr)
+    {
+        m_valid = false;
+        return false;
+    }
+    def.isSensor = isSensor != 0;
+
+    b2CircleShape circle;
+    b2EdgeShape edge;
+    b2PolygonShape polygon;
+    b2ChainShape chain;
+    bool ok = true;
+    switch (type)
+    {
+        case b2Shape::e_circle:
+            ok = Read(&circle.m_p);
+            circle.SetRadius(radius);
+            def.shape = &circle;
+            break;
+
+        case b2Shape::e_edge:
+        {
+            uint8_t hasVertex0, hasVertex3;
+            ok = Read(&edge.m_vertex0) && Read(&edge.m_vertex1) && Read(&edge.m_vertex2) &&
+                 Read(&edge.m_vertex3) && Read(&hasVertex0) && Read(&hasVertex3);
+            edge.m_hasVertex0 = hasVertex0 != 0;
+            edge.m_hasVertex3 = hasVertex3 != 0;
+            edge.SetRadius(radius);
+            def.shape = &edge;
+        }
+        break;
+
+        case b2Shape::e_polygon:
+        {
+            int32_t count;
+            ok = Read(&count) && count >= 3 && count <= MAX_POLYGON_VERTICES &&
+                 Read(&polygon.m_centroid);
+            if (ok)
+            {
+                polygon.m_vertices.resize(count);
+                polygon.m_normals.resize(count);
+                ok = Read(polygon.m_vertices.data(), count * sizeof(b2Vec<float, 2>)) &&
+                     Read(polygon.m_normals.data(), count * sizeof(b2Vec<float, 2>));
+            }
+            polygon.SetRadius(radius);
+            def.shape = &polygon;
+        }
+        break;
+
+        case b2Shape::e_chain:
+        {
+            int32_t count;
+            b2Vec<float, 2> prevVertex, nextVertex;
+            uint8_t hasPrevVertex, hasNextVertex, localTree;
+            ok = Read(&count) && count >= 2 &&
+                 m_offset + count * sizeof(b2Vec<float, 2>) <= m_data.size();
+            if (ok)
+            {
+                std::vector<b2Vec<float, 2>> vertices(count);
+                ok = Read(vertices.data(), count * sizeof(b2Vec<float, 2>)) &&
+                     Read(&prevVertex) && Read(&nextVertex) && Read(&hasPrevVertex) &&
+                     Read(&hasNextVertex) && Read(&localTree);
+                if (ok)
+                {
+                    chain.SetLocalTree(localTree != 0);
+                    chain.CreateChain(vertices.data(), count);
+                    if (hasPrevVertex)
+                    {
+                        chain.SetPrevVertex(prevVertex);
+                    }
+                    if (hasNextVertex)
+                    {
+                        chain.SetNextVertex(nextVertex);
+                    }
+                }
+            }
+            chain.SetRadius(radius);
+            def.shape = &chain;
+        }
+        break;
+
+        default:
+            ok = false;
+            break;
+    }
+
+    if (ok == false)
+    {
+        m_valid = false;
+        return false;
+    }
+
+    m_fixtures.push_back(m_bodies[bodyId]->CreateFixture(&def));
+    return true;
+}
+
+bool b2Replay::ReadJoint()
+{
+    uint32_t id, bodyA, bodyB;
+    uint8_t type, collideConnected;
+    if (Read(&id) == false || Read(&type) == false || Read(&bodyA) == false ||
+        Read(&bodyB) == false || Read(&collideConnected) == false)
+    {
+        return false;
+    }
+
+    b2Joint* joint1 = nullptr;
+    b2Joint* joint2 = nullptr;
+    if (type == static_cast<uint8_t>(b2JointType::GEAR_JOINT))
+    {
+        uint32_t id1, id2;
+        if (Read(&id1) == false || Read(&id2) == false)
+        {
+            return false;
+        }
+        joint1 = id1 < m_joints.size() ? m_joints[id1] : nullptr;
+        joint2 = id2 < m_joints.size() ? m_joints[id2] : nullptr;
+    }
+
+    int32_t count;
+    float params[16];
+    if (Read(&count) == false || count < 0 || count > 16 ||
+        Read(params, count * sizeof(float)) == false)
+    {
+        m_valid = false;
+        return false;
+    }
+
+    if (id != m_joints.size() || bodyA >= m_bodies.size() || bodyB >= m_bodies.size() ||
+        m_bodies[bodyA] == nullptr || m_bodies[bodyB] == nullptr)
+    {
+        m_valid = false;
+        return false;
+    }
+
+    b2Joint* joint = b2CreateJoint(m_world.get(), static_cast<b2JointType>(type),
+                                   m_bodies[bodyA], m_bodies[bodyB], collideConnected != 0,
+                                   joint1, joint2, params);
+    if (joint == nullptr)
+    {
+        m_valid = false;
+        return false;
+    }
+
+    m_joints.push_back(joint);
+    return true;
+}
+
+bool b2Replay::ReadJointState()
+{
+    uint32_t id;
+    if (Read(&id) == false || id >= m_joints.size() || m_joints[id] == nullptr)
+    {
+        m_valid = false;
+        return false;
+    }
+
+    float params[16];
+    int32_t count = b2GetJointParams(m_joints[id], params);
+    if (Read(params, count * sizeof(float)) == false)
+    {
+        return false;
+    }
+
+    b2SetJointParams(m_joints[id], params);
+    return true;
+}
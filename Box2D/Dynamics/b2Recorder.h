@@ -0,0 +1,220 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_RECORDER_H
+#define B2_RECORDER_H
+
+#include <Box2D/Common/b2Math.h>
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace box2d
+{
+class b2Body;
+class b2Fixture;
+class b2Joint;
+class b2World;
+
+/// The state of a body that the user may change between steps. This is an internal
+/// structure.
+struct b2RecordedBody
+{
+    uint32_t id;
+    uint8_t flags;             // type and the boolean body flags
+    float transform[3];        // position and angle
+    float velocity[3];         // linear and angular
+    float force[3];            // force and torque
+    float sleepTime;
+    float damping[2];          // linear and angular
+    float gravityScale;
+};
+
+/// The parameters of a joint, in the order of its definition. This is an internal
+/// structure.
+struct b2RecordedJoint
+{
+    uint32_t id;
+    int32_t count;
+    std::array<float, 16> params;
+};
+
+/// Records a world into a compact binary capture that b2Replay runs again, headless.
+/// The capture starts with the state of the world, then holds the bodies, fixtures and
+/// joints created and destroyed, and before each step the bodies and joints the user
+/// changed: forces, impulses and velocities, transforms, flags, joint motors and limits,
+/// as well as gravity and the world settings.
+///
+/// A capture that begins before the first body is created replays exactly. A capture
+/// that begins later rebuilds the bodies, fixtures and joints, but not the contacts
+/// and their warm starting impulses, so the replay drifts from the original. Fixture
+/// filters, sensors, materials and mass data set by hand are not recorded. The data
+/// uses the byte order of the host.
+class b2Recorder
+{
+public:
+    b2Recorder();
+    ~b2Recorder();
+
+    b2Recorder(const b2Recorder&) = delete;
+    b2Recorder& operator=(const b2Recorder&) = delete;
+
+    /// Start recording a world, discarding any previous capture. The world must not be
+    /// recorded by another recorder.
+    void Begin(b2World* world);
+
+    /// Stop recording. The capture is kept. Called by the world destructor.
+    void End();
+
+    /// Is a world being recorded.
+    bool IsRecording() const
+    {
+        return m_world != nullptr;
+    }
+
+    /// Get the number of steps recorded.
+    int32_t GetStepCount() const
+    {
+        return m_stepCount;
+    }
+
+    /// Get the capture.
+    const std::vector<uint8_t>& GetData() const
+    {
+        return m_data;
+    }
+
+    /// Write the capture to a file.
+    /// @return false if the file could not be written.
+    bool Save(const char* path) const;
+
+private:
+    friend class b2World;
+    friend class b2Body;
+
+    // Called by the world and the bodies.
+    void BodyCreated(const b2Body* body);
+    void BodyDestroyed(const b2Body* body);
+    void FixtureCreated(const b2Fixture* fixture);
+    void FixtureDestroyed(const b2Fixture* fixture);
+    void JointCreated(b2Joint* joint);
+    void JointDestroyed(const b2Joint* joint);
+    void StepBegin(float dt, int32_t velocityIterations, int32_t positionIterations);
+    void StepEnd();
+    void ShiftOrigin(const b2Vec<float, 2>& newOrigin);
+    void Compact();
+    void Reset();
+
+    // Write the changes made since the last step.
+    void Flush();
+
+    static void GetState(const b2Body* body, b2RecordedBody* state);
+
+    void Write(const void* data, size_t size);
+    template <typename T>
+    void Write(const T& value)
+    {
+        Write(&value, sizeof(T));
+    }
+
+    b2World* m_world;
+    std::vector<uint8_t> m_data;
+    int32_t m_stepCount;
+
+    uint32_t m_nextBodyId;
+    uint32_t m_nextFixtureId;
+    uint32_t m_nextJointId;
+    std::unordered_map<const b2Body*, b2RecordedBody> m_bodies;
+    std::unordered_map<const b2Fixture*, uint32_t> m_fixtures;
+    std::unordered_map<const b2Joint*, b2RecordedJoint> m_joints;
+
+    b2Vec<float, 2> m_gravity;
+    uint8_t m_settings;
+};
+
+/// Runs a capture made by b2Recorder. The world is created by Load and is owned by the
+/// replay.
+class b2Replay
+{
+public:
+    b2Replay();
+    ~b2Replay();
+
+    b2Replay(const b2Replay&) = delete;
+    b2Replay& operator=(const b2Replay&) = delete;
+
+    /// Load a capture and build the recorded world, without stepping it.
+    /// @return false if the data is not a capture.
+    bool Load(const std::vector<uint8_t>& data);
+
+    /// Load a capture from a file.
+    /// @return false if the file could not be read or is not a capture.
+    bool Load(const char* path);
+
+    /// Apply the recorded changes of the next step and take the step.
+    /// @return false at the end of the capture, or if the capture is damaged.
+    bool Step();
+
+    /// Get the number of steps taken.
+    int32_t GetStepIndex() const
+    {
+        return m_stepIndex;
+    }
+
+    /// Get the replayed world, null until a capture is loaded.
+    b2World* GetWorld()
+    {
+        return m_world.get();
+    }
+
+private:
+    // Apply the records up to the next step record.
+    // Returns false at the end of the capture or if it is damaged.
+    bool Apply();
+
+    bool Read(void* data, size_t size);
+    template <typename T>
+    bool Read(T* value)
+    {
+        return Read(value, sizeof(T));
+    }
+
+    bool ReadBody();
+    bool ReadBodyState();
+    bool ReadFixture();
+    bool ReadJoint();
+    bool ReadJointState();
+    bool ReadSettings();
+
+    static void SetState(b2Body* body, const b2RecordedBody& state, uint8_t mask);
+
+    std::unique_ptr<b2World> m_world;
+    std::vector<uint8_t> m_data;
+    size_t m_offset;
+    bool m_valid;
+    int32_t m_stepIndex;
+
+    std::vector<b2Body*> m_bodies;
+    std::vector<b2Fixture*> m_fixtures;
+    std::vector<b2Joint*> m_joints;
+};
+}
+
+#endif
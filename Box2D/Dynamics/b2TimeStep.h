@@ -20,9 +20,25 @@
 #define B2_TIME_STEP_H
 
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Collision/b2TimeOfImpact.h>
+#include <Box2D/Collision/b2BroadPhaseStats.h>
+#include <Box2D/Common/b2PerfCounters.h>
 
 namespace box2d
 {
+/// Hardware counts of the step phases, see b2World::SetPerfCounters.
+struct b2PhaseCounters
+{
+    b2PerfSample step;
+    b2PerfSample collide;
+    b2PerfSample solve;
+    b2PerfSample solveInit;
+    b2PerfSample solveVelocity;
+    b2PerfSample solvePosition;
+    b2PerfSample broadphase;
+    b2PerfSample solveTOI;
+};
+
 /// Profiling data. Times are in milliseconds.
 struct b2Profile
 {
@@ -34,6 +50,31 @@ struct b2Profile
     float solvePosition;
     float broadphase;
     float solveTOI;
+
+    // The hardware counts of the same phases, zero unless perf counters are attached.
+    b2PhaseCounters hardware;
+
+    // Narrow phase statistics, updated on every distance and TOI query. Define B2_NO_STATS
+    // (the BOX2D_COLLECT_STATS CMake option) to compile them out; they are then zero.
+    b2GJKStats gjk;
+    b2TOIStats toi;
+
+    // Number of times the stack allocator had to grow during the step.
+    int32_t stackFallbacks;
+
+    // Broad-phase and contact counters since the end of the previous step, including
+    // the changes made between steps.
+    b2BroadPhaseStats broadPhase;
+    int32_t contactsCreated;
+    int32_t contactsDestroyed;
+
+    // Counters of the step.
+    int32_t touchingContacts;  ///< after the narrow phase
+    int32_t awakeBodies;       ///< non-static bodies solved in islands
+    int32_t islands;
+    int32_t maxIslandBodies;   ///< bodies in the largest island, including static ones
+    int32_t positionIterations; ///< position iterations run, summed over the islands
+    int32_t unsolvedIslands;   ///< islands left with position errors after the last iteration
 };
 
 /// This is an internal structure.
@@ -20,6 +20,7 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2Island.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
@@ -32,15 +33,40 @@
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Profiler.h>
+#include <algorithm>
 #include <new>
 
 using namespace box2d;
 
-b2World::b2World(const b2Vec<float, 2>& gravity) :
+// Default definition for the gravity constructor.
+static b2WorldDef b2MakeWorldDef(const b2Vec<float, 2>& gravity)
+{
+    b2WorldDef def;
+    def.gravity = gravity;
+    return def;
+}
+
+b2World::b2World(const b2Vec<float, 2>& gravity) : b2World(b2MakeWorldDef(gravity))
+{
+}
+
+b2World::b2World(const b2WorldDef* def) : b2World(*def)
+{
+}
+
+b2World::b2World(const b2WorldDef& def) :
+    m_blockAllocator{def.memoryResource},
+    m_stackAllocator{def.memoryResource},
     m_flags{e_clearForces},
+    m_contactManager{def.memoryResource},
     m_bodyList{},
+    m_jointList{},
     m_bodyCount{},
-    m_gravity{gravity},
+    m_jointCount{},
+    m_bodyStates{b2ResourceAllocator<b2BodyState>(def.memoryResource)},
+    m_freeBodySlots{b2ResourceAllocator<int32_t>(def.memoryResource)},
+    m_gravity{def.gravity},
     m_allowSleep{true},
     m_destructionListener{},
     g_debugDraw{},
@@ -48,14 +74,28 @@ b2World::b2World(const b2Vec<float, 2>& gravity) :
     m_warmStarting{true},
     m_continuousPhysics{true},
     m_subStepping{false},
+    m_analyticTOI{true},
     m_stepComplete{true},
+    m_toiHeap{b2ResourceAllocator<b2TOIEvent>(def.memoryResource)},
+    m_toiDirty{b2ResourceAllocator<b2Contact*>(def.memoryResource)},
+    m_gjkStats{},
+    m_toiStats{},
+    m_perfCounters{},
+    m_solverListener{},
+    m_recorder{},
     m_profile{}
 {
     m_contactManager.m_allocator = &m_blockAllocator;
+    m_stackAllocator.Reserve(def.stackCapacity);
 }
 
 b2World::~b2World()
 {
+    if (m_recorder)
+    {
+        m_recorder->End();
+    }
+
     // Some shapes allocate using b2Alloc.
     b2Body* b = m_bodyList;
     while (b)
@@ -103,7 +143,7 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
         return nullptr;
     }
 
-    void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
+    void* mem = m_blockAllocator.Allocate(sizeof(b2Body), b2MemoryCategory::BODIES);
     auto b = new (mem) b2Body(def, this);
     m_bodies.emplace_back(def, this);
     auto b = m_bodies.back();
@@ -118,9 +158,27 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
     m_bodyList = b;
     ++m_bodyCount;
 
+    if (m_recorder)
+    {
+        m_recorder->BodyCreated(b);
+    }
+
     return b;
 }
 
+int32_t b2World::CreateBodyState()
+{
+    if (m_freeBodySlots.empty() == false)
+    {
+        int32_t slot = m_freeBodySlots.back();
+        m_freeBodySlots.pop_back();
+        return slot;
+    }
+
+    m_bodyStates.emplace_back();
+    return (int32_t)m_bodyStates.size() - 1;
+}
+
 void b2World::DestroyBody(b2Body* b)
 {
     b2Assert(m_bodyCount > 0);
@@ -148,6 +206,11 @@ void b2World::DestroyBody(b2Body* b)
     }
     b->m_jointList = nullptr;
 
+    if (m_recorder)
+    {
+        m_recorder->BodyDestroyed(b);
+    }
+
     // Delete the attached contacts.
     b2ContactEdge* ce = b->m_contactList;
     while (ce)
@@ -173,7 +236,7 @@ void b2World::DestroyBody(b2Body* b)
         f0->DestroyProxies(&m_contactManager.m_broadPhase);
         f0->Destroy(&m_blockAllocator);
         f0->~b2Fixture();
-        m_blockAllocator.Free(f0, sizeof(b2Fixture));
+        m_blockAllocator.Free(f0, sizeof(b2Fixture), b2MemoryCategory::FIXTURES);
 
         b->m_fixtureList = f;
         b->m_fixtureCount -= 1;
@@ -198,8 +261,9 @@ void b2World::DestroyBody(b2Body* b)
     }
 
     --m_bodyCount;
+    m_freeBodySlots.push_back(b->m_slot);
     b->~b2Body();
-    m_blockAllocator.Free(b, sizeof(b2Body));
+    m_blockAllocator.Free(b, sizeof(b2Body), b2MemoryCategory::BODIES);
 }
 
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
@@ -261,6 +325,11 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 
     // Note: creating a joint doesn't wake the bodies.
 
+    if (m_recorder)
+    {
+        m_recorder->JointCreated(j);
+    }
+
     return j;
 }
 
@@ -272,6 +341,11 @@ void b2World::DestroyJoint(b2Joint* j)
         return;
     }
 
+    if (m_recorder)
+    {
+        m_recorder->JointDestroyed(j);
+    }
+
     bool collideConnected = j->m_collideConnected;
 
     // Remove from the doubly linked list.
@@ -377,23 +451,136 @@ void b2World::SetAllowSleeping(bool flag)
     }
 }
 
+void b2World::Reset(bool sayGoodbye)
+{
+    b2Assert(IsLocked() == false);
+    if (IsLocked())
+    {
+        return;
+    }
+
+    if (m_recorder)
+    {
+        m_recorder->Reset();
+    }
+
+    if (sayGoodbye && m_destructionListener)
+    {
+        for (b2Joint* j = m_jointList; j; j = j->m_next)
+        {
+            m_destructionListener->SayGoodbye(j);
+        }
+
+        for (b2Body* b = m_bodyList; b; b = b->m_next)
+        {
+            for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+            {
+                m_destructionListener->SayGoodbye(f);
+            }
+        }
+    }
+
+    // Shapes may hold memory outside the block allocator, such as polygon vertices, so
+    // they are destroyed as in the destructor. The rest is released in bulk.
+    for (b2Body* b = m_bodyList; b; b = b->m_next)
+    {
+        for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+        {
+            f->m_proxyCount = 0;
+            f->Destroy(&m_blockAllocator);
+        }
+    }
+
+    m_blockAllocator.Reset();
+    m_contactManager.m_broadPhase.Reset();
+    m_contactManager.m_contactList = nullptr;
+    m_contactManager.m_contactCount = 0;
+    m_contactManager.m_contactSerial = 0;
+    m_contactManager.m_contacts.clear();
+    m_contactManager.m_contactStates.clear();
+
+    m_bodyList = nullptr;
+    m_jointList = nullptr;
+    m_bodyCount = 0;
+    m_jointCount = 0;
+    m_bodyStates.clear();
+    m_freeBodySlots.clear();
+
+    m_toiHeap.clear();
+    m_toiDirty.clear();
+
+    m_flags &= ~e_newFixture;
+    m_inv_dt0 = 0.0f;
+    m_stepComplete = true;
+}
+
+void b2World::Compact()
+{
+    b2Assert(IsLocked() == false);
+    if (IsLocked())
+    {
+        return;
+    }
+
+    if (m_recorder)
+    {
+        m_recorder->Compact();
+    }
+
+    std::vector<int32_t> remap;
+    m_contactManager.m_broadPhase.Compact(&remap);
+    for (b2Body* b = m_bodyList; b; b = b->m_next)
+    {
+        for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+        {
+            for (int32_t i = 0; i < f->m_proxyCount; ++i)
+            {
+                f->m_proxies[i].proxyId = remap[f->m_proxies[i].proxyId];
+            }
+        }
+    }
+
+    m_blockAllocator.Compact();
+
+    // Pack the body states, so the passes over them skip no destroyed bodies.
+    b2BodyStateArray states(m_bodyStates.get_allocator());
+    states.reserve(m_bodyCount);
+    for (b2Body* b = m_bodyList; b; b = b->m_next)
+    {
+        states.push_back(b->GetState());
+        b->m_slot = (int32_t)states.size() - 1;
+    }
+    m_bodyStates.swap(states);
+    m_freeBodySlots.clear();
+    m_freeBodySlots.shrink_to_fit();
+
+    // The contact arrays are dense already, only their spare capacity is released.
+    m_contactManager.m_contacts.shrink_to_fit();
+    m_contactManager.m_contactStates.shrink_to_fit();
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
+    B2_PROFILE_ZONE(m_contactManager.m_profiler, "Solve");
     m_profile.solveInit = 0.0f;
     m_profile.solveVelocity = 0.0f;
     m_profile.solvePosition = 0.0f;
+    m_profile.hardware.solveInit = b2PerfSample();
+    m_profile.hardware.solveVelocity = b2PerfSample();
+    m_profile.hardware.solvePosition = b2PerfSample();
 
     // Size the island for the worst case.
     b2Island island(m_bodyCount, m_contactManager.m_contactCount, m_jointCount, &m_stackAllocator,
-                    m_contactManager.m_contactListener);
+                    m_contactManager.m_contactListener, m_contactManager.m_profiler,
+                    m_perfCounters, m_solverListener, m_contactManager.m_phaseListener);
 
     // Clear all the island flags.
     for (b2Body* b = m_bodyList; b; b = b->m_next)
     {
         b->m_flags &= ~b2Body::e_islandFlag;
     }
-    for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+    for (b2Contact* c : m_contactManager.m_contacts)
     {
         c->m_flags &= ~b2Contact::e_islandFlag;
     }
@@ -423,6 +610,9 @@ void b2World::Solve(const b2TimeStep& step)
             continue;
         }
 
+        int32_t islandIndex = m_profile.islands;
+        b2BeginPhase(m_contactManager.m_phaseListener, "BuildIsland", islandIndex);
+
         // Reset island and stack.
         island.Clear();
         int32_t stackCount = 0;
@@ -518,11 +708,23 @@ void b2World::Solve(const b2TimeStep& step)
             }
         }
 
+        b2EndPhase(m_contactManager.m_phaseListener, "BuildIsland", islandIndex);
+
+        b2BeginPhase(m_contactManager.m_phaseListener, "SolveIsland", islandIndex);
         b2Profile profile;
+        island.m_index = islandIndex;
         island.Solve(&profile, step, m_gravity, m_allowSleep);
+        b2EndPhase(m_contactManager.m_phaseListener, "SolveIsland", islandIndex);
         m_profile.solveInit += profile.solveInit;
         m_profile.solveVelocity += profile.solveVelocity;
         m_profile.solvePosition += profile.solvePosition;
+        m_profile.hardware.solveInit.Add(profile.hardware.solveInit);
+        m_profile.hardware.solveVelocity.Add(profile.hardware.solveVelocity);
+        m_profile.hardware.solvePosition.Add(profile.hardware.solvePosition);
+        m_profile.positionIterations += profile.positionIterations;
+        m_profile.unsolvedIslands += profile.unsolvedIslands;
+        ++m_profile.islands;
+        m_profile.maxIslandBodies = b2Max(m_profile.maxIslandBodies, island.m_bodyCount);
 
         // Post solve cleanup.
         for (int32_t i = 0; i < island.m_bodyCount; ++i)
@@ -533,6 +735,10 @@ void b2World::Solve(const b2TimeStep& step)
             {
                 b->m_flags &= ~b2Body::e_islandFlag;
             }
+            else
+            {
+                ++m_profile.awakeBodies;
+            }
         }
     }
 
@@ -540,45 +746,199 @@ void b2World::Solve(const b2TimeStep& step)
 
     {
         b2Timer timer;
-        // Synchronize fixtures, check for out of range bodies.
-        for (b2Body* b = m_bodyList; b; b = b->GetNext())
+        b2PerfTimer perf(m_perfCounters);
+        // Synchronize fixtures, check for out of range bodies. The zone ends before the
+        // pair update, which has its own.
         {
-            // If a body was not in an island then it did not move.
-            if ((b->m_flags & b2Body::e_islandFlag) == 0)
+            B2_PROFILE_ZONE(m_contactManager.m_profiler, "SynchronizeFixtures");
+            b2PhaseScope phase(m_contactManager.m_phaseListener, "SynchronizeFixtures");
+            for (b2Body* b = m_bodyList; b; b = b->GetNext())
             {
-                continue;
-            }
+                // If a body was not in an island then it did not move.
+                if ((b->m_flags & b2Body::e_islandFlag) == 0)
+                {
+                    continue;
+                }
 
-            if (b->GetType() == b2BodyType::STATIC_BODY)
-            {
-                continue;
-            }
+                if (b->GetType() == b2BodyType::STATIC_BODY)
+                {
+                    continue;
+                }
 
-            // Update fixtures (for broad-phase).
-            b->SynchronizeFixtures();
+                // Update fixtures (for broad-phase).
+                if (m_contactManager.m_speculativeContacts || b->IsSpeculative())
+                {
+                    b->SynchronizeSpeculativeFixtures(step.dt);
+                }
+                else
+                {
+                    b->SynchronizeFixtures();
+                }
+            }
         }
 
         // Look for new contacts.
         m_contactManager.FindNewContacts();
         m_profile.broadphase = timer.GetMilliseconds();
+        m_profile.hardware.broadphase = perf.GetSample();
+    }
+}
+
+// Computes the TOI of a contact unless it is cached. Returns false if the contact is not
+// a candidate for a TOI event.
+bool b2World::UpdateTOI(b2Contact* c)
+{
+    // Is this contact disabled?
+    if (c->IsEnabled() == false)
+    {
+        return false;
+    }
+
+    // Prevent excessive sub-stepping.
+    if (c->m_toiCount > MAX_SUB_STEPS)
+    {
+        return false;
+    }
+
+    if (c->m_flags & b2Contact::e_toiFlag)
+    {
+        // This contact has a valid cached TOI.
+        return true;
+    }
+
+    b2Fixture* fA = c->GetFixtureA();
+    b2Fixture* fB = c->GetFixtureB();
+
+    // Is there a sensor?
+    if (fA->IsSensor() || fB->IsSensor())
+    {
+        return false;
+    }
+
+    b2Body* bA = fA->GetBody();
+    b2Body* bB = fB->GetBody();
+
+    // Speculative contacts are handled by the regular solver.
+    if (bA->IsSpeculative() || bB->IsSpeculative())
+    {
+        return false;
+    }
+
+    b2BodyType typeA = bA->m_type;
+    b2BodyType typeB = bB->m_type;
+    b2Assert(typeA == b2BodyType::DYNAMIC_BODY || typeB == b2BodyType::DYNAMIC_BODY);
+
+    bool activeA = bA->IsAwake() && typeA != b2BodyType::STATIC_BODY;
+    bool activeB = bB->IsAwake() && typeB != b2BodyType::STATIC_BODY;
+
+    // Is at least one body active (awake and dynamic or kinematic)?
+    if (activeA == false && activeB == false)
+    {
+        return false;
+    }
+
+    bool collideA = bA->IsBullet() || typeA != b2BodyType::DYNAMIC_BODY;
+    bool collideB = bB->IsBullet() || typeB != b2BodyType::DYNAMIC_BODY;
+
+    // Are these two non-bullet dynamic bodies?
+    if (collideA == false && collideB == false)
+    {
+        return false;
+    }
+
+    // Compute the TOI for this contact.
+    // Put the sweeps onto the same time interval.
+    b2Sweep& sweepA = bA->GetState().sweep;
+    b2Sweep& sweepB = bB->GetState().sweep;
+    float alpha0 = sweepA.alpha0;
+
+    if (sweepA.alpha0 < sweepB.alpha0)
+    {
+        alpha0 = sweepB.alpha0;
+        sweepA.Advance(alpha0);
+    }
+    else if (sweepB.alpha0 < sweepA.alpha0)
+    {
+        alpha0 = sweepA.alpha0;
+        sweepB.Advance(alpha0);
+    }
+
+    b2Assert(alpha0 < 1.0f);
+
+    int32_t indexA = c->GetChildIndexA();
+    int32_t indexB = c->GetChildIndexB();
+
+    // Compute the time of impact in interval [0, minTOI]
+    b2TOIInput input;
+    input.proxyA.Set(c->GetShapeA(), indexA);
+    input.proxyB.Set(c->GetShapeB(), indexB);
+    input.sweepA = sweepA;
+    input.sweepB = sweepB;
+    input.tMax = 1.0f;
+
+    b2TOIOutput output;
+    if (m_analyticTOI && fB->GetType() == b2Shape::e_circle)
+    {
+        b2TimeOfImpactCircle(&output, &input, &m_toiStats, &m_gjkStats);
+    }
+    else if (m_analyticTOI && fA->GetType() == b2Shape::e_circle)
+    {
+        // The circle goes second.
+        std::swap(input.proxyA, input.proxyB);
+        std::swap(input.sweepA, input.sweepB);
+        b2TimeOfImpactCircle(&output, &input, &m_toiStats, &m_gjkStats);
+    }
+    else
+    {
+        b2TimeOfImpact(&output, &input, &m_toiStats, &m_gjkStats);
+    }
+
+    // Beta is the fraction of the remaining portion of the .
+    float beta = output.t;
+    float alpha = 1.0f;
+    if (output.state == b2TOIOutput::e_touching)
+    {
+        alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
     }
+
+    c->m_toi = alpha;
+    c->m_flags |= b2Contact::e_toiFlag;
+    return true;
+}
+
+// Orders the TOI heap so the earliest event is on top. Ties go to the newer contact,
+// which is the one a scan of the contact list would find first.
+static bool b2TOIEventLater(const b2TOIEvent& a, const b2TOIEvent& b)
+{
+    if (a.alpha != b.alpha)
+    {
+        return a.alpha > b.alpha;
+    }
+    return a.serial < b.serial;
 }
 
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
+    B2_PROFILE_ZONE(m_contactManager.m_profiler, "SolveTOI");
+    b2PhaseScope phase(m_contactManager.m_phaseListener, "SolveTOI");
     b2Island island(2 * MAX_TOI_CONTACTS, MAX_TOI_CONTACTS, 0, &m_stackAllocator,
-                    m_contactManager.m_contactListener);
+                    m_contactManager.m_contactListener, m_contactManager.m_profiler,
+                    m_perfCounters, nullptr, m_contactManager.m_phaseListener);
 
     if (m_stepComplete)
     {
         for (b2Body* b = m_bodyList; b; b = b->m_next)
         {
             b->m_flags &= ~b2Body::e_islandFlag;
-            b->m_sweep.alpha0 = 0.0f;
         }
 
-        for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+        for (b2BodyState& state : m_bodyStates)
+        {
+            state.sweep.alpha0 = 0.0f;
+        }
+
+        for (b2Contact* c : m_contactManager.m_contacts)
         {
             // Invalidate TOI
             c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
@@ -587,121 +947,48 @@ void b2World::SolveTOI(const b2TimeStep& step)
         }
     }
 
+    // Every contact gets its TOI computed or queued once. After that only the contacts
+    // touched by a TOI event are revisited.
+    m_toiHeap.clear();
+    m_toiDirty.assign(m_contactManager.m_contacts.begin(), m_contactManager.m_contacts.end());
+
     // Find TOI events and solve them.
     for (;;)
     {
-        // Find the first TOI.
-        b2Contact* minContact = nullptr;
-        float minAlpha = 1.0f;
+        // Visit the dirty contacts in contact list order, like a full scan of the list
+        // would. This keeps the sweep advancement in UpdateTOI in the same order.
+        std::sort(m_toiDirty.begin(), m_toiDirty.end(),
+                  [](const b2Contact* a, const b2Contact* b) { return a->m_serial > b->m_serial; });
+        m_toiDirty.erase(std::unique(m_toiDirty.begin(), m_toiDirty.end()), m_toiDirty.end());
 
-        for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+        for (b2Contact* c : m_toiDirty)
         {
-            // Is this contact disabled?
-            if (c->IsEnabled() == false)
-            {
-                continue;
-            }
-
-            // Prevent excessive sub-stepping.
-            if (c->m_toiCount > MAX_SUB_STEPS)
-            {
-                continue;
-            }
-
-            float alpha = 1.0f;
-            if (c->m_flags & b2Contact::e_toiFlag)
+            if (UpdateTOI(c) && c->m_toi < 1.0f)
             {
-                // This contact has a valid cached TOI.
-                alpha = c->m_toi;
+                m_toiHeap.push_back({c->m_toi, c->m_serial, c});
+                std::push_heap(m_toiHeap.begin(), m_toiHeap.end(), b2TOIEventLater);
             }
-            else
-            {
-                b2Fixture* fA = c->GetFixtureA();
-                b2Fixture* fB = c->GetFixtureB();
-
-                // Is there a sensor?
-                if (fA->IsSensor() || fB->IsSensor())
-                {
-                    continue;
-                }
-
-                b2Body* bA = fA->GetBody();
-                b2Body* bB = fB->GetBody();
-
-                b2BodyType typeA = bA->m_type;
-                b2BodyType typeB = bB->m_type;
-                b2Assert(typeA == b2BodyType::DYNAMIC_BODY || typeB == b2BodyType::DYNAMIC_BODY);
-
-                bool activeA = bA->IsAwake() && typeA != b2BodyType::STATIC_BODY;
-                bool activeB = bB->IsAwake() && typeB != b2BodyType::STATIC_BODY;
-
-                // Is at least one body active (awake and dynamic or kinematic)?
-                if (activeA == false && activeB == false)
-                {
-                    continue;
-                }
-
-                bool collideA = bA->IsBullet() || typeA != b2BodyType::DYNAMIC_BODY;
-                bool collideB = bB->IsBullet() || typeB != b2BodyType::DYNAMIC_BODY;
-
-                // Are these two non-bullet dynamic bodies?
-                if (collideA == false && collideB == false)
-                {
-                    continue;
-                }
-
-                // Compute the TOI for this contact.
-                // Put the sweeps onto the same time interval.
-                float alpha0 = bA->m_sweep.alpha0;
-
-                if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-                {
-                    alpha0 = bB->m_sweep.alpha0;
-                    bA->m_sweep.Advance(alpha0);
-                }
-                else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-                {
-                    alpha0 = bA->m_sweep.alpha0;
-                    bB->m_sweep.Advance(alpha0);
-                }
-
-                b2Assert(alpha0 < 1.0f);
-
-                int32_t indexA = c->GetChildIndexA();
-                int32_t indexB = c->GetChildIndexB();
-
-                // Compute the time of impact in interval [0, minTOI]
-                b2TOIInput input;
-                input.proxyA.Set(fA->GetShape(), indexA);
-                input.proxyB.Set(fB->GetShape(), indexB);
-                input.sweepA = bA->m_sweep;
-                input.sweepB = bB->m_sweep;
-                input.tMax = 1.0f;
-
-                b2TOIOutput output;
-                b2TimeOfImpact(&output, &input);
-
-                // Beta is the fraction of the remaining portion of the .
-                float beta = output.t;
-                if (output.state == b2TOIOutput::e_touching)
-                {
-                    alpha = b2Min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-                }
-                else
-                {
-                    alpha = 1.0f;
-                }
+        }
+        m_toiDirty.clear();
 
-                c->m_toi = alpha;
-                c->m_flags |= b2Contact::e_toiFlag;
-            }
+        // Find the first TOI. Events are stale once their contact was invalidated.
+        b2Contact* minContact = nullptr;
+        float minAlpha = 1.0f;
 
-            if (alpha < minAlpha)
+        while (m_toiHeap.empty() == false)
+        {
+            const b2TOIEvent& event = m_toiHeap.front();
+            b2Contact* c = event.contact;
+            if ((c->m_flags & b2Contact::e_toiFlag) && c->m_toi == event.alpha &&
+                c->IsEnabled() && c->m_toiCount <= MAX_SUB_STEPS)
             {
-                // This is the minimum TOI found so far.
                 minContact = c;
-                minAlpha = alpha;
+                minAlpha = event.alpha;
+                break;
             }
+
+            std::pop_heap(m_toiHeap.begin(), m_toiHeap.end(), b2TOIEventLater);
+            m_toiHeap.pop_back();
         }
 
         if (minContact == nullptr || 1.0f - 10.0f * EPSILON < minAlpha)
@@ -717,14 +1004,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
         b2Body* bA = fA->GetBody();
         b2Body* bB = fB->GetBody();
 
-        b2Sweep backup1 = bA->m_sweep;
-        b2Sweep backup2 = bB->m_sweep;
+        b2Sweep backup1 = bA->GetState().sweep;
+        b2Sweep backup2 = bB->GetState().sweep;
 
         bA->Advance(minAlpha);
         bB->Advance(minAlpha);
 
         // The TOI contact likely has some new contact points.
-        minContact->Update(m_contactManager.m_contactListener);
+        minContact->Update(m_contactManager.m_contactListener, &m_gjkStats);
         minContact->m_flags &= ~b2Contact::e_toiFlag;
         ++minContact->m_toiCount;
 
@@ -733,8 +1020,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
         {
             // Restore the sweeps.
             minContact->SetEnabled(false);
-            bA->m_sweep = backup1;
-            bB->m_sweep = backup2;
+            bA->GetState().sweep = backup1;
+            bB->GetState().sweep = backup2;
             bA->SynchronizeTransform();
             bB->SynchronizeTransform();
             continue;
@@ -796,19 +1083,19 @@ void b2World::SolveTOI(const b2TimeStep& step)
                     }
 
                     // Tentatively advance the body to the TOI.
-                    b2Sweep backup = other->m_sweep;
+                    b2Sweep backup = other->GetState().sweep;
                     if ((other->m_flags & b2Body::e_islandFlag) == 0)
                     {
                         other->Advance(minAlpha);
                     }
 
                     // Update the contact points
-                    contact->Update(m_contactManager.m_contactListener);
+                    contact->Update(m_contactManager.m_contactListener, &m_gjkStats);
 
                     // Was the contact disabled by the user?
                     if (contact->IsEnabled() == false)
                     {
-                        other->m_sweep = backup;
+                        other->GetState().sweep = backup;
                         other->SynchronizeTransform();
                         continue;
                     }
@@ -816,7 +1103,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
                     // Are there contact points?
                     if (contact->IsTouching() == false)
                     {
-                        other->m_sweep = backup;
+                        other->GetState().sweep = backup;
                         other->SynchronizeTransform();
                         continue;
                     }
@@ -859,6 +1146,18 @@ void b2World::SolveTOI(const b2TimeStep& step)
             b2Body* body = island.m_bodies[i];
             body->m_flags &= ~b2Body::e_islandFlag;
 
+            if (body->m_type == b2BodyType::KINEMATIC_BODY)
+            {
+                // The body may have been woken, which makes its uncached contacts candidates.
+                for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
+                {
+                    if ((ce->contact->m_flags & b2Contact::e_toiFlag) == 0)
+                    {
+                        m_toiDirty.push_back(ce->contact);
+                    }
+                }
+            }
+
             if (body->m_type != b2BodyType::DYNAMIC_BODY)
             {
                 continue;
@@ -870,13 +1169,19 @@ void b2World::SolveTOI(const b2TimeStep& step)
             for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
             {
                 ce->contact->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+                m_toiDirty.push_back(ce->contact);
             }
         }
 
         // Commit fixture proxy movements to the broad-phase so that new contacts are created.
         // Also, some contacts can be destroyed.
+        size_t oldCount = m_contactManager.m_contacts.size();
         m_contactManager.FindNewContacts();
 
+        // New contacts are appended to the contact array.
+        m_toiDirty.insert(m_toiDirty.end(), m_contactManager.m_contacts.begin() + oldCount,
+                          m_contactManager.m_contacts.end());
+
         if (m_subStepping)
         {
             m_stepComplete = false;
@@ -887,7 +1192,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 void b2World::Step(float dt, int32_t velocityIterations, int32_t positionIterations)
 {
+    if (m_recorder)
+    {
+        m_recorder->StepBegin(dt, velocityIterations, positionIterations);
+    }
+
+    B2_PROFILE_ZONE(m_contactManager.m_profiler, "Step");
     b2Timer stepTimer;
+    b2PerfTimer stepPerf(m_perfCounters);
 
     // If new fixtures were added, we need to find the new contacts.
     if (m_flags & e_newFixture)
@@ -898,6 +1210,15 @@ void b2World::Step(float dt, int32_t velocityIterations, int32_t positionIterati
 
     m_flags |= e_locked;
 
+    m_gjkStats = b2GJKStats();
+    m_toiStats = b2TOIStats();
+    m_profile.awakeBodies = 0;
+    m_profile.islands = 0;
+    m_profile.maxIslandBodies = 0;
+    m_profile.positionIterations = 0;
+    m_profile.unsolvedIslands = 0;
+    int32_t stackFallbacks = m_stackAllocator.GetFallbackCount();
+
     b2TimeStep step;
     step.dt = dt;
     step.velocityIterations = velocityIterations;
@@ -917,25 +1238,32 @@ void b2World::Step(float dt, int32_t velocityIterations, int32_t positionIterati
 
     // Update contacts. This is where some contacts are destroyed.
     {
+        B2_PROFILE_ZONE(m_contactManager.m_profiler, "Collide");
         b2Timer timer;
-        m_contactManager.Collide();
+        b2PerfTimer perf(m_perfCounters);
+        m_contactManager.Collide(step, &m_gjkStats);
         m_profile.collide = timer.GetMilliseconds();
+        m_profile.hardware.collide = perf.GetSample();
     }
 
     // Integrate velocities, solve velocity constraints, and integrate positions.
     if (m_stepComplete && step.dt > 0.0f)
     {
         b2Timer timer;
+        b2PerfTimer perf(m_perfCounters);
         Solve(step);
         m_profile.solve = timer.GetMilliseconds();
+        m_profile.hardware.solve = perf.GetSample();
     }
 
-    // Handle TOI events.
-    if (m_continuousPhysics && step.dt > 0.0f)
+    // Handle TOI events. Speculative contacts don't need them.
+    if (m_continuousPhysics && m_contactManager.m_speculativeContacts == false && step.dt > 0.0f)
     {
         b2Timer timer;
+        b2PerfTimer perf(m_perfCounters);
         SolveTOI(step);
         m_profile.solveTOI = timer.GetMilliseconds();
+        m_profile.hardware.solveTOI = perf.GetSample();
     }
 
     if (step.dt > 0.0f)
@@ -950,28 +1278,157 @@ void b2World::Step(float dt, int32_t velocityIterations, int32_t positionIterati
 
     m_flags &= ~e_locked;
 
+    m_profile.gjk = m_gjkStats;
+    m_profile.toi = m_toiStats;
+    m_profile.stackFallbacks = m_stackAllocator.GetFallbackCount() - stackFallbacks;
+    m_profile.broadPhase = m_contactManager.m_broadPhase.GetStats();
+    m_profile.contactsCreated = m_contactManager.m_contactsCreated;
+    m_profile.contactsDestroyed = m_contactManager.m_contactsDestroyed;
+    m_profile.touchingContacts = m_contactManager.m_touchingCount;
+    m_contactManager.m_broadPhase.ResetStats();
+    m_contactManager.m_contactsCreated = 0;
+    m_contactManager.m_contactsDestroyed = 0;
     m_profile.step = stepTimer.GetMilliseconds();
+    m_profile.hardware.step = stepPerf.GetSample();
+
+    if (m_recorder)
+    {
+        m_recorder->StepEnd();
+    }
+}
+
+b2MemoryStats b2World::GetMemoryStats() const
+{
+    b2MemoryStats stats;
+    stats.bodies = m_blockAllocator.GetAllocatedBytes(b2MemoryCategory::BODIES);
+    stats.bodyStates = (int32_t)(m_bodyStates.capacity() * sizeof(b2BodyState));
+    stats.fixtures = m_blockAllocator.GetAllocatedBytes(b2MemoryCategory::FIXTURES);
+    stats.shapes = m_blockAllocator.GetAllocatedBytes(b2MemoryCategory::SHAPES);
+    stats.contacts = m_blockAllocator.GetAllocatedBytes(b2MemoryCategory::CONTACTS);
+    stats.contactStates = (int32_t)(m_contactManager.m_contacts.capacity() * sizeof(b2Contact*) +
+                                    m_contactManager.m_contactStates.capacity() *
+                                        sizeof(b2ContactState));
+    stats.joints = m_blockAllocator.GetAllocatedBytes(b2MemoryCategory::JOINTS);
+    stats.treeNodes = m_contactManager.m_broadPhase.GetTreeMemory();
+    stats.broadPhase = m_contactManager.m_broadPhase.GetBufferMemory();
+    stats.blockChunks = m_blockAllocator.GetChunkCount() * b2_chunkSize;
+    stats.stack = m_stackAllocator.GetCapacity();
+    stats.stackHighWater = m_stackAllocator.GetMaxAllocation();
+
+    // Chain vertices and local trees are taken from the memory resource directly.
+    for (const b2Body* b = m_bodyList; b; b = b->GetNext())
+    {
+        for (const b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+        {
+            if (f->GetType() != b2Shape::e_chain || f->IsShapeShared())
+            {
+                continue;
+            }
+
+            const b2ChainShape* chain = (const b2ChainShape*)f->GetShape();
+            stats.shapes += chain->m_count * sizeof(b2Vec<float, 2>);
+            const b2DynamicTree* tree = chain->GetLocalTree();
+            if (tree)
+            {
+                stats.shapes += sizeof(b2DynamicTree);
+                stats.shapes += tree->GetNodeCapacity() * sizeof(b2TreeNode);
+            }
+        }
+    }
+
+    return stats;
+}
+
+void b2World::SetAllocationListener(b2AllocationListener* listener)
+{
+    m_blockAllocator.SetAllocationListener(listener);
+}
+
+b2BlockAllocator* b2World::GetBlockAllocator()
+{
+    return &m_blockAllocator;
+}
+
+void b2World::SetContactAllocator(b2SmallObjectAllocator* allocator)
+{
+    b2Assert(IsLocked() == false);
+    if (allocator == nullptr)
+    {
+        allocator = &m_blockAllocator;
+    }
+
+    // The contacts may be freed through either allocator, so they must share the blocks.
+    b2Assert(allocator->GetBlockAllocator() == &m_blockAllocator);
+    m_contactManager.m_allocator = allocator;
+}
+
+void b2World::SetProfiler(b2Profiler* profiler)
+{
+    m_contactManager.m_profiler = profiler;
+}
+
+void b2World::SetPerfCounters(const b2PerfCounters* counters)
+{
+    m_perfCounters = counters;
+}
+
+void b2World::SetSolverListener(b2SolverListener* listener)
+{
+    m_solverListener = listener;
+}
+
+void b2World::SetPhaseListener(b2PhaseListener* listener)
+{
+    m_contactManager.m_phaseListener = listener;
 }
 
 void b2World::ClearForces()
 {
-    for (b2Body* body = m_bodyList; body; body = body->GetNext())
+    for (b2BodyState& state : m_bodyStates)
     {
-        body->m_force = {{0.0f, 0.0f}};
-        body->m_torque = 0.0f;
+        state.force = {{0.0f, 0.0f}};
+        state.torque = 0.0f;
     }
 }
 
+struct b2ChildTreeOverlap
+{
+    bool QueryCallback(int32_t proxyId)
+    {
+        B2_NOT_USED(proxyId);
+        overlap = true;
+        return false;
+    }
+
+    bool overlap;
+};
+
 struct b2WorldQueryWrapper
 {
     bool QueryCallback(int32_t proxyId)
     {
         b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
-        return callback->ReportFixture(proxy->fixture);
+        b2Fixture* fixture = proxy->fixture;
+
+        // Only report a chain with a local tree if one of its edges overlaps.
+        const b2DynamicTree* tree = fixture->GetChildTree();
+        if (tree)
+        {
+            b2ChildTreeOverlap query;
+            query.overlap = false;
+            tree->Query(&query, b2MulT(fixture->GetBody()->GetTransform(), aabb));
+            if (query.overlap == false)
+            {
+                return true;
+            }
+        }
+
+        return callback->ReportFixture(fixture);
     }
 
     const b2BroadPhase* broadPhase;
     b2QueryCallback* callback;
+    b2AABB aabb;
 };
 
 void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
@@ -979,9 +1436,45 @@ void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
     b2WorldQueryWrapper wrapper;
     wrapper.broadPhase = &m_contactManager.m_broadPhase;
     wrapper.callback = callback;
+    wrapper.aabb = aabb;
     m_contactManager.m_broadPhase.Query(&wrapper, aabb);
 }
 
+// Ray cast the edges of a chain with a local tree. The tree works in the frame of the
+// chain while the edges are tested with the world ray, the fractions are the same.
+struct b2ChildTreeRayCastWrapper
+{
+    float RayCastCallback(const b2RayCastInput& subInput, int32_t nodeId)
+    {
+        int32_t index = static_cast<int32_t>(reinterpret_cast<intptr_t>(tree->GetUserData(nodeId)));
+        b2RayCastInput input = worldInput;
+        input.maxFraction = subInput.maxFraction;
+
+        b2RayCastOutput output;
+        bool hit = fixture->RayCast(&output, input, index);
+
+        if (hit)
+        {
+            float fraction = output.fraction;
+            b2Vec<float, 2> point = (1.0f - fraction) * input.p1 + fraction * input.p2;
+            float value = callback->ReportFixture(fixture, point, output.normal, fraction);
+            if (value >= 0.0f)
+            {
+                result = value;
+            }
+            return value;
+        }
+
+        return subInput.maxFraction;
+    }
+
+    const b2DynamicTree* tree;
+    b2Fixture* fixture;
+    b2RayCastCallback* callback;
+    b2RayCastInput worldInput;
+    float result;
+};
+
 struct b2WorldRayCastWrapper
 {
     float RayCastCallback(const b2RayCastInput& input, int32_t proxyId)
@@ -989,6 +1482,26 @@ struct b2WorldRayCastWrapper
         void* userData = broadPhase->GetUserData(proxyId);
         b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
         b2Fixture* fixture = proxy->fixture;
+
+        const b2DynamicTree* tree = fixture->GetChildTree();
+        if (tree)
+        {
+            b2ChildTreeRayCastWrapper wrapper;
+            wrapper.tree = tree;
+            wrapper.fixture = fixture;
+            wrapper.callback = callback;
+            wrapper.worldInput = input;
+            wrapper.result = input.maxFraction;
+
+            const b2Transform& xf = fixture->GetBody()->GetTransform();
+            b2RayCastInput localInput;
+            localInput.p1 = b2MulT(xf, input.p1);
+            localInput.p2 = b2MulT(xf, input.p2);
+            localInput.maxFraction = input.maxFraction;
+            tree->RayCast(&wrapper, localInput);
+            return wrapper.result;
+        }
+
         int32_t index = proxy->childIndex;
         b2RayCastOutput output;
         bool hit = fixture->RayCast(&output, input, index);
@@ -1019,13 +1532,13 @@ void b2World::RayCast(b2RayCastCallback* callback, const b2Vec<float, 2>& point1
     m_contactManager.m_broadPhase.RayCast(&wrapper, input);
 }
 
-void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+void b2World::DrawShape(const b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
 {
     switch (fixture->GetType())
     {
         case b2Shape::e_circle:
         {
-            b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+            const b2CircleShape* circle = (const b2CircleShape*)fixture->GetShape();
 
             b2Vec<float, 2> center = b2Mul(xf, circle->m_p);
             float radius = circle->GetRadius();
@@ -1037,7 +1550,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
         case b2Shape::e_edge:
         {
-            b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
+            const b2EdgeShape* edge = (const b2EdgeShape*)fixture->GetShape();
             b2Vec<float, 2> v1 = b2Mul(xf, edge->m_vertex1);
             b2Vec<float, 2> v2 = b2Mul(xf, edge->m_vertex2);
             g_debugDraw->DrawSegment(v1, v2, color);
@@ -1046,7 +1559,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
         case b2Shape::e_chain:
         {
-            b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+            const b2ChainShape* chain = (const b2ChainShape*)fixture->GetShape();
             int32_t count = chain->m_count;
             const b2Vec<float, 2>* vertices = chain->m_vertices;
 
@@ -1063,7 +1576,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
         case b2Shape::e_polygon:
         {
-            b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
+            const b2PolygonShape* poly = (const b2PolygonShape*)fixture->GetShape();
             std::vector<b2Vec<float, 2>> vertices = poly->GetVertices();
 
             for (auto& vertex : vertices)
@@ -1253,11 +1766,20 @@ void b2World::ShiftOrigin(const b2Vec<float, 2>& newOrigin)
         return;
     }
 
+    if (m_recorder)
+    {
+        m_recorder->ShiftOrigin(newOrigin);
+    }
+
     for (b2Body* b = m_bodyList; b; b = b->m_next)
     {
         b->m_xf.p -= newOrigin;
-        b->m_sweep.c0 -= newOrigin;
-        b->m_sweep.c -= newOrigin;
+    }
+
+    for (b2BodyState& state : m_bodyStates)
+    {
+        state.sweep.c0 -= newOrigin;
+        state.sweep.c -= newOrigin;
     }
 
     for (b2Joint* j = m_jointList; j; j = j->m_next)
@@ -22,10 +22,13 @@
 #include <Box2D/Common/b2Math.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2ContactManager.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
+#include <vector>
+
 namespace box2d
 {
 struct b2AABB;
@@ -34,8 +37,57 @@ struct b2Color;
 struct b2JointDef;
 class b2Body;
 class b2Draw;
+class b2Contact;
 class b2Fixture;
 class b2Joint;
+class b2Recorder;
+
+/// This is an internal structure.
+struct b2TOIEvent
+{
+    float alpha;
+    uint64_t serial;
+    b2Contact* contact;
+};
+
+/// A world definition holds the data needed to construct a world.
+struct b2WorldDef
+{
+    /// This constructor sets the world definition default values.
+    b2WorldDef()
+    {
+        gravity = {{0.0f, -10.0f}};
+        stackCapacity = b2_stackSize;
+        memoryResource = b2GetDefaultMemoryResource();
+    }
+
+    /// The world gravity vector.
+    b2Vec<float, 2> gravity;
+
+    /// Bytes reserved up front for the per step stack allocator. The allocator grows
+    /// when a step needs more, so a large value only saves the growth in the first steps.
+    int32_t stackCapacity;
+
+    /// The memory resource the world takes its memory from. It must outlive the world.
+    b2MemoryResource* memoryResource;
+};
+
+/// The memory used by a world in bytes, see b2World::GetMemoryStats.
+struct b2MemoryStats
+{
+    int32_t bodies;
+    int32_t bodyStates;      ///< the dense array of body states, see b2BodyState
+    int32_t fixtures;        ///< fixtures and their broad-phase proxies
+    int32_t shapes;          ///< shapes, chain vertices and chain local trees
+    int32_t contacts;
+    int32_t contactStates;   ///< the dense contact handle and state arrays, see b2ContactState
+    int32_t joints;
+    int32_t treeNodes;       ///< broad-phase tree node pool
+    int32_t broadPhase;      ///< broad-phase move and pair buffers
+    int32_t blockChunks;     ///< chunks reserved by the block allocator
+    int32_t stack;           ///< stack allocator blocks
+    int32_t stackHighWater;  ///< peak stack allocation
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -47,6 +99,9 @@ public:
     /// @param gravity the world gravity vector.
     b2World(const b2Vec<float, 2>& gravity);
 
+    /// Construct a world object from a definition.
+    b2World(const b2WorldDef* def);
+
     /// Destruct the world. All physics entities are destroyed and all heap memory is released.
     ~b2World();
 
@@ -88,6 +143,21 @@ public:
     /// @warning This function is locked during callbacks.
     void DestroyJoint(b2Joint* joint);
 
+    /// Destroy all bodies, joints and contacts at once so the world can be reused. The
+    /// allocator chunks, the broad-phase tree nodes and buffers are kept. The settings,
+    /// gravity and listeners are kept as well. Set sayGoodbye to false to skip the
+    /// destruction listener, which is otherwise called for every joint and fixture.
+    /// @warning This function is locked during callbacks.
+    void Reset(bool sayGoodbye = true);
+
+    /// Compact the memory of a world after heavy creation and destruction. The broad-phase
+    /// tree is renumbered in depth first order and its node pool is shrunk to fit, and the
+    /// allocator chunks that hold no live blocks are returned to the memory resource.
+    /// This touches all the fixtures, so call it at a quiet moment rather than every step.
+    /// The fixture proxy ids change, the bodies, fixtures and contacts do not move.
+    /// @warning This function is locked during callbacks.
+    void Compact();
+
     /// Take a time step. This performs collision detection, integration,
     /// and constraint solution.
     /// @param timeStep the amount of time to simulate, this should not vary.
@@ -169,6 +239,21 @@ public:
         return m_continuousPhysics;
     }
 
+    /// Enable/disable speculative contacts for all bodies, see also b2Body::SetSpeculative.
+    /// Speculative contacts replace the time of impact pass. Contact points are created for
+    /// shapes that may touch during the step and the regular solver keeps the bodies from
+    /// closing the gap. This is much cheaper with many fast bodies. The shapes are reported
+    /// as touching once they are within the speculative margin, and a fast body may lose
+    /// some of its bounce on impact.
+    void SetSpeculativeContacts(bool flag)
+    {
+        m_contactManager.m_speculativeContacts = flag;
+    }
+    bool GetSpeculativeContacts() const
+    {
+        return m_contactManager.m_speculativeContacts;
+    }
+
     /// Enable/disable single stepped continuous physics. For testing.
     void SetSubStepping(bool flag)
     {
@@ -179,6 +264,17 @@ public:
         return m_subStepping;
     }
 
+    /// Enable/disable the closed form time of impact for circles, see b2TimeOfImpactCircle.
+    /// For testing.
+    void SetAnalyticTOI(bool flag)
+    {
+        m_analyticTOI = flag;
+    }
+    bool GetAnalyticTOI() const
+    {
+        return m_analyticTOI;
+    }
+
     /// Get the number of broad-phase proxies.
     int32_t GetProxyCount() const;
 
@@ -227,6 +323,47 @@ public:
     /// Get the current profile.
     const b2Profile& GetProfile() const;
 
+    /// Get the memory resource the world takes its memory from.
+    b2MemoryResource* GetMemoryResource() const;
+
+    /// Get the memory used by the world by category. This walks the fixtures to
+    /// account for chain shapes.
+    b2MemoryStats GetMemoryStats() const;
+
+    /// Register a listener that is told about every block allocation and free of the
+    /// world, with its call site. The listener is owned by you and must remain in scope.
+    /// Pass nullptr to stop tracing.
+    void SetAllocationListener(b2AllocationListener* listener);
+
+    /// Get the block allocator the world takes its bodies, fixtures, joints and contacts
+    /// from, to put a b2BlockCache in front of it.
+    b2BlockAllocator* GetBlockAllocator();
+
+    /// Create and destroy the contacts through this allocator, such as a b2BlockCache of
+    /// GetBlockAllocator. Pass nullptr to go back to the block allocator. While a cache is
+    /// in place the block allocator must not be used directly, so only Step may be called.
+    void SetContactAllocator(b2SmallObjectAllocator* allocator);
+
+    /// Register a profiler that records the zones of each step (step, collide, solve,
+    /// each island, synchronize fixtures, pair update and time of impact). Only recorded
+    /// when Box2D is built with B2_PROFILE_ZONES. The profiler is owned by you and must
+    /// remain in scope. Pass nullptr to stop recording.
+    void SetProfiler(b2Profiler* profiler);
+
+    /// Attach hardware counters to measure each phase of the step, see
+    /// b2Profile::hardware. The counters are owned by you and must remain in scope.
+    /// Pass nullptr to stop measuring.
+    void SetPerfCounters(const b2PerfCounters* counters);
+
+    /// Register a listener that is told how well the solver converged on each island.
+    /// The listener is owned by you and must remain in scope. Pass nullptr to stop.
+    void SetSolverListener(b2SolverListener* listener);
+
+    /// Register a listener that is called at the begin and end of each phase of the
+    /// step, see b2PhaseListener. The listener is owned by you and must remain in scope.
+    /// Pass nullptr to stop.
+    void SetPhaseListener(b2PhaseListener* listener);
+
     /// Dump the world into the log file.
     /// @warning this should be called outside of a time step.
     void Dump();
@@ -244,12 +381,19 @@ private:
     friend class b2Fixture;
     friend class b2ContactManager;
     friend class b2Controller;
+    friend class b2Recorder;
+
+    b2World(const b2WorldDef& def);
+
+    // Take a slot in m_bodyStates for a new body.
+    int32_t CreateBodyState();
 
     void Solve(const b2TimeStep& step);
     void SolveTOI(const b2TimeStep& step);
+    bool UpdateTOI(b2Contact* c);
 
     void DrawJoint(b2Joint* joint);
-    void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
+    void DrawShape(const b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
     b2BlockAllocator m_blockAllocator;
     b2StackAllocator m_stackAllocator;
@@ -264,6 +408,11 @@ private:
     int32_t m_bodyCount;
     int32_t m_jointCount;
 
+    // The states of the bodies indexed by b2Body::m_slot, and the slots of the destroyed
+    // bodies to reuse. Compact packs the states.
+    b2BodyStateArray m_bodyStates;
+    std::vector<int32_t, b2ResourceAllocator<int32_t>> m_freeBodySlots;
+
     b2Vec<float, 2> m_gravity;
     bool m_allowSleep;
 
@@ -278,9 +427,26 @@ private:
     bool m_warmStarting;
     bool m_continuousPhysics;
     bool m_subStepping;
+    bool m_analyticTOI;
 
     bool m_stepComplete;
 
+    // Min-heap of time of impact candidates and the contacts whose time of impact must be
+    // computed again, kept here to reuse their storage.
+    std::vector<b2TOIEvent, b2ResourceAllocator<b2TOIEvent>> m_toiHeap;
+    std::vector<b2Contact*, b2ResourceAllocator<b2Contact*>> m_toiDirty;
+
+    // Narrow phase statistics of the current step. They are copied to m_profile when the
+    // step is done.
+    b2GJKStats m_gjkStats;
+    b2TOIStats m_toiStats;
+
+    const b2PerfCounters* m_perfCounters;
+    b2SolverListener* m_solverListener;
+
+    // Set by b2Recorder::Begin.
+    b2Recorder* m_recorder;
+
     b2Profile m_profile;
 
     std::vector<b2Body> m_bodies;
@@ -374,6 +540,11 @@ inline const b2Profile& b2World::GetProfile() const
 {
     return m_profile;
 }
+
+inline b2MemoryResource* b2World::GetMemoryResource() const
+{
+    return m_blockAllocator.GetMemoryResource();
+}
 }
 
 #endif
@@ -135,6 +135,43 @@ public:
     }
 };
 
+/// How far the solver got with one island. The arrays hold one value per iteration and
+/// are only valid during the callback.
+struct b2IslandSolverStats
+{
+    int32_t bodyCount;     ///< including static bodies
+    int32_t contactCount;
+    int32_t jointCount;
+
+    /// The largest normal velocity error of the contact points after each velocity
+    /// iteration, in meters per second. Joints are not included.
+    const float* velocityResiduals;
+    int32_t velocityIterations;
+
+    /// The deepest contact penetration seen by each position iteration, in meters.
+    const float* positionErrors;
+    int32_t positionIterations;    ///< position iterations run
+
+    /// True if the contacts and joints were within tolerance at the last position
+    /// iteration, which is then the iteration at which the position solver converged.
+    bool positionSolved;
+};
+
+/// Implement this class to measure how well the solver converges, to choose the
+/// iteration counts of a scene. It is called for the islands of the regular step, not
+/// for the time of impact sub-steps. Computing the residuals adds a pass over the
+/// contacts to each velocity iteration.
+class b2SolverListener
+{
+public:
+    virtual ~b2SolverListener()
+    {
+    }
+
+    /// Called after an island is solved, before its bodies are put to sleep.
+    virtual void IslandSolved(const b2IslandSolverStats& stats) = 0;
+};
+
 /// Callback class for AABB queries.
 /// See b2World::Query
 class b2QueryCallback
@@ -0,0 +1,59 @@
+// Side by side comparison of box2dpp against the reference Box2D.
+//
+// Usage: compare_ref [steps] [scale] [tolerance]
+//
+// Runs every harness scene through both libraries in lock step and prints the time spent
+// in each step phase, the speedup of box2dpp over the reference (above 1 is faster), and
+// the largest position and angle divergence seen over the run. Configure the regression
+// build with -DCMAKE_BUILD_TYPE=Release for meaningful timings. Returns 2 if any scene
+// diverged by more than the tolerance.
+
+#include "harness.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+static void PrintPhase(const char* name, double box2d, double ref)
+{
+    double speedup = box2d > 0.0 ? ref / box2d : 0.0;
+    std::printf("  %-14s %10.3f %10.3f %8.2fx\n", name, box2d, ref, speedup);
+}
+
+int main(int argc, char** argv)
+{
+    int32_t steps = argc > 1 ? std::atoi(argv[1]) : 600;
+    int32_t scale = argc > 2 ? std::atoi(argv[2]) : 1;
+    float tolerance = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 1.0e-3f;
+    if (steps <= 0 || scale <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [steps] [scale] [tolerance]\n", argv[0]);
+        return 1;
+    }
+
+    bool diverged = false;
+    for (const harness::Scene& scene : harness::DefaultScenes(scale))
+    {
+        harness::Result r = harness::Compare(scene, steps, tolerance);
+
+        std::printf("%s: %d bodies, %d steps\n", r.name.c_str(), r.bodies, r.steps);
+        std::printf("  %-14s %10s %10s %9s\n", "phase (ms)", "box2dpp", "reference", "speedup");
+        PrintPhase("step", r.box2d.step, r.ref.step);
+        PrintPhase("collide", r.box2d.collide, r.ref.collide);
+        PrintPhase("solve", r.box2d.solve, r.ref.solve);
+        PrintPhase("solveInit", r.box2d.solveInit, r.ref.solveInit);
+        PrintPhase("solveVelocity", r.box2d.solveVelocity, r.ref.solveVelocity);
+        PrintPhase("solvePosition", r.box2d.solvePosition, r.ref.solvePosition);
+        PrintPhase("broadphase", r.box2d.broadphase, r.ref.broadphase);
+        PrintPhase("solveTOI", r.box2d.solveTOI, r.ref.solveTOI);
+        std::printf("  max position error %g, max angle error %g", r.maxPositionError,
+                    r.maxAngleError);
+        if (r.firstDivergentStep >= 0)
+        {
+            std::printf(", above %g from step %d", tolerance, r.firstDivergentStep);
+            diverged = true;
+        }
+        std::printf("\n\n");
+    }
+
+    return diverged ? 2 : 0;
+}
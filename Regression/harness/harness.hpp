@@ -0,0 +1,283 @@
+#ifndef _HARNESS_HPP_
+#define _HARNESS_HPP_
+
+// Runs the same scene through box2dpp and the reference Box2D, one step at a time, and
+// compares the step timings and the body states. The scenes come from the benchmark scene
+// builders. They fill the box2dpp world, which is then copied body by body, fixture by
+// fixture and joint by joint into the reference world, in order of creation, so that both
+// libraries create their proxies and contacts in exactly the same order.
+
+#include <Box2D/Box2D.h>
+#include "../box2d-ref/Box2DRef/Box2D.h"
+#include "../../Benchmark/Scenes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace harness
+{
+
+typedef void (*BuildFunction)(box2d::b2World* world, int32_t size);
+
+struct Scene
+{
+    std::string name;
+    BuildFunction build;
+    int32_t size;
+};
+
+inline std::vector<Scene> DefaultScenes(int32_t scale)
+{
+    return {{"pyramid", scenes::BuildPyramid, 10 * scale},
+            {"pile", scenes::BuildPile, 100 * scale},
+            {"chains", scenes::BuildChains, 10 * scale},
+            {"tumbler", scenes::BuildTumbler, 100 * scale},
+            {"bullets", scenes::BuildBullets, 10 * scale}};
+}
+
+// Cumulative phase times in milliseconds, as reported by b2World::GetProfile.
+struct Phases
+{
+    double step = 0.0;
+    double collide = 0.0;
+    double solve = 0.0;
+    double solveInit = 0.0;
+    double solveVelocity = 0.0;
+    double solvePosition = 0.0;
+    double broadphase = 0.0;
+    double solveTOI = 0.0;
+
+    template <typename Profile>
+    void Add(const Profile& p)
+    {
+        step += p.step;
+        collide += p.collide;
+        solve += p.solve;
+        solveInit += p.solveInit;
+        solveVelocity += p.solveVelocity;
+        solvePosition += p.solvePosition;
+        broadphase += p.broadphase;
+        solveTOI += p.solveTOI;
+    }
+};
+
+struct Result
+{
+    std::string name;
+    int32_t steps = 0;
+    int32_t bodies = 0;
+
+    Phases box2d;
+    Phases ref;
+
+    // Largest difference in position and angle over all bodies and steps.
+    float maxPositionError = 0.0f;
+    float maxAngleError = 0.0f;
+
+    // First step with a position error above the tolerance, -1 if none.
+    int32_t firstDivergentStep = -1;
+};
+
+class World
+{
+public:
+    explicit World(const Scene& scene) : m_world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}})
+    {
+        scene.build(&m_world, scene.size);
+
+        // The body list is in reverse order of creation.
+        for (box2d::b2Body* b = m_world.GetBodyList(); b; b = b->GetNext())
+        {
+            m_bodies.push_back(b);
+        }
+        std::reverse(m_bodies.begin(), m_bodies.end());
+    }
+
+    box2d::b2World m_world;
+    std::vector<box2d::b2Body*> m_bodies;
+};
+
+// A copy of a box2dpp world in the reference library. Only the shapes and joints used by
+// the harness scenes are supported: circles, edges, polygons and revolute joints.
+class RefWorld
+{
+public:
+    explicit RefWorld(World& source) : m_world(box2dref::b2Vec2(0.0f, -10.0f))
+    {
+        std::unordered_map<const box2d::b2Body*, box2dref::b2Body*> bodies;
+        for (box2d::b2Body* b : source.m_bodies)
+        {
+            box2dref::b2Body* body = CopyBody(b);
+            bodies[b] = body;
+            m_bodies.push_back(body);
+        }
+
+        std::vector<box2d::b2Joint*> joints;
+        for (box2d::b2Joint* j = source.m_world.GetJointList(); j; j = j->GetNext())
+        {
+            joints.push_back(j);
+        }
+        std::reverse(joints.begin(), joints.end());
+
+        for (box2d::b2Joint* j : joints)
+        {
+            box2d::b2Assert(j->GetType() == box2d::b2JointType::REVOLUTE_JOINT);
+            auto revolute = static_cast<box2d::b2RevoluteJoint*>(j);
+
+            box2dref::b2RevoluteJointDef jd;
+            jd.bodyA = bodies.at(j->GetBodyA());
+            jd.bodyB = bodies.at(j->GetBodyB());
+            jd.collideConnected = j->GetCollideConnected();
+            jd.localAnchorA = Vec(revolute->GetLocalAnchorA());
+            jd.localAnchorB = Vec(revolute->GetLocalAnchorB());
+            jd.referenceAngle = revolute->GetReferenceAngle();
+            jd.enableLimit = revolute->IsLimitEnabled();
+            jd.lowerAngle = revolute->GetLowerLimit();
+            jd.upperAngle = revolute->GetUpperLimit();
+            jd.enableMotor = revolute->IsMotorEnabled();
+            jd.motorSpeed = revolute->GetMotorSpeed();
+            jd.maxMotorTorque = revolute->GetMaxMotorTorque();
+            m_world.CreateJoint(&jd);
+        }
+    }
+
+    box2dref::b2World m_world;
+    std::vector<box2dref::b2Body*> m_bodies;
+
+private:
+    static box2dref::b2Vec2 Vec(const box2d::b2Vec<float, 2>& v)
+    {
+        return box2dref::b2Vec2(v[0], v[1]);
+    }
+
+    box2dref::b2Body* CopyBody(box2d::b2Body* b)
+    {
+        box2dref::b2BodyDef bd;
+        bd.type = static_cast<box2dref::b2BodyType>(static_cast<int>(b->GetType()));
+        bd.position = Vec(b->GetPosition());
+        bd.angle = b->GetAngle();
+        bd.linearVelocity = Vec(b->GetLinearVelocity());
+        bd.angularVelocity = b->GetAngularVelocity();
+        bd.linearDamping = b->GetLinearDamping();
+        bd.angularDamping = b->GetAngularDamping();
+        bd.allowSleep = b->IsSleepingAllowed();
+        bd.awake = b->IsAwake();
+        bd.fixedRotation = b->IsFixedRotation();
+        bd.bullet = b->IsBullet();
+        bd.active = b->IsActive();
+        bd.gravityScale = b->GetGravityScale();
+        box2dref::b2Body* body = m_world.CreateBody(&bd);
+
+        // The fixture list is in reverse order of creation as well.
+        std::vector<box2d::b2Fixture*> fixtures;
+        for (box2d::b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+        {
+            fixtures.push_back(f);
+        }
+        std::reverse(fixtures.begin(), fixtures.end());
+
+        for (box2d::b2Fixture* f : fixtures)
+        {
+            box2dref::b2PolygonShape polygon;
+            box2dref::b2CircleShape circle;
+            box2dref::b2EdgeShape edge;
+            box2dref::b2FixtureDef fd;
+
+            const box2d::b2Shape* shape = f->GetShape();
+            if (shape->GetType() == box2d::b2Shape::e_polygon)
+            {
+                // Copy the vertices and normals as they are, Set would reorder them.
+                auto source = static_cast<const box2d::b2PolygonShape*>(shape);
+                polygon.m_count = source->GetVertexCount();
+                for (int32_t i = 0; i < polygon.m_count; ++i)
+                {
+                    polygon.m_vertices[i] = Vec(source->GetVertices()[i]);
+                    polygon.m_normals[i] = Vec(source->GetNormals()[i]);
+                }
+                polygon.m_centroid = Vec(source->GetCentroid());
+                polygon.m_radius = source->GetRadius();
+                fd.shape = &polygon;
+            }
+            else if (shape->GetType() == box2d::b2Shape::e_circle)
+            {
+                auto source = static_cast<const box2d::b2CircleShape*>(shape);
+                circle.m_radius = source->GetRadius();
+                circle.m_p = Vec(source->m_p);
+                fd.shape = &circle;
+            }
+            else
+            {
+                box2d::b2Assert(shape->GetType() == box2d::b2Shape::e_edge);
+                auto source = static_cast<const box2d::b2EdgeShape*>(shape);
+                edge.Set(Vec(source->m_vertex1), Vec(source->m_vertex2));
+                edge.m_vertex0 = Vec(source->m_vertex0);
+                edge.m_vertex3 = Vec(source->m_vertex3);
+                edge.m_hasVertex0 = source->m_hasVertex0;
+                edge.m_hasVertex3 = source->m_hasVertex3;
+                edge.m_radius = source->GetRadius();
+                fd.shape = &edge;
+            }
+
+            const box2d::b2Filter& filter = f->GetFilterData();
+            fd.density = f->GetDensity();
+            fd.friction = f->GetFriction();
+            fd.restitution = f->GetRestitution();
+            fd.isSensor = f->IsSensor();
+            fd.filter.categoryBits = filter.categoryBits;
+            fd.filter.maskBits = filter.maskBits;
+            fd.filter.groupIndex = filter.groupIndex;
+            body->CreateFixture(&fd);
+        }
+
+        return body;
+    }
+};
+
+// Steps both worlds in lock step. The analytic circle time of impact is turned off so that
+// both libraries run the same algorithms; everything else uses the box2dpp defaults.
+inline Result Compare(const Scene& scene, int32_t steps, float tolerance = 1.0e-3f)
+{
+    const float timeStep = 1.0f / 60.0f;
+
+    World world(scene);
+    RefWorld ref(world);
+    world.m_world.SetAnalyticTOI(false);
+
+    Result result;
+    result.name = scene.name;
+    result.steps = steps;
+    result.bodies = static_cast<int32_t>(world.m_bodies.size());
+
+    for (int32_t i = 0; i < steps; ++i)
+    {
+        world.m_world.Step(timeStep, 8, 3);
+        ref.m_world.Step(timeStep, 8, 3);
+
+        result.box2d.Add(world.m_world.GetProfile());
+        result.ref.Add(ref.m_world.GetProfile());
+
+        for (size_t j = 0; j < world.m_bodies.size(); ++j)
+        {
+            box2d::b2Vec<float, 2> p = world.m_bodies[j]->GetPosition();
+            box2dref::b2Vec2 q = ref.m_bodies[j]->GetPosition();
+            float dp = std::sqrt((p[0] - q.x) * (p[0] - q.x) + (p[1] - q.y) * (p[1] - q.y));
+            float da = std::abs(world.m_bodies[j]->GetAngle() - ref.m_bodies[j]->GetAngle());
+            result.maxPositionError = std::max(result.maxPositionError, dp);
+            result.maxAngleError = std::max(result.maxAngleError, da);
+            if (dp > tolerance && result.firstDivergentStep < 0)
+            {
+                result.firstDivergentStep = i;
+            }
+        }
+    }
+
+    return result;
+}
+
+}
+
+#endif
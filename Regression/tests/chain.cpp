@@ -0,0 +1,145 @@
+// Chain shape tests
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <vector>
+
+#include <Box2D/Box2D.h>
+
+// A bumpy terrain with a row of circles and boxes dropped on it.
+static std::vector<box2d::b2Vec<float, 2>> runTerrain(bool localTree)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+
+    std::vector<box2d::b2Vec<float, 2>> vertices;
+    for (int32_t i = 0; i < 400; ++i)
+    {
+        float x = -100.0f + 0.5f * i;
+        vertices.push_back({{x, 0.5f * std::sin(0.3f * x)}});
+    }
+
+    box2d::b2ChainShape chain;
+    chain.SetLocalTree(localTree);
+    chain.CreateChain(vertices.data(), vertices.size());
+
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    ground->CreateFixture(&chain, 0.0f);
+
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.5f);
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+
+    std::vector<box2d::b2Body*> bodies;
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-50.0f + 5.0f * i, 3.0f}};
+        box2d::b2Body* body = world.CreateBody(&bd);
+        body->CreateFixture(i % 2 ? (box2d::b2Shape*)&box : (box2d::b2Shape*)&circle, 1.0f);
+        bodies.push_back(body);
+    }
+
+    for (int32_t i = 0; i < 120; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    std::vector<box2d::b2Vec<float, 2>> positions;
+    for (box2d::b2Body* body : bodies)
+    {
+        positions.push_back(body->GetPosition());
+    }
+    return positions;
+}
+
+TEST(ChainShape, LocalTreeSimulation)
+{
+    std::vector<box2d::b2Vec<float, 2>> proxies = runTerrain(false);
+    std::vector<box2d::b2Vec<float, 2>> tree = runTerrain(true);
+
+    // The contacts are created in a different order, so allow for solver ordering noise.
+    ASSERT_EQ(proxies.size(), tree.size());
+    for (size_t i = 0; i < proxies.size(); ++i)
+    {
+        EXPECT_NEAR(proxies[i][0], tree[i][0], 5.0e-2f);
+        EXPECT_NEAR(proxies[i][1], tree[i][1], 5.0e-2f);
+        EXPECT_LT(tree[i][1], 2.0f);
+    }
+}
+
+class b2ClosestRayCast : public box2d::b2RayCastCallback
+{
+public:
+    float ReportFixture(box2d::b2Fixture* fixture, const box2d::b2Vec<float, 2>& point,
+                        const box2d::b2Vec<float, 2>& normal, float fraction) override
+    {
+        B2_NOT_USED(fixture);
+        B2_NOT_USED(normal);
+        hit = true;
+        this->point = point;
+        return fraction;
+    }
+
+    bool hit = false;
+    box2d::b2Vec<float, 2> point;
+};
+
+class b2CountQuery : public box2d::b2QueryCallback
+{
+public:
+    bool ReportFixture(box2d::b2Fixture* fixture) override
+    {
+        B2_NOT_USED(fixture);
+        ++count;
+        return true;
+    }
+
+    int32_t count = 0;
+};
+
+TEST(ChainShape, LocalTreeQueries)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+
+    box2d::b2Vec<float, 2> vertices[] = {
+        {{-20.0f, 0.0f}}, {{-10.0f, 1.0f}}, {{0.0f, 0.0f}}, {{10.0f, 2.0f}}, {{20.0f, 0.0f}}};
+    box2d::b2ChainShape chain;
+    chain.SetLocalTree(true);
+    chain.CreateChain(vertices, 5);
+
+    box2d::b2BodyDef bd;
+    bd.position = {{5.0f, 1.0f}};
+    box2d::b2Body* ground = world.CreateBody(&bd);
+    box2d::b2Fixture* fixture = ground->CreateFixture(&chain, 0.0f);
+
+    ASSERT_NE(fixture->GetChildTree(), nullptr);
+
+    // The bounds include the skin radius of the edges.
+    box2d::b2AABB bounds;
+    chain.ComputeTreeAABB(&bounds, box2d::b2Transform{});
+    EXPECT_FLOAT_EQ(bounds.lowerBound[0], -20.0f - chain.GetRadius());
+    EXPECT_FLOAT_EQ(bounds.upperBound[1], 2.0f + chain.GetRadius());
+
+    b2ClosestRayCast rayCast;
+    world.RayCast(&rayCast, {{10.0f, 10.0f}}, {{10.0f, -10.0f}});
+    ASSERT_TRUE(rayCast.hit);
+    EXPECT_NEAR(rayCast.point[0], 10.0f, 1.0e-5f);
+    EXPECT_NEAR(rayCast.point[1], 2.0f, 1.0e-5f);
+
+    b2CountQuery query;
+    box2d::b2AABB aabb;
+    aabb.lowerBound = {{9.0f, 1.5f}};
+    aabb.upperBound = {{11.0f, 2.5f}};
+    world.QueryAABB(&query, aabb);
+    EXPECT_EQ(query.count, 1);
+
+    // Inside the bounds of the chain but away from the edges.
+    b2CountQuery empty;
+    aabb.lowerBound = {{-0.5f, 2.8f}};
+    aabb.upperBound = {{0.5f, 3.0f}};
+    world.QueryAABB(&empty, aabb);
+    EXPECT_EQ(empty.count, 0);
+}
@@ -0,0 +1,18 @@
+// Divergence from the reference Box2D, see harness/compare.cpp for the timing report.
+
+#include "gtest/gtest.h"
+#include "../harness/harness.hpp"
+
+TEST(Divergence, HarnessScenes)
+{
+    // Short runs, before contact ordering noise has a chance to grow.
+    for (const harness::Scene& scene : harness::DefaultScenes(1))
+    {
+        harness::Result r = harness::Compare(scene, 60);
+        EXPECT_EQ(r.steps, 60) << r.name;
+        EXPECT_GT(r.box2d.step, 0.0) << r.name;
+        EXPECT_GT(r.ref.step, 0.0) << r.name;
+        EXPECT_EQ(r.firstDivergentStep, -1) << r.name;
+        EXPECT_LT(r.maxAngleError, 1.0e-3f) << r.name;
+    }
+}
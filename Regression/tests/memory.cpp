@@ -0,0 +1,958 @@
+// Memory management tests
+
+#include "gtest/gtest.h"
+
+#include <Box2D/Box2D.h>
+#include <Box2D/Dynamics/Contacts/b2PolygonContact.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+TEST(StackAllocator, GrowsAndMerges)
+{
+    box2d::b2StackAllocator allocator;
+    EXPECT_EQ(allocator.GetCapacity(), box2d::b2_stackSize);
+
+    // Larger than the initial block and more entries than the initial entry capacity.
+    void* large = allocator.Allocate(2 * box2d::b2_stackSize);
+    void* small[2 * box2d::b2_maxStackEntries];
+    for (void*& p : small)
+    {
+        p = allocator.Allocate(64);
+    }
+    EXPECT_GT(allocator.GetBlockCount(), 1);
+    int32_t fallbacks = allocator.GetFallbackCount();
+    EXPECT_GT(fallbacks, 0);
+
+    for (int32_t i = 2 * box2d::b2_maxStackEntries - 1; i >= 0; --i)
+    {
+        allocator.Free(small[i]);
+    }
+    allocator.Free(large);
+
+    // The chain is merged once the stack is empty, which allocates the new block, and the
+    // next round fits.
+    EXPECT_EQ(allocator.GetBlockCount(), 1);
+    EXPECT_GE(allocator.GetCapacity(), allocator.GetMaxAllocation());
+    EXPECT_EQ(allocator.GetFallbackCount(), ++fallbacks);
+
+    large = allocator.Allocate(2 * box2d::b2_stackSize);
+    allocator.Free(allocator.Allocate(64));
+    allocator.Free(large);
+    EXPECT_EQ(allocator.GetFallbackCount(), fallbacks);
+}
+
+TEST(StackAllocator, SteadyStateWorld)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2EdgeShape edge;
+    edge.Set({{-100.0f, 0.0f}}, {{100.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    // One large island.
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        for (int32_t j = 0; j < 20; ++j)
+        {
+            box2d::b2BodyDef bd;
+            bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+            bd.position = {{-10.0f + 1.0f * j, 0.5f + 1.0f * i}};
+            world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+        }
+    }
+
+    int32_t fallbacks = 0;
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+        fallbacks += world.GetProfile().stackFallbacks;
+    }
+    EXPECT_GT(fallbacks, 0);
+
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+        EXPECT_EQ(world.GetProfile().stackFallbacks, 0);
+    }
+}
+
+TEST(StackAllocator, WorldDefCapacity)
+{
+    box2d::b2WorldDef def;
+    def.gravity = {{0.0f, -5.0f}};
+    def.stackCapacity = 4 * box2d::b2_stackSize;
+    box2d::b2World world(&def);
+
+    box2d::b2Vec<float, 2> gravity = world.GetGravity();
+    EXPECT_EQ(gravity[1], -5.0f);
+
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.5f);
+    world.CreateBody(&bd)->CreateFixture(&circle, 1.0f);
+    world.Step(1.0f / 60.0f, 8, 3);
+    EXPECT_EQ(world.GetProfile().stackFallbacks, 0);
+}
+
+// Checks that every block is freed with the size it was allocated with.
+class b2TrackingResource : public box2d::b2MemoryResource
+{
+public:
+    void* Allocate(int32_t size) override
+    {
+        void* p = malloc(size);
+        blocks[p] = size;
+        bytes += size;
+        ++allocations;
+        return p;
+    }
+
+    void Free(void* p, int32_t size) override
+    {
+        auto it = blocks.find(p);
+        ASSERT_NE(it, blocks.end());
+        EXPECT_EQ(it->second, size);
+        blocks.erase(it);
+        bytes -= size;
+        free(p);
+    }
+
+    std::map<void*, int32_t> blocks;
+    int32_t bytes = 0;
+    int32_t allocations = 0;
+};
+
+TEST(MemoryResource, WorldUsesResource)
+{
+    b2TrackingResource resource;
+    {
+        box2d::b2WorldDef def;
+        def.memoryResource = &resource;
+        box2d::b2World world(&def);
+        EXPECT_EQ(world.GetMemoryResource(), &resource);
+
+        std::vector<box2d::b2Vec<float, 2>> vertices;
+        for (int32_t i = 0; i < 200; ++i)
+        {
+            vertices.push_back({{-50.0f + 0.5f * i, 0.0f}});
+        }
+        box2d::b2ChainShape chain;
+        chain.SetLocalTree(true);
+        chain.CreateChain(vertices.data(), vertices.size());
+
+        box2d::b2BodyDef groundDef;
+        world.CreateBody(&groundDef)->CreateFixture(&chain, 0.0f);
+
+        int32_t chainAllocations = resource.allocations;
+        EXPECT_GT(chainAllocations, 0);
+
+        box2d::b2PolygonShape box;
+        box.SetAsBox(0.5f, 0.5f);
+        for (int32_t i = 0; i < 200; ++i)
+        {
+            box2d::b2BodyDef bd;
+            bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+            bd.position = {{-25.0f + 1.1f * (i % 40), 0.6f + 1.1f * (i / 40)}};
+            world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+        }
+
+        for (int32_t i = 0; i < 10; ++i)
+        {
+            world.Step(1.0f / 60.0f, 8, 3);
+        }
+        EXPECT_GT(resource.allocations, chainAllocations);
+        EXPECT_GT(resource.bytes, 0);
+    }
+    EXPECT_EQ(resource.bytes, 0);
+    EXPECT_TRUE(resource.blocks.empty());
+}
+
+class b2CountingListener : public box2d::b2AllocationListener
+{
+public:
+    void Allocated(void* p, int32_t size, box2d::b2MemoryCategory category,
+                   const void* callSite) override
+    {
+        B2_NOT_USED(p);
+        EXPECT_NE(callSite, nullptr);
+        bytes[(int32_t)category] += size;
+    }
+
+    void Freed(void* p, int32_t size, box2d::b2MemoryCategory category) override
+    {
+        B2_NOT_USED(p);
+        bytes[(int32_t)category] -= size;
+    }
+
+    int32_t bytes[(int32_t)box2d::b2MemoryCategory::COUNT] = {};
+};
+
+TEST(MemoryStats, Categories)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    b2CountingListener listener;
+    world.SetAllocationListener(&listener);
+
+    box2d::b2Vec<float, 2> vertices[] = {{{-20.0f, 0.0f}}, {{0.0f, 0.0f}}, {{20.0f, 0.0f}}};
+    box2d::b2ChainShape chain;
+    chain.CreateChain(vertices, 3);
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    ground->CreateFixture(&chain, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    box2d::b2Body* last = nullptr;
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-5.0f + 1.0f * i, 0.5f}};
+        box2d::b2Body* body = world.CreateBody(&bd);
+        body->CreateFixture(&box, 1.0f);
+        if (last)
+        {
+            box2d::b2DistanceJointDef jd;
+            jd.Initialize(last, body, last->GetPosition(), body->GetPosition());
+            world.CreateJoint(&jd);
+        }
+        last = body;
+    }
+
+    world.Step(1.0f / 60.0f, 8, 3);
+
+    box2d::b2MemoryStats stats = world.GetMemoryStats();
+    EXPECT_EQ(stats.bodies, 11 * (int32_t)sizeof(box2d::b2Body));
+    EXPECT_GE(stats.fixtures, 11 * (int32_t)sizeof(box2d::b2Fixture));
+    int32_t shapeBytes = sizeof(box2d::b2ChainShape) + 3 * sizeof(box2d::b2Vec<float, 2>) +
+                         10 * sizeof(box2d::b2PolygonShape);
+    EXPECT_EQ(stats.shapes, shapeBytes);
+    EXPECT_GT(stats.contacts, 0);
+    EXPECT_GE(stats.contactStates,
+              world.GetContactCount() *
+                  (int32_t)(sizeof(box2d::b2Contact*) + sizeof(box2d::b2ContactState)));
+    EXPECT_EQ(stats.joints, 9 * (int32_t)sizeof(box2d::b2DistanceJoint));
+    EXPECT_GT(stats.treeNodes, 0);
+    EXPECT_GT(stats.broadPhase, 0);
+    EXPECT_GT(stats.blockChunks, 0);
+    EXPECT_GE(stats.stack, stats.stackHighWater);
+    EXPECT_GT(stats.stackHighWater, 0);
+
+    EXPECT_EQ(listener.bytes[(int32_t)box2d::b2MemoryCategory::BODIES], stats.bodies);
+    EXPECT_EQ(listener.bytes[(int32_t)box2d::b2MemoryCategory::CONTACTS], stats.contacts);
+
+    world.DestroyBody(ground);
+    stats = world.GetMemoryStats();
+    EXPECT_EQ(stats.bodies, 10 * (int32_t)sizeof(box2d::b2Body));
+    EXPECT_EQ(stats.shapes, 10 * (int32_t)sizeof(box2d::b2PolygonShape));
+    EXPECT_EQ(listener.bytes[(int32_t)box2d::b2MemoryCategory::SHAPES], stats.shapes);
+    world.SetAllocationListener(nullptr);
+}
+
+class b2CountingDestructionListener : public box2d::b2DestructionListener
+{
+public:
+    void SayGoodbye(box2d::b2Joint* joint) override
+    {
+        B2_NOT_USED(joint);
+        ++joints;
+    }
+
+    void SayGoodbye(box2d::b2Fixture* fixture) override
+    {
+        B2_NOT_USED(fixture);
+        ++fixtures;
+    }
+
+    int32_t joints = 0;
+    int32_t fixtures = 0;
+};
+
+// A chain ground with a row of boxes linked by joints.
+static std::vector<box2d::b2Body*> buildScene(box2d::b2World* world)
+{
+    std::vector<box2d::b2Vec<float, 2>> vertices;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        float x = -25.0f + 0.5f * i;
+        vertices.push_back({{x, 0.2f * std::sin(x)}});
+    }
+    box2d::b2ChainShape chain;
+    chain.CreateChain(vertices.data(), vertices.size());
+    box2d::b2BodyDef groundDef;
+    world->CreateBody(&groundDef)->CreateFixture(&chain, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    std::vector<box2d::b2Body*> bodies;
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-10.0f + 1.0f * i, 2.0f + 0.1f * i}};
+        box2d::b2Body* body = world->CreateBody(&bd);
+        body->CreateFixture(&box, 1.0f);
+        if (i % 2)
+        {
+            box2d::b2DistanceJointDef jd;
+            jd.Initialize(bodies.back(), body, bodies.back()->GetPosition(), body->GetPosition());
+            world->CreateJoint(&jd);
+        }
+        bodies.push_back(body);
+    }
+    return bodies;
+}
+
+TEST(WorldReset, MatchesNewWorld)
+{
+    box2d::b2World fresh(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    std::vector<box2d::b2Body*> expected = buildScene(&fresh);
+
+    b2TrackingResource resource;
+    box2d::b2WorldDef def;
+    def.memoryResource = &resource;
+    box2d::b2World world(&def);
+    b2CountingDestructionListener listener;
+    world.SetDestructionListener(&listener);
+
+    buildScene(&world);
+    for (int32_t i = 0; i < 60; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    box2d::b2MemoryStats before = world.GetMemoryStats();
+    world.Reset();
+    EXPECT_EQ(listener.joints, 10);
+    EXPECT_EQ(listener.fixtures, 21);
+    EXPECT_EQ(world.GetBodyCount(), 0);
+    EXPECT_EQ(world.GetContactCount(), 0);
+    EXPECT_EQ(world.GetProxyCount(), 0);
+
+    box2d::b2MemoryStats after = world.GetMemoryStats();
+    EXPECT_EQ(after.bodies, 0);
+    EXPECT_EQ(after.contacts, 0);
+    EXPECT_EQ(after.blockChunks, before.blockChunks);
+    EXPECT_EQ(after.treeNodes, before.treeNodes);
+
+    std::vector<box2d::b2Body*> bodies = buildScene(&world);
+    for (int32_t i = 0; i < 60; ++i)
+    {
+        fresh.Step(1.0f / 60.0f, 8, 3);
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    // The rebuilt world needs no new chunks and behaves like a new one.
+    EXPECT_EQ(world.GetMemoryStats().blockChunks, before.blockChunks);
+    for (size_t i = 0; i < bodies.size(); ++i)
+    {
+        EXPECT_EQ(bodies[i]->GetPosition()[0], expected[i]->GetPosition()[0]);
+        EXPECT_EQ(bodies[i]->GetPosition()[1], expected[i]->GetPosition()[1]);
+    }
+
+    world.Reset(false);
+    EXPECT_EQ(listener.joints, 10);
+    EXPECT_EQ(listener.fixtures, 21);
+}
+
+// A pile of boxes, either cloned or sharing one shape.
+static std::vector<box2d::b2Vec<float, 2>> runBoxes(box2d::b2World* world,
+                                                    std::shared_ptr<const box2d::b2Shape> shared)
+{
+    box2d::b2BodyDef groundDef;
+    box2d::b2EdgeShape edge;
+    edge.Set({{-40.0f, 0.0f}}, {{40.0f, 0.0f}});
+    world->CreateBody(&groundDef)->CreateFixture(&edge, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    std::vector<box2d::b2Body*> bodies;
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-5.0f + 1.1f * (i % 10), 0.5f + 1.1f * (i / 10)}};
+        box2d::b2Body* body = world->CreateBody(&bd);
+        if (shared)
+        {
+            const box2d::b2Fixture* fixture = body->CreateFixture(shared, 1.0f);
+            EXPECT_TRUE(fixture->IsShapeShared());
+            EXPECT_EQ(fixture->GetShape(), shared.get());
+        }
+        else
+        {
+            EXPECT_FALSE(body->CreateFixture(&box, 1.0f)->IsShapeShared());
+        }
+        bodies.push_back(body);
+    }
+
+    for (int32_t i = 0; i < 60; ++i)
+    {
+        world->Step(1.0f / 60.0f, 8, 3);
+    }
+
+    std::vector<box2d::b2Vec<float, 2>> positions;
+    for (box2d::b2Body* body : bodies)
+    {
+        positions.push_back(body->GetPosition());
+    }
+    return positions;
+}
+
+TEST(SharedShape, MatchesClonedShapes)
+{
+    auto box = std::make_shared<box2d::b2PolygonShape>();
+    box->SetAsBox(0.5f, 0.5f);
+    std::shared_ptr<const box2d::b2Shape> shared = box;
+
+    std::vector<box2d::b2Vec<float, 2>> cloned, positions;
+    {
+        box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+        cloned = runBoxes(&world, nullptr);
+    }
+    {
+        box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+        positions = runBoxes(&world, shared);
+        EXPECT_EQ(shared.use_count(), 52);
+
+        // Only the ground edge is owned by the world.
+        EXPECT_EQ(world.GetMemoryStats().shapes, (int32_t)sizeof(box2d::b2EdgeShape));
+
+        world.DestroyBody(world.GetBodyList());
+        EXPECT_EQ(shared.use_count(), 51);
+    }
+    EXPECT_EQ(shared.use_count(), 2);
+
+    ASSERT_EQ(cloned.size(), positions.size());
+    for (size_t i = 0; i < cloned.size(); ++i)
+    {
+        EXPECT_EQ(cloned[i][0], positions[i][0]);
+        EXPECT_EQ(cloned[i][1], positions[i][1]);
+    }
+
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    runBoxes(&world, shared);
+    world.Reset();
+    EXPECT_EQ(shared.use_count(), 2);
+}
+
+TEST(SharedShape, ConstAccessOnly)
+{
+    auto circle = std::make_shared<box2d::b2CircleShape>();
+    circle->SetRadius(0.5f);
+    std::shared_ptr<const box2d::b2Shape> shared = circle;
+
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    box2d::b2Body* body = world.CreateBody(&bd);
+    box2d::b2Fixture* fixture = body->CreateFixture(shared, 1.0f);
+
+    // A shared shape is read through the const accessor.
+    const box2d::b2Fixture* constFixture = fixture;
+    static_assert(std::is_same<decltype(constFixture->GetShape()), const box2d::b2Shape*>::value,
+                  "the const accessor returns a const shape");
+    EXPECT_EQ(constFixture->GetShape(), shared.get());
+    EXPECT_EQ(constFixture->GetShape()->GetRadius(), 0.5f);
+
+#ifndef NDEBUG
+    // The mutable accessor refuses it.
+    EXPECT_DEATH(fixture->GetShape(), "");
+#endif
+
+    // Cloned shapes can still be modified.
+    box2d::b2CircleShape own;
+    own.SetRadius(0.25f);
+    box2d::b2Fixture* owned = body->CreateFixture(&own, 1.0f);
+    owned->GetShape()->SetRadius(0.3f);
+    EXPECT_EQ(owned->GetShape()->GetRadius(), 0.3f);
+}
+
+TEST(HugePageResource, ReusesAndReserves)
+{
+    box2d::b2HugePageResource resource(box2d::b2_hugePageSize, true);
+    resource.Reserve(3 * box2d::b2_hugePageSize);
+    int64_t mapped = resource.GetMappedBytes();
+    EXPECT_GE(mapped, 3 * box2d::b2_hugePageSize);
+
+    void* a = resource.Allocate(box2d::b2_chunkSize);
+    void* b = resource.Allocate(100);
+    EXPECT_EQ((uintptr_t)a % 64, 0u);
+    EXPECT_EQ((uintptr_t)b % 64, 0u);
+    resource.Free(a, box2d::b2_chunkSize);
+    EXPECT_EQ(resource.Allocate(box2d::b2_chunkSize), a);
+
+    // Larger than a region, it gets its own and the reserved regions are still used.
+    void* c = resource.Allocate(2 * box2d::b2_hugePageSize);
+    EXPECT_EQ(resource.GetMappedBytes(), mapped + 2 * box2d::b2_hugePageSize);
+    void* d = resource.Allocate(box2d::b2_hugePageSize);
+    void* e = resource.Allocate(box2d::b2_hugePageSize);
+    EXPECT_EQ(resource.GetMappedBytes(), mapped + 2 * box2d::b2_hugePageSize);
+    resource.Free(e, box2d::b2_hugePageSize);
+    resource.Free(d, box2d::b2_hugePageSize);
+    resource.Free(c, 2 * box2d::b2_hugePageSize);
+    resource.Free(a, box2d::b2_chunkSize);
+    resource.Free(b, 100);
+    EXPECT_EQ(resource.GetAllocatedBytes(), 0);
+}
+
+TEST(HugePageResource, World)
+{
+    box2d::b2HugePageResource resource(box2d::b2_hugePageSize, true);
+    resource.Reserve(box2d::b2_hugePageSize);
+    int64_t mapped = resource.GetMappedBytes();
+    {
+        box2d::b2WorldDef def;
+        def.memoryResource = &resource;
+        box2d::b2World world(&def);
+
+        box2d::b2PolygonShape box;
+        box.SetAsBox(0.5f, 0.5f);
+        for (int32_t i = 0; i < 100; ++i)
+        {
+            box2d::b2BodyDef bd;
+            bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+            bd.position = {{1.1f * (i % 10), 1.1f * (i / 10)}};
+            world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+        }
+        world.Step(1.0f / 60.0f, 8, 3);
+        EXPECT_GT(resource.GetAllocatedBytes(), 0);
+        EXPECT_EQ(resource.GetMappedBytes(), mapped);
+    }
+    EXPECT_EQ(resource.GetAllocatedBytes(), 0);
+}
+
+TEST(BlockCache, Threads)
+{
+    box2d::b2BlockAllocator allocator;
+    const int32_t threadCount = 4;
+    const int32_t blockCount = 2000;
+    // About the size of a contact.
+    const int32_t size = 200;
+    std::vector<int32_t> lockCounts(threadCount);
+    std::vector<bool> valid(threadCount);
+
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            box2d::b2BlockCache cache(&allocator);
+            std::vector<int32_t*> blocks;
+            for (int32_t round = 0; round < 10; ++round)
+            {
+                for (int32_t i = 0; i < blockCount; ++i)
+                {
+                    int32_t* p = (int32_t*)cache.Allocate(size, box2d::b2MemoryCategory::CONTACTS);
+                    p[0] = t;
+                    p[1] = i;
+                    blocks.push_back(p);
+                }
+
+                bool ok = true;
+                for (int32_t i = 0; i < blockCount; ++i)
+                {
+                    ok = ok && blocks[i][0] == t && blocks[i][1] == i;
+                    cache.Free(blocks[i], size, box2d::b2MemoryCategory::CONTACTS);
+                }
+                blocks.clear();
+                valid[t] = ok;
+            }
+            lockCounts[t] = cache.GetLockCount();
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int32_t t = 0; t < threadCount; ++t)
+    {
+        EXPECT_TRUE(valid[t]);
+        // Batched, so far fewer lock round trips than allocations.
+        EXPECT_LT(lockCounts[t], 10 * blockCount / 8);
+    }
+
+    EXPECT_EQ(allocator.GetAllocatedBytes(box2d::b2MemoryCategory::CONTACTS), 0);
+    for (int32_t i = 0; i < box2d::b2_blockSizes; ++i)
+    {
+        EXPECT_EQ(allocator.GetBlockCount(i), 0);
+    }
+}
+
+TEST(BlockCache, FreeFromAnotherCache)
+{
+    box2d::b2BlockAllocator allocator;
+    std::vector<void*> blocks;
+    {
+        box2d::b2BlockCache a(&allocator);
+        box2d::b2BlockCache b(&allocator);
+        for (int32_t i = 0; i < 200; ++i)
+        {
+            blocks.push_back(a.Allocate(48, box2d::b2MemoryCategory::CONTACTS));
+        }
+        for (void* p : blocks)
+        {
+            b.Free(p, 48, box2d::b2MemoryCategory::CONTACTS);
+        }
+        b.Free(a.Allocate(1000), 1000);
+        EXPECT_LE(b.GetCachedCount(2), 2 * box2d::b2_blockCacheBatch);
+    }
+
+    EXPECT_EQ(allocator.GetAllocatedBytes(box2d::b2MemoryCategory::CONTACTS), 0);
+    EXPECT_EQ(allocator.GetAllocatedBytes(box2d::b2MemoryCategory::OTHER), 0);
+    EXPECT_EQ(allocator.GetBlockCount(2), 0);
+
+    // The allocator can be used directly again.
+    void* p = allocator.Allocate(48);
+    allocator.Free(p, 48);
+}
+
+TEST(BlockCache, Contacts)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    b2CountingListener listener;
+    world.SetAllocationListener(&listener);
+
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2PolygonShape groundBox;
+    groundBox.SetAsBox(20.0f, 0.5f);
+    ground->CreateFixture(&groundBox, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-5.0f + 1.0f * (i % 10), 1.0f + 1.0f * (i / 10)}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+
+    const int32_t contacts = (int32_t)box2d::b2MemoryCategory::CONTACTS;
+    {
+        box2d::b2BlockCache cache(world.GetBlockAllocator());
+        world.SetContactAllocator(&cache);
+        for (int32_t i = 0; i < 30; ++i)
+        {
+            world.Step(1.0f / 60.0f, 8, 3);
+        }
+        world.SetContactAllocator(nullptr);
+
+        // The cached contacts are counted before the cache is flushed.
+        int32_t bytes = world.GetContactCount() * (int32_t)sizeof(box2d::b2PolygonContact);
+        EXPECT_GT(bytes, 0);
+        EXPECT_EQ(world.GetMemoryStats().contacts, bytes);
+        EXPECT_EQ(listener.bytes[contacts], bytes);
+        EXPECT_LT(cache.GetLockCount(), world.GetContactCount());
+    }
+
+    // The contacts made through the cache are destroyed through the block allocator.
+    world.DestroyBody(ground);
+    for (int32_t i = 0; i < 30; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+    EXPECT_EQ(world.GetMemoryStats().contacts,
+              world.GetContactCount() * (int32_t)sizeof(box2d::b2PolygonContact));
+    EXPECT_EQ(listener.bytes[contacts], world.GetMemoryStats().contacts);
+    world.SetAllocationListener(nullptr);
+}
+
+#ifndef NDEBUG
+TEST(BlockCache, AllocatorUnusableWhileCached)
+{
+    box2d::b2BlockAllocator allocator;
+    void* p = allocator.Allocate(48);
+    {
+        box2d::b2BlockCache cache(&allocator);
+        EXPECT_DEATH(allocator.Allocate(48), "");
+        EXPECT_DEATH(allocator.Free(p, 48), "");
+    }
+    allocator.Free(p, 48);
+}
+#endif
+
+TEST(Compact, BlockAllocator)
+{
+    box2d::b2BlockAllocator allocator;
+    std::vector<void*> blocks;
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        blocks.push_back(allocator.Allocate(64));
+    }
+    int32_t chunkCount = allocator.GetChunkCount();
+
+    // Keep every 500th block, so four chunks stay pinned.
+    std::vector<void*> kept;
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        if (i % 500 == 0)
+        {
+            kept.push_back(blocks[i]);
+        }
+        else
+        {
+            allocator.Free(blocks[i], 64);
+        }
+    }
+
+    EXPECT_EQ(allocator.Compact(), chunkCount - 4);
+    EXPECT_EQ(allocator.GetChunkCount(), 4);
+    EXPECT_EQ(allocator.GetBlockCount(2), 4);
+
+    // The free blocks are handed out in address order.
+    void* a = allocator.Allocate(64);
+    void* b = allocator.Allocate(64);
+    EXPECT_LT(a, b);
+    allocator.Free(a, 64);
+    allocator.Free(b, 64);
+    for (void* p : kept)
+    {
+        allocator.Free(p, 64);
+    }
+    EXPECT_EQ(allocator.Compact(), 4);
+    EXPECT_EQ(allocator.GetChunkCount(), 0);
+}
+
+class b2FixtureQuery : public box2d::b2QueryCallback
+{
+public:
+    bool ReportFixture(box2d::b2Fixture* fixture) override
+    {
+        fixtures.push_back(fixture);
+        return true;
+    }
+
+    std::vector<box2d::b2Fixture*> fixtures;
+};
+
+static box2d::b2World* makeChurnedWorld()
+{
+    box2d::b2World* world = new box2d::b2World(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef groundDef;
+    box2d::b2EdgeShape edge;
+    edge.Set({{-40.0f, 0.0f}}, {{40.0f, 0.0f}});
+    world->CreateBody(&groundDef)->CreateFixture(&edge, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    std::vector<box2d::b2Body*> bodies;
+    for (int32_t i = 0; i < 40; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-10.0f + 1.1f * (i % 20), 0.5f + 1.1f * (i / 20)}};
+        bd.angularVelocity = 0.1f * i;
+        box2d::b2Body* body = world->CreateBody(&bd);
+        body->CreateFixture(&box, 1.0f);
+        bodies.push_back(body);
+    }
+    world->Step(1.0f / 60.0f, 8, 3);
+
+    // Free every third slot, then take some of them again.
+    for (int32_t i = 0; i < 40; i += 3)
+    {
+        world->DestroyBody(bodies[i]);
+    }
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-10.0f + 2.2f * i, 5.0f}};
+        world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+    world->Step(1.0f / 60.0f, 8, 3);
+    return world;
+}
+
+TEST(Compact, BodyStates)
+{
+    std::unique_ptr<box2d::b2World> world(makeChurnedWorld());
+    struct Motion
+    {
+        box2d::b2Vec<float, 2> center;
+        float angle;
+        box2d::b2Vec<float, 2> velocity;
+        float angularVelocity;
+        float mass;
+    };
+    std::vector<Motion> before;
+    for (const box2d::b2Body* body = world->GetBodyList(); body; body = body->GetNext())
+    {
+        before.push_back({body->GetWorldCenter(), body->GetAngle(), body->GetLinearVelocity(),
+                          body->GetAngularVelocity(), body->GetMass()});
+    }
+
+    world->Compact();
+    EXPECT_EQ(world->GetMemoryStats().bodyStates,
+              world->GetBodyCount() * (int32_t)sizeof(box2d::b2BodyState));
+
+    // Each body still finds its own state.
+    size_t i = 0;
+    for (const box2d::b2Body* body = world->GetBodyList(); body; body = body->GetNext(), ++i)
+    {
+        ASSERT_LT(i, before.size());
+        EXPECT_EQ(body->GetWorldCenter()[0], before[i].center[0]);
+        EXPECT_EQ(body->GetWorldCenter()[1], before[i].center[1]);
+        EXPECT_EQ(body->GetAngle(), before[i].angle);
+        EXPECT_EQ(body->GetLinearVelocity()[0], before[i].velocity[0]);
+        EXPECT_EQ(body->GetLinearVelocity()[1], before[i].velocity[1]);
+        EXPECT_EQ(body->GetAngularVelocity(), before[i].angularVelocity);
+        EXPECT_EQ(body->GetMass(), before[i].mass);
+    }
+    EXPECT_EQ(i, before.size());
+
+    // New bodies append to the packed states, and the stacks settle.
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    bd.position = {{20.0f, 0.5f}};
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    for (int32_t step = 0; step < 120; ++step)
+    {
+        world->Step(1.0f / 60.0f, 8, 3);
+    }
+    for (const box2d::b2Body* body = world->GetBodyList(); body; body = body->GetNext())
+    {
+        if (body->GetType() == box2d::b2BodyType::DYNAMIC_BODY)
+        {
+            EXPECT_GT(body->GetPosition()[1], 0.0f);
+        }
+    }
+}
+
+TEST(ContactStates, FollowContactsThroughDestruction)
+{
+    std::unique_ptr<box2d::b2World> world(makeChurnedWorld());
+    ASSERT_GT(world->GetContactCount(), 10);
+
+    // Tag every contact state, then destroy contacts from the middle of the arrays.
+    std::map<const box2d::b2Contact*, float> tags;
+    float tag = 0.0f;
+    for (box2d::b2Contact* c = world->GetContactList(); c; c = c->GetNext())
+    {
+        c->SetTangentSpeed(tag);
+        tags[c] = tag;
+        tag += 1.0f;
+    }
+
+    int32_t destroyed = 0;
+    for (box2d::b2Body* body = world->GetBodyList(); body && destroyed < 4;)
+    {
+        box2d::b2Body* next = body->GetNext();
+        if (body->GetType() == box2d::b2BodyType::DYNAMIC_BODY && body->GetContactList())
+        {
+            world->DestroyBody(body);
+            ++destroyed;
+        }
+        body = next;
+    }
+
+    int32_t count = 0;
+    for (const box2d::b2Contact* c = world->GetContactList(); c; c = c->GetNext(), ++count)
+    {
+        ASSERT_EQ(tags.count(c), 1u);
+        EXPECT_EQ(c->GetTangentSpeed(), tags[c]);
+        EXPECT_EQ(c->IsTouching(), c->GetManifold()->pointCount > 0);
+    }
+    EXPECT_EQ(count, world->GetContactCount());
+    EXPECT_LT(count, (int32_t)tags.size());
+
+    world->Compact();
+    EXPECT_EQ(world->GetMemoryStats().contactStates,
+              count * (int32_t)(sizeof(box2d::b2Contact*) + sizeof(box2d::b2ContactState)));
+}
+
+TEST(Compact, World)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2EdgeShape edge;
+    edge.Set({{-100.0f, 0.0f}}, {{100.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    std::vector<box2d::b2Body*> bodies;
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-50.0f + 1.0f * (i % 100), 0.5f + 1.0f * (i / 100)}};
+        box2d::b2Body* body = world.CreateBody(&bd);
+        body->CreateFixture(&box, 1.0f);
+        bodies.push_back(body);
+    }
+    world.Step(1.0f / 60.0f, 8, 3);
+
+    // Despawn most of the bodies.
+    std::vector<box2d::b2Body*> survivors;
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        if (i % 20 == 0)
+        {
+            survivors.push_back(bodies[i]);
+        }
+        else
+        {
+            world.DestroyBody(bodies[i]);
+        }
+    }
+    world.Step(1.0f / 60.0f, 8, 3);
+
+    box2d::b2MemoryStats before = world.GetMemoryStats();
+    world.Compact();
+    box2d::b2MemoryStats after = world.GetMemoryStats();
+    EXPECT_LT(after.treeNodes, before.treeNodes / 4);
+    EXPECT_LT(after.blockChunks, before.blockChunks);
+    EXPECT_EQ(after.bodies, before.bodies);
+    EXPECT_EQ(after.contacts, before.contacts);
+    EXPECT_LT(after.bodyStates, before.bodyStates);
+    EXPECT_EQ(after.bodyStates, world.GetBodyCount() * (int32_t)sizeof(box2d::b2BodyState));
+
+    // The remapped proxies are still found by queries.
+    for (box2d::b2Body* body : survivors)
+    {
+        box2d::b2AABB aabb;
+        aabb.lowerBound = body->GetPosition() - box2d::b2Vec<float, 2>{{0.1f, 0.1f}};
+        aabb.upperBound = body->GetPosition() + box2d::b2Vec<float, 2>{{0.1f, 0.1f}};
+        b2FixtureQuery query;
+        world.QueryAABB(&query, aabb);
+        EXPECT_NE(std::find(query.fixtures.begin(), query.fixtures.end(),
+                            body->GetFixtureList()), query.fixtures.end());
+    }
+
+    // The world keeps running and growing.
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{-50.0f + 2.0f * i, 20.0f}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+    for (int32_t i = 0; i < 120; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+    for (box2d::b2Body* body : survivors)
+    {
+        EXPECT_GT(body->GetPosition()[1], 0.0f);
+    }
+}
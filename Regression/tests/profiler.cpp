@@ -0,0 +1,407 @@
+// Profiler tests
+
+#include "gtest/gtest.h"
+
+#include <Box2D/Box2D.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(Timer, Monotonic)
+{
+    box2d::b2Timer timer;
+    uint64_t previous = box2d::b2Timer::GetTimestamp();
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        uint64_t now = box2d::b2Timer::GetTimestamp();
+        EXPECT_GE(now, previous);
+        previous = now;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    float ms = timer.GetMilliseconds();
+    EXPECT_GE(ms, 4.5f);
+    EXPECT_LT(ms, 1000.0f);
+
+    int64_t ns = box2d::b2Timer::GetNanoseconds(timer.GetTicks());
+    EXPECT_GE(ns, 4500000);
+    EXPECT_NEAR(1.0e-6 * ns, timer.GetMilliseconds(), 50.0);
+}
+
+TEST(Profiler, RingBuffer)
+{
+    box2d::b2Profiler profiler(3);
+    EXPECT_EQ(profiler.GetEventCount(), 0);
+
+    const char* names[] = {"a", "b", "c", "d", "e", "f"};
+    for (const char* name : names)
+    {
+        box2d::b2ProfileZone outer(&profiler, name);
+        box2d::b2ProfileZone inner(&profiler, "inner", 7);
+    }
+
+    // Rounded up to four, the oldest events are overwritten.
+    ASSERT_EQ(profiler.GetEventCount(), 4);
+    EXPECT_STREQ(profiler.GetEvent(0).name, "inner");
+    EXPECT_STREQ(profiler.GetEvent(1).name, "e");
+    EXPECT_STREQ(profiler.GetEvent(3).name, "f");
+    EXPECT_EQ(profiler.GetEvent(2).depth, 1);
+    EXPECT_EQ(profiler.GetEvent(2).value, 7);
+    EXPECT_EQ(profiler.GetEvent(3).depth, 0);
+    EXPECT_EQ(profiler.GetEvent(3).value, -1);
+    EXPECT_LE(profiler.GetEvent(3).start, profiler.GetEvent(2).start);
+    EXPECT_GE(profiler.GetEvent(3).duration, profiler.GetEvent(2).duration);
+
+    profiler.Clear();
+    EXPECT_EQ(profiler.GetEventCount(), 0);
+
+    // A null profiler records nothing.
+    box2d::b2ProfileZone zone(nullptr, "none");
+}
+
+TEST(Profiler, WorldZones)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2EdgeShape edge;
+    edge.Set({{-40.0f, 0.0f}}, {{40.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    // Two separate stacks, so two islands.
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{i < 5 ? -10.0f : 10.0f, 0.5f + 1.0f * (i % 5)}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+
+    box2d::b2Profiler profiler;
+    world.SetProfiler(&profiler);
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+    world.SetProfiler(nullptr);
+    world.Step(1.0f / 60.0f, 8, 3);
+
+    std::map<std::string, int32_t> counts;
+    for (int32_t i = 0; i < profiler.GetEventCount(); ++i)
+    {
+        const box2d::b2ProfileEvent& event = profiler.GetEvent(i);
+        ++counts[event.name];
+        if (std::string(event.name) == "Step")
+        {
+            EXPECT_EQ(event.depth, 0);
+        }
+        else if (std::string(event.name) == "Island")
+        {
+            EXPECT_EQ(event.depth, 2);
+            EXPECT_EQ(event.value, 6);
+        }
+        else if (std::string(event.name) == "SynchronizeFixtures")
+        {
+            EXPECT_EQ(event.depth, 2);
+        }
+        else if (std::string(event.name) == "UpdatePairs")
+        {
+            // Not nested in SynchronizeFixtures.
+            EXPECT_LE(event.depth, 2);
+        }
+    }
+
+    EXPECT_EQ(counts["Step"], 10);
+    EXPECT_EQ(counts["Collide"], 10);
+    EXPECT_EQ(counts["Solve"], 10);
+    EXPECT_EQ(counts["Island"], 20);
+    EXPECT_EQ(counts["SynchronizeFixtures"], 10);
+    EXPECT_EQ(counts["SolveTOI"], 10);
+    EXPECT_GE(counts["UpdatePairs"], 10);
+
+    const char* path = "profiler_trace.json";
+    ASSERT_TRUE(profiler.WriteChromeTrace(path));
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    EXPECT_EQ(text.str().compare(0, 15, "{\"traceEvents\":"), 0);
+    EXPECT_NE(text.str().find("\"name\":\"Island\""), std::string::npos);
+    EXPECT_NE(text.str().find("\"args\":{\"value\":6}"), std::string::npos);
+    std::remove(path);
+}
+
+TEST(Profiler, StepCounters)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2EdgeShape edge;
+    edge.Set({{-40.0f, 0.0f}}, {{40.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    std::vector<box2d::b2Body*> bodies;
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{i < 5 ? -10.0f : 10.0f, 0.5f + 1.0f * (i % 5)}};
+        box2d::b2Body* body = world.CreateBody(&bd);
+        body->CreateFixture(&box, 1.0f);
+        bodies.push_back(body);
+    }
+
+    // The proxies created before the first step count towards it.
+    world.Step(1.0f / 60.0f, 8, 3);
+    const box2d::b2Profile& profile = world.GetProfile();
+    EXPECT_EQ(profile.broadPhase.tree.inserts, 11);
+    EXPECT_GE(profile.broadPhase.movedProxies, 11);
+    EXPECT_EQ(profile.broadPhase.pairs, 10);
+    EXPECT_EQ(profile.contactsCreated, 10);
+    EXPECT_EQ(profile.contactsDestroyed, 0);
+    EXPECT_EQ(profile.islands, 2);
+    EXPECT_EQ(profile.awakeBodies, 10);
+    EXPECT_EQ(profile.maxIslandBodies, 6);
+
+    for (int32_t i = 0; i < 30; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+    EXPECT_EQ(profile.touchingContacts, 10);
+    EXPECT_EQ(profile.contactsCreated, 0);
+
+    // The top box of a stack.
+    world.DestroyBody(bodies[4]);
+    world.Step(1.0f / 60.0f, 8, 3);
+    EXPECT_EQ(profile.contactsDestroyed, 1);
+    EXPECT_EQ(profile.broadPhase.tree.removes, 1);
+    EXPECT_EQ(profile.touchingContacts, 9);
+    EXPECT_EQ(profile.awakeBodies, 9);
+}
+
+TEST(Profiler, PerfCounters)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{1.1f * (i % 10), 1.1f * (i / 10)}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+
+    box2d::b2PerfCounters counters;
+    world.SetPerfCounters(&counters);
+    world.Step(1.0f / 60.0f, 8, 3);
+    const box2d::b2PhaseCounters& hardware = world.GetProfile().hardware;
+
+    // Unavailable counters read zero, in a container for example.
+    if (counters.IsAvailable() == false || hardware.step.instructions == 0)
+    {
+        EXPECT_EQ(hardware.solve.cycles, 0u);
+        EXPECT_EQ(hardware.solveVelocity.instructions, 0u);
+        return;
+    }
+
+    EXPECT_GT(hardware.solveVelocity.instructions, 0u);
+    EXPECT_GE(hardware.solve.instructions, hardware.solveVelocity.instructions);
+    EXPECT_GE(hardware.step.instructions, hardware.solve.instructions);
+    EXPECT_GE(hardware.step.instructions, hardware.collide.instructions);
+}
+
+class SolverStats : public box2d::b2SolverListener
+{
+public:
+    void IslandSolved(const box2d::b2IslandSolverStats& stats) override
+    {
+        islands.push_back(stats);
+        velocityResiduals.push_back(std::vector<float>(
+            stats.velocityResiduals, stats.velocityResiduals + stats.velocityIterations));
+        positionErrors.push_back(std::vector<float>(
+            stats.positionErrors, stats.positionErrors + stats.positionIterations));
+    }
+
+    std::vector<box2d::b2IslandSolverStats> islands;
+    std::vector<std::vector<float>> velocityResiduals;
+    std::vector<std::vector<float>> positionErrors;
+};
+
+TEST(Profiler, SolverConvergence)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2EdgeShape edge;
+    edge.Set({{-40.0f, 0.0f}}, {{40.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{0.0f, 0.5f + 1.0f * i}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+
+    // Keep the stack awake to count its islands.
+    world.SetAllowSleeping(false);
+    SolverStats stats;
+    world.SetSolverListener(&stats);
+    for (int32_t i = 0; i < 60; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+    const box2d::b2Profile& profile = world.GetProfile();
+    ASSERT_EQ(stats.islands.size(), 60u);
+    EXPECT_EQ(profile.islands, 1);
+
+    const box2d::b2IslandSolverStats& last = stats.islands.back();
+    EXPECT_EQ(last.bodyCount, 6);
+    EXPECT_EQ(last.contactCount, 5);
+    EXPECT_EQ(last.velocityIterations, 8);
+    EXPECT_EQ(profile.positionIterations, last.positionIterations);
+    EXPECT_EQ(profile.unsolvedIslands, last.positionSolved ? 0 : 1);
+
+    // A resting stack converges in the first position iteration.
+    EXPECT_TRUE(last.positionSolved);
+    EXPECT_EQ(last.positionIterations, 1);
+    EXPECT_LE(stats.positionErrors.back()[0], 3.0f * box2d::LINEAR_SLOP);
+    for (float residual : stats.velocityResiduals.back())
+    {
+        EXPECT_GE(residual, 0.0f);
+    }
+    EXPECT_LT(stats.velocityResiduals.back().back(), 0.1f);
+
+    // Deeply overlapping boxes are not separated by a single position iteration.
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    bd.position = {{10.0f, 0.5f}};
+    world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    bd.position = {{10.2f, 0.6f}};
+    world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    world.Step(1.0f / 60.0f, 8, 1);
+    ASSERT_EQ(stats.islands.size(), 62u);
+    EXPECT_EQ(profile.unsolvedIslands, 1);
+    float maxError = 0.0f;
+    for (size_t i = 60; i < 62; ++i)
+    {
+        maxError = std::max(maxError, stats.positionErrors[i][0]);
+    }
+    EXPECT_GT(maxError, 3.0f * box2d::LINEAR_SLOP);
+
+    world.SetSolverListener(nullptr);
+    world.Step(1.0f / 60.0f, 8, 3);
+    EXPECT_EQ(stats.islands.size(), 62u);
+}
+
+class PhaseRecorder : public box2d::b2PhaseListener
+{
+public:
+    void BeginPhase(const char* name, int32_t island, uint32_t thread) override
+    {
+        for (const char* outer : open)
+        {
+            nested += std::string(outer) == "SynchronizeFixtures" ? 1 : 0;
+        }
+        open.push_back(name);
+        begins[name] += 1;
+        maxIsland = std::max(maxIsland, island);
+        threads.push_back(thread);
+    }
+
+    void EndPhase(const char* name, int32_t island, uint32_t thread) override
+    {
+        // Phases nest.
+        EXPECT_FALSE(open.empty());
+        if (open.empty() == false)
+        {
+            EXPECT_EQ(open.back(), name);
+            open.pop_back();
+        }
+        B2_NOT_USED(island);
+        threads.push_back(thread);
+    }
+
+    std::vector<const char*> open;
+    std::map<std::string, int32_t> begins;
+    int32_t maxIsland = -1;
+    int32_t nested = 0;
+    std::vector<uint32_t> threads;
+};
+
+TEST(Profiler, PhaseMarkers)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2EdgeShape edge;
+    edge.Set({{-40.0f, 0.0f}}, {{40.0f, 0.0f}});
+    ground->CreateFixture(&edge, 0.0f);
+
+    // Two stacks and a fast bullet for the time of impact phase.
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 6; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{i < 3 ? -10.0f : 10.0f, 0.5f + 1.0f * (i % 3)}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    bd.bullet = true;
+    bd.position = {{0.0f, 5.0f}};
+    bd.linearVelocity = {{0.0f, -200.0f}};
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.1f);
+    world.CreateBody(&bd)->CreateFixture(&circle, 1.0f);
+
+    box2d::b2ContactListener contactListener;
+    world.SetContactListener(&contactListener);
+    PhaseRecorder phases;
+    world.SetPhaseListener(&phases);
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+    EXPECT_TRUE(phases.open.empty());
+
+    // The broad-phase phases follow each other.
+    EXPECT_EQ(phases.nested, 0);
+
+    EXPECT_EQ(phases.begins["Collide"], 10);
+    EXPECT_EQ(phases.begins["SynchronizeFixtures"], 10);
+    EXPECT_EQ(phases.begins["SolveTOI"], 10);
+    EXPECT_GE(phases.begins["UpdatePairs"], 10);
+    EXPECT_GE(phases.begins["BuildIsland"], 10);
+    EXPECT_EQ(phases.begins["SolveIsland"], phases.begins["BuildIsland"]);
+    EXPECT_GE(phases.begins["PostSolve"], phases.begins["SolveIsland"]);
+    EXPECT_EQ(phases.maxIsland, 2);
+
+    uint32_t thread = box2d::b2GetThreadId();
+    for (uint32_t t : phases.threads)
+    {
+        EXPECT_EQ(t, thread);
+    }
+    uint32_t other = thread;
+    std::thread([&other] { other = box2d::b2GetThreadId(); }).join();
+    EXPECT_NE(other, thread);
+
+    world.SetPhaseListener(nullptr);
+    world.Step(1.0f / 60.0f, 8, 3);
+    EXPECT_EQ(phases.begins["Collide"], 10);
+}
@@ -0,0 +1,57 @@
+// Speculative contact tests
+
+#include "gtest/gtest.h"
+
+#include <Box2D/Box2D.h>
+
+// Fires a small fast body at a thin wall and returns where it ends up.
+static box2d::b2Vec<float, 2> fireAtWall(bool worldSpeculative, bool bodySpeculative, bool box)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, 0.0f}});
+    world.SetSpeculativeContacts(worldSpeculative);
+
+    box2d::b2PolygonShape wall;
+    wall.SetAsBox(0.05f, 5.0f);
+
+    box2d::b2BodyDef groundDef;
+    groundDef.position = {{10.0f, 0.0f}};
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    ground->CreateFixture(&wall, 0.0f);
+
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.1f);
+    box2d::b2PolygonShape square;
+    square.SetAsBox(0.1f, 0.1f);
+
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    bd.speculative = bodySpeculative;
+    bd.linearVelocity = {{100.0f, 0.0f}};
+    box2d::b2Body* body = world.CreateBody(&bd);
+    body->CreateFixture(box ? (box2d::b2Shape*)&square : (box2d::b2Shape*)&circle, 1.0f);
+
+    for (int32_t i = 0; i < 60; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    return body->GetPosition();
+}
+
+TEST(Speculative, WorldContactsStopBullets)
+{
+    EXPECT_LT(fireAtWall(true, false, false)[0], 10.0f);
+    EXPECT_LT(fireAtWall(true, false, true)[0], 10.0f);
+}
+
+TEST(Speculative, BodyContactsStopBullets)
+{
+    EXPECT_LT(fireAtWall(false, true, false)[0], 10.0f);
+    EXPECT_LT(fireAtWall(false, true, true)[0], 10.0f);
+}
+
+TEST(Speculative, ContinuousPhysicsStillWorks)
+{
+    // Dynamic versus static is handled by SolveTOI when speculative contacts are off.
+    EXPECT_LT(fireAtWall(false, false, false)[0], 10.0f);
+}
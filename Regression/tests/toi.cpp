@@ -0,0 +1,288 @@
+// Continuous collision tests
+
+#include "gtest/gtest.h"
+#include "test_helpers.hpp"
+#include <vector>
+
+#include <Box2D/Box2D.h>
+
+// Bullets fired from both sides into a wall of boxes between two thin walls. Many
+// time of impact events happen in the same step, so the order they are handled in
+// shows in the result.
+static std::vector<box2d::b2Vec<float, 2>> runBullets(bool analytic)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, -10.0f}});
+    world.SetAnalyticTOI(analytic);
+
+    box2d::b2BodyDef groundDef;
+    box2d::b2Body* ground = world.CreateBody(&groundDef);
+    box2d::b2PolygonShape wall;
+    wall.SetAsBox(40.0f, 0.5f, {{0.0f, -0.5f}}, 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+    wall.SetAsBox(0.05f, 10.0f, {{-20.0f, 10.0f}}, 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+    wall.SetAsBox(0.05f, 10.0f, {{20.0f, 10.0f}}, 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.position = {{0.0f, 0.5f + 1.0f * i}};
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.1f);
+    box2d::b2PolygonShape small;
+    small.SetAsBox(0.1f, 0.1f);
+
+    std::vector<box2d::b2Body*> bullets;
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        float side = i % 2 ? 1.0f : -1.0f;
+        box2d::b2BodyDef bd;
+        bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+        bd.bullet = true;
+        bd.position = {{-15.0f * side, 0.5f + 0.45f * i}};
+        bd.linearVelocity = {{side * (80.0f + 5.0f * i), 0.0f}};
+        box2d::b2Body* body = world.CreateBody(&bd);
+        body->CreateFixture(i % 3 ? (box2d::b2Shape*)&circle : (box2d::b2Shape*)&small, 5.0f);
+        bullets.push_back(body);
+    }
+
+    for (int32_t i = 0; i < 90; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    std::vector<box2d::b2Vec<float, 2>> positions;
+    for (box2d::b2Body* body : bullets)
+    {
+        positions.push_back(body->GetPosition());
+    }
+    return positions;
+}
+
+static std::vector<box2dref::b2Vec2> runBulletsRef()
+{
+    box2dref::b2World world(box2dref::b2Vec2(0.0f, -10.0f));
+
+    box2dref::b2BodyDef groundDef;
+    box2dref::b2Body* ground = world.CreateBody(&groundDef);
+    box2dref::b2PolygonShape wall;
+    wall.SetAsBox(40.0f, 0.5f, box2dref::b2Vec2(0.0f, -0.5f), 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+    wall.SetAsBox(0.05f, 10.0f, box2dref::b2Vec2(-20.0f, 10.0f), 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+    wall.SetAsBox(0.05f, 10.0f, box2dref::b2Vec2(20.0f, 10.0f), 0.0f);
+    ground->CreateFixture(&wall, 0.0f);
+
+    box2dref::b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        box2dref::b2BodyDef bd;
+        bd.type = box2dref::b2_dynamicBody;
+        bd.position.Set(0.0f, 0.5f + 1.0f * i);
+        world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+    }
+
+    box2dref::b2CircleShape circle;
+    circle.m_radius = 0.1f;
+    box2dref::b2PolygonShape small;
+    small.SetAsBox(0.1f, 0.1f);
+
+    std::vector<box2dref::b2Body*> bullets;
+    for (int32_t i = 0; i < 20; ++i)
+    {
+        float side = i % 2 ? 1.0f : -1.0f;
+        box2dref::b2BodyDef bd;
+        bd.type = box2dref::b2_dynamicBody;
+        bd.bullet = true;
+        bd.position.Set(-15.0f * side, 0.5f + 0.45f * i);
+        bd.linearVelocity.Set(side * (80.0f + 5.0f * i), 0.0f);
+        box2dref::b2Body* body = world.CreateBody(&bd);
+        body->CreateFixture(i % 3 ? (box2dref::b2Shape*)&circle : (box2dref::b2Shape*)&small,
+                            5.0f);
+        bullets.push_back(body);
+    }
+
+    for (int32_t i = 0; i < 90; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    std::vector<box2dref::b2Vec2> positions;
+    for (box2dref::b2Body* body : bullets)
+    {
+        positions.push_back(body->GetPosition());
+    }
+    return positions;
+}
+
+TEST(TimeOfImpact, BulletsMatchReference)
+{
+    std::vector<box2d::b2Vec<float, 2>> positions = runBullets(false);
+    std::vector<box2dref::b2Vec2> positionsRef = runBulletsRef();
+
+    ASSERT_EQ(positions.size(), positionsRef.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        compareB2Vec2(positions[i], positionsRef[i]);
+    }
+}
+
+TEST(TimeOfImpact, AnalyticBulletsStayInside)
+{
+    for (const box2d::b2Vec<float, 2>& p : runBullets(true))
+    {
+        EXPECT_GT(p[0], -20.0f);
+        EXPECT_LT(p[0], 20.0f);
+        EXPECT_GT(p[1], 0.0f);
+    }
+}
+
+// Compares the closed form TOI of a circle against the general algorithm.
+static void compareCircleTOI(const box2d::b2Shape& shape, const box2d::b2Sweep& sweepA,
+                             const box2d::b2Vec<float, 2>& c0, const box2d::b2Vec<float, 2>& c)
+{
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.25f);
+
+    box2d::b2TOIInput input;
+    input.proxyA.Set(&shape, 0);
+    input.proxyB.Set(&circle, 0);
+    input.sweepA = sweepA;
+    input.sweepB.localCenter = {{0.0f, 0.0f}};
+    input.sweepB.c0 = c0;
+    input.sweepB.c = c;
+    input.sweepB.a0 = 0.0f;
+    input.sweepB.a = 2.0f;
+    input.sweepB.alpha0 = 0.0f;
+    input.tMax = 1.0f;
+
+    box2d::b2TOIStats stats{};
+    box2d::b2TOIOutput general, analytic;
+    box2d::b2TimeOfImpact(&general, &input);
+    box2d::b2TimeOfImpactCircle(&analytic, &input, &stats);
+
+    EXPECT_EQ(stats.analyticCalls, 1);
+    EXPECT_EQ(stats.calls, 0);
+    EXPECT_EQ(general.state, analytic.state);
+    EXPECT_NEAR(general.t, analytic.t, 1.0e-3f);
+}
+
+TEST(TimeOfImpact, AnalyticCircle)
+{
+    box2d::b2Sweep sweep;
+    sweep.localCenter = {{0.0f, 0.0f}};
+    sweep.c0 = {{0.0f, 0.0f}};
+    sweep.c = {{1.0f, 0.0f}};
+    sweep.a0 = 0.5f;
+    sweep.a = 0.5f;
+    sweep.alpha0 = 0.0f;
+
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.5f);
+    compareCircleTOI(circle, sweep, {{-10.0f, 0.3f}}, {{10.0f, 0.0f}});
+    compareCircleTOI(circle, sweep, {{-10.0f, 3.0f}}, {{10.0f, 3.0f}});
+
+    box2d::b2PolygonShape box;
+    box.SetAsBox(1.0f, 0.5f);
+    compareCircleTOI(box, sweep, {{-10.0f, 0.2f}}, {{10.0f, -0.1f}});
+    compareCircleTOI(box, sweep, {{-10.0f, -8.0f}}, {{10.0f, 9.0f}});
+    compareCircleTOI(box, sweep, {{3.0f, 3.0f}}, {{3.0f, 2.0f}});
+
+    box2d::b2EdgeShape edge;
+    edge.Set({{-2.0f, 0.0f}}, {{2.0f, 0.0f}});
+    compareCircleTOI(edge, sweep, {{0.5f, -5.0f}}, {{1.5f, 5.0f}});
+    compareCircleTOI(edge, sweep, {{-6.0f, 0.1f}}, {{6.0f, 0.1f}});
+}
+
+TEST(TimeOfImpact, AnalyticCircleBesideEdgeEnd)
+{
+    box2d::b2Sweep sweep;
+    sweep.localCenter = {{0.0f, 0.0f}};
+    sweep.c0 = {{0.0f, 0.0f}};
+    sweep.c = {{0.0f, 0.0f}};
+    sweep.a0 = 0.0f;
+    sweep.a = 0.0f;
+    sweep.alpha0 = 0.0f;
+
+    // The circle starts within its radius of the edge's line, beside the left end, and
+    // moves away from the edge. It never touches it.
+    box2d::b2EdgeShape edge;
+    edge.Set({{0.0f, 0.0f}}, {{4.0f, 0.0f}});
+    compareCircleTOI(edge, sweep, {{-0.3f, 0.1f}}, {{-5.3f, -0.9f}});
+
+    // Starting beside the end and moving onto the edge, it touches the end first.
+    compareCircleTOI(edge, sweep, {{-0.3f, 0.1f}}, {{2.0f, 0.1f}});
+}
+
+TEST(TimeOfImpact, AnalyticCircleFallsBackWhenRotating)
+{
+    box2d::b2PolygonShape box;
+    box.SetAsBox(1.0f, 0.5f);
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.25f);
+
+    box2d::b2TOIInput input;
+    input.proxyA.Set(&box, 0);
+    input.proxyB.Set(&circle, 0);
+    input.sweepA.localCenter = {{0.0f, 0.0f}};
+    input.sweepA.c0 = {{0.0f, 0.0f}};
+    input.sweepA.c = {{0.0f, 0.0f}};
+    input.sweepA.a0 = 0.0f;
+    input.sweepA.a = 1.0f;
+    input.sweepA.alpha0 = 0.0f;
+    input.sweepB = input.sweepA;
+    input.sweepB.c0 = {{-5.0f, 0.0f}};
+    input.sweepB.c = {{5.0f, 0.0f}};
+    input.tMax = 1.0f;
+
+    box2d::b2TOIStats stats{};
+    box2d::b2TOIOutput output;
+    box2d::b2TimeOfImpactCircle(&output, &input, &stats);
+    EXPECT_EQ(stats.analyticCalls, 0);
+    EXPECT_EQ(stats.analyticFallbacks, 1);
+    EXPECT_EQ(stats.calls, 1);
+    EXPECT_EQ(output.state, box2d::b2TOIOutput::e_touching);
+}
+
+TEST(TimeOfImpact, ProfileStats)
+{
+    box2d::b2World world(box2d::b2Vec<float, 2>{{0.0f, 0.0f}});
+    world.SetAnalyticTOI(false);
+
+    box2d::b2PolygonShape wall;
+    wall.SetAsBox(0.05f, 5.0f);
+    box2d::b2BodyDef groundDef;
+    groundDef.position = {{5.0f, 0.0f}};
+    world.CreateBody(&groundDef)->CreateFixture(&wall, 0.0f);
+
+    box2d::b2CircleShape circle;
+    circle.SetRadius(0.1f);
+    box2d::b2BodyDef bd;
+    bd.type = box2d::b2BodyType::DYNAMIC_BODY;
+    bd.linearVelocity = {{100.0f, 0.0f}};
+    world.CreateBody(&bd)->CreateFixture(&circle, 1.0f);
+
+    int32_t toiCalls = 0;
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+
+        const box2d::b2Profile& profile = world.GetProfile();
+        EXPECT_GE(profile.toi.iters, profile.toi.calls);
+        EXPECT_GE(profile.gjk.calls, profile.toi.calls);
+        toiCalls += profile.toi.calls;
+    }
+    EXPECT_GT(toiCalls, 0);
+
+    // The statistics are per step.
+    world.Step(0.0f, 8, 3);
+    EXPECT_EQ(world.GetProfile().toi.calls, 0);
+}